@@ -135,9 +135,12 @@ if "%BUILD_TYPE%"=="mingw" (
         --disable-decoders \
         --enable-decoder=aac \
         --enable-decoder=aac_latm \
+        --enable-decoder=opus \
+        --enable-decoder=atrac9 \
         --disable-parsers \
         --enable-parser=aac \
         --enable-parser=aac_latm \
+        --enable-parser=opus \
         --disable-bsfs \
         --enable-bsf=aac_adtstoasc \
         --disable-hwaccels \
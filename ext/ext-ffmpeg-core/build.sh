@@ -77,9 +77,12 @@ echo "Configuring FFmpeg build..."
     --disable-decoders \
     --enable-decoder=aac \
     --enable-decoder=aac_latm \
+    --enable-decoder=opus \
+    --enable-decoder=atrac9 \
     --disable-parsers \
     --enable-parser=aac \
     --enable-parser=aac_latm \
+    --enable-parser=opus \
     --disable-bsfs \
     --enable-bsf=aac_adtstoasc \
     --disable-hwaccels \
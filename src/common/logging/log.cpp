@@ -0,0 +1,248 @@
+/**
+ * @file log.cpp
+ * @brief Asynchronous leveled logger implementation
+ * 
+ * Producers claim a slot in a bounded multi-producer ring buffer (sequence
+ * numbered, lock-free), format their message straight into it and publish
+ * it. A background thread drains published slots in order and writes them
+ * to stdout/stderr with one flush per batch.
+ */
+
+#include "log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace ShadPS4::Log {
+
+namespace Detail {
+std::atomic<uint8_t> g_runtimeLevel{static_cast<uint8_t>(
+    SHADPS4_LOG_MIN_LEVEL < static_cast<int>(Level::Info) ? Level::Info
+                                                           : static_cast<Level>(SHADPS4_LOG_MIN_LEVEL))};
+} // namespace Detail
+
+namespace {
+
+constexpr size_t kRingSize = 4096;              // Must be a power of two
+constexpr size_t kMessageSize = 240;            // Longer messages are truncated
+constexpr uint32_t kRateLimitBurst = 5;         // Messages per call site per window
+constexpr int64_t kRateLimitWindowMs = 1000;
+constexpr auto kDrainInterval = std::chrono::milliseconds(5);
+
+struct Entry {
+    std::atomic<size_t> sequence;
+    Level level;
+    const char* tag;
+    char text[kMessageSize];
+};
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void formatInto(char* buffer, size_t size, const char* format, va_list args, uint32_t suppressed) {
+    int length = std::vsnprintf(buffer, size, format, args);
+    if (length < 0) {
+        buffer[0] = '\0';
+        return;
+    }
+    if (suppressed > 0 && static_cast<size_t>(length) < size) {
+        std::snprintf(buffer + length, size - length, " (%u similar messages suppressed)", suppressed);
+    }
+}
+
+void emit(Level level, const char* tag, const char* text) {
+    FILE* stream = level >= Level::Warning ? stderr : stdout;
+    std::fprintf(stream, "[%s] %s\n", tag ? tag : "?", text);
+}
+
+/**
+ * @brief Ring buffer plus drain thread
+ */
+class AsyncLogger {
+public:
+    static AsyncLogger& instance() {
+        // Intentionally leaked so logging from static destructors stays valid
+        static AsyncLogger* logger = new AsyncLogger();
+        return *logger;
+    }
+
+    void push(Level level, const char* tag, const char* format, va_list args, uint32_t suppressed) {
+        if (stopped.load(std::memory_order_acquire)) {
+            // Drain thread is gone (process exit): write synchronously
+            char text[kMessageSize];
+            formatInto(text, sizeof(text), format, args, suppressed);
+            std::lock_guard<std::mutex> lock(drainMutex);
+            emit(level, tag, text);
+            return;
+        }
+
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Entry* entry = nullptr;
+        while (true) {
+            entry = &ring[pos & (kRingSize - 1)];
+            size_t sequence = entry->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Ring buffer full: drop rather than block the caller
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        entry->level = level;
+        entry->tag = tag;
+        formatInto(entry->text, sizeof(entry->text), format, args, suppressed);
+        entry->sequence.store(pos + 1, std::memory_order_release);
+
+        if (level >= Level::Error) {
+            wake.notify_one();
+        }
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainLocked();
+    }
+
+    uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    AsyncLogger()
+        : ring(std::make_unique<Entry[]>(kRingSize)) {
+        for (size_t i = 0; i < kRingSize; ++i) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        worker = std::thread([this] { run(); });
+        std::atexit([] { AsyncLogger::instance().stop(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopRequested = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        // Late messages are written synchronously from here on
+        stopped.store(true, std::memory_order_release);
+        flush();
+    }
+
+    void run() {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(drainMutex);
+                drainLocked();
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (stopRequested) {
+                break;
+            }
+            wake.wait_for(lock, kDrainInterval);
+        }
+    }
+
+    // Caller must hold drainMutex
+    void drainLocked() {
+        bool wroteAny = false;
+        while (true) {
+            Entry& entry = ring[dequeuePos & (kRingSize - 1)];
+            size_t sequence = entry.sequence.load(std::memory_order_acquire);
+            if (sequence != dequeuePos + 1) {
+                break;
+            }
+
+            emit(entry.level, entry.tag, entry.text);
+            wroteAny = true;
+
+            entry.sequence.store(dequeuePos + kRingSize, std::memory_order_release);
+            ++dequeuePos;
+        }
+
+        if (wroteAny) {
+            std::fflush(stdout);
+            std::fflush(stderr);
+        }
+    }
+
+    std::unique_ptr<Entry[]> ring;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;          // Guarded by drainMutex
+    std::atomic<uint64_t> droppedCount{0};
+    std::atomic<bool> stopped{false};
+
+    std::mutex drainMutex;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopRequested = false;                 // Guarded by wakeMutex
+    std::thread worker;
+};
+
+} // namespace
+
+void setLevel(Level level) {
+    Detail::g_runtimeLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+Level getLevel() {
+    return static_cast<Level>(Detail::g_runtimeLevel.load(std::memory_order_relaxed));
+}
+
+void write(Level level, const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    AsyncLogger::instance().push(level, tag, format, args, 0);
+    va_end(args);
+}
+
+void writeRateLimited(RateLimiter& limiter, Level level, const char* tag, const char* format, ...) {
+    int64_t now = nowMs();
+    int64_t windowStart = limiter.windowStart.load(std::memory_order_relaxed);
+    uint32_t suppressed = 0;
+
+    if (now - windowStart >= kRateLimitWindowMs &&
+        limiter.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        suppressed = limiter.suppressed.exchange(0, std::memory_order_relaxed);
+        limiter.emitted.store(0, std::memory_order_relaxed);
+    }
+
+    if (limiter.emitted.fetch_add(1, std::memory_order_relaxed) >= kRateLimitBurst) {
+        limiter.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    AsyncLogger::instance().push(level, tag, format, args, suppressed);
+    va_end(args);
+}
+
+void flush() {
+    AsyncLogger::instance().flush();
+}
+
+uint64_t getDroppedCount() {
+    return AsyncLogger::instance().dropped();
+}
+
+} // namespace ShadPS4::Log
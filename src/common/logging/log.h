@@ -0,0 +1,150 @@
+#pragma once
+
+/**
+ * @file log.h
+ * @brief Asynchronous leveled logger shared by the audio and AJM libraries
+ * 
+ * Messages are formatted directly into a fixed-size lock-free ring buffer and
+ * written out by a background thread, so logging never blocks or flushes on
+ * the decode path. Levels below SHADPS4_LOG_MIN_LEVEL are compiled out;
+ * levels below the runtime level cost a single relaxed atomic load.
+ * 
+ * Usage:
+ *   LOG_INFO("OrbisAudioDecoder", "Found codec: %s", codec->name);
+ *   LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Decode failed with code: %d", result);
+ */
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define SHADPS4_LOG_PRINTF_FORMAT(fmtIndex, argIndex) \
+        __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+    #define SHADPS4_LOG_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+// Compile-time minimum level (0 = Trace ... 5 = Critical, 6 = Off)
+#ifndef SHADPS4_LOG_MIN_LEVEL
+    #ifdef NDEBUG
+        #define SHADPS4_LOG_MIN_LEVEL 2 // Info
+    #else
+        #define SHADPS4_LOG_MIN_LEVEL 0 // Trace
+    #endif
+#endif
+
+namespace ShadPS4::Log {
+
+/**
+ * @brief Log severity levels
+ */
+enum class Level : uint8_t {
+    Trace = 0,                  // Per-packet/per-frame detail
+    Debug = 1,                  // Diagnostic information
+    Info = 2,                   // Lifecycle events
+    Warning = 3,                // Recoverable problems
+    Error = 4,                  // Failed operations
+    Critical = 5,               // Unrecoverable problems
+    Off = 6                     // Logging disabled
+};
+
+namespace Detail {
+extern std::atomic<uint8_t> g_runtimeLevel;
+} // namespace Detail
+
+/**
+ * @brief Check whether a level is compiled in (SHADPS4_LOG_MIN_LEVEL)
+ */
+constexpr bool isCompiledIn(Level level) {
+    return level >= static_cast<Level>(SHADPS4_LOG_MIN_LEVEL);
+}
+
+/**
+ * @brief Check whether a level is enabled at runtime
+ */
+inline bool isEnabled(Level level) {
+    return static_cast<uint8_t>(level) >=
+           Detail::g_runtimeLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set the runtime minimum level
+ */
+void setLevel(Level level);
+
+/**
+ * @brief Get the runtime minimum level
+ */
+Level getLevel();
+
+/**
+ * @brief Queue a formatted message
+ * 
+ * Never blocks: if the ring buffer is full the message is dropped and counted.
+ * 
+ * @param level Message severity
+ * @param tag Subsystem tag; must point to a string with static storage duration
+ * @param format printf-style format string
+ */
+void write(Level level, const char* tag, const char* format, ...) SHADPS4_LOG_PRINTF_FORMAT(3, 4);
+
+/**
+ * @brief Per-call-site state for rate-limited messages
+ */
+struct RateLimiter {
+    std::atomic<int64_t> windowStart{0};    // Window start in milliseconds
+    std::atomic<uint32_t> emitted{0};       // Messages emitted in this window
+    std::atomic<uint32_t> suppressed{0};    // Messages dropped in this window
+};
+
+/**
+ * @brief Queue a formatted message, at most a few times per second per call site
+ * 
+ * The first message after a suppressed burst reports how many were dropped.
+ */
+void writeRateLimited(RateLimiter& limiter, Level level, const char* tag, const char* format, ...)
+    SHADPS4_LOG_PRINTF_FORMAT(4, 5);
+
+/**
+ * @brief Block until every queued message has been written
+ */
+void flush();
+
+/**
+ * @brief Get the number of messages dropped because the ring buffer was full
+ */
+uint64_t getDroppedCount();
+
+} // namespace ShadPS4::Log
+
+#define SHADPS4_LOG_IMPL(level, tag, ...)                                               \
+    do {                                                                                \
+        if constexpr (::ShadPS4::Log::isCompiledIn(level)) {                           \
+            if (::ShadPS4::Log::isEnabled(level)) {                                     \
+                ::ShadPS4::Log::write(level, tag, __VA_ARGS__);                         \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#define SHADPS4_LOG_RATELIMITED_IMPL(level, tag, ...)                                   \
+    do {                                                                                \
+        if constexpr (::ShadPS4::Log::isCompiledIn(level)) {                           \
+            if (::ShadPS4::Log::isEnabled(level)) {                                     \
+                static ::ShadPS4::Log::RateLimiter shadps4LogLimiter;                   \
+                ::ShadPS4::Log::writeRateLimited(shadps4LogLimiter, level, tag,         \
+                                                 __VA_ARGS__);                          \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#define LOG_TRACE(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Trace, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Debug, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Info, tag, __VA_ARGS__)
+#define LOG_WARNING(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Warning, tag, __VA_ARGS__)
+#define LOG_ERROR(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Error, tag, __VA_ARGS__)
+#define LOG_CRITICAL(tag, ...) SHADPS4_LOG_IMPL(::ShadPS4::Log::Level::Critical, tag, __VA_ARGS__)
+
+#define LOG_WARNING_RATELIMITED(tag, ...) \
+    SHADPS4_LOG_RATELIMITED_IMPL(::ShadPS4::Log::Level::Warning, tag, __VA_ARGS__)
+#define LOG_ERROR_RATELIMITED(tag, ...) \
+    SHADPS4_LOG_RATELIMITED_IMPL(::ShadPS4::Log::Level::Error, tag, __VA_ARGS__)
@@ -0,0 +1,288 @@
+/**
+ * @file ajm_batch.cpp
+ * @brief AJM batch job scheduling for ShadPS4
+ *
+ * This file implements batch submission, per-instance strands and the
+ * sceAjmBatch* C interface on top of the work-stealing decode pool.
+ */
+
+#include "ajm_batch.h"
+#include "common/logging/log.h"
+
+#include <chrono>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Jobs a strand runs before yielding its worker to other strands
+constexpr int kStrandBudget = 8;
+
+} // namespace
+
+AjmBatchScheduler& AjmBatchScheduler::getInstance() {
+    // Intentionally leaked so plugin shutdown from static destructors can still retire instances
+    static AjmBatchScheduler* instance = new AjmBatchScheduler();
+    return *instance;
+}
+
+WorkStealingPool& AjmBatchScheduler::getPool() {
+    // Created on first submit so processes that never batch start no threads
+    std::call_once(poolOnce, [this] {
+        pool = std::make_unique<WorkStealingPool>();
+        LOG_INFO("AjmBatch", "Decode pool started with %zu workers", pool->getThreadCount());
+    });
+    return *pool;
+}
+
+uint32_t AjmBatchScheduler::submit(AjmDecodeJob* jobs, uint32_t count) {
+    if (!jobs || count == 0) {
+        LOG_ERROR_RATELIMITED("AjmBatch", "Error: Invalid batch parameters");
+        return 0;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->jobs = jobs;
+    batch->count = count;
+    batch->pending.store(count, std::memory_order_relaxed);
+
+    uint32_t batchId;
+    {
+        std::lock_guard<std::mutex> lock(batchesMutex);
+        do {
+            batchId = nextBatchId++;
+        } while (batchId == 0 || batches.count(batchId) != 0);
+        batches[batchId] = batch;
+    }
+
+    // Enqueue in job order; strands that were idle get scheduled afterwards
+    std::vector<Strand*> toSchedule;
+    {
+        std::lock_guard<std::mutex> lock(strandsMutex);
+        for (uint32_t i = 0; i < count; ++i) {
+            AjmDecodeJob& job = jobs[i];
+            job.outputSize = 0;
+
+            if (!job.instance) {
+                job.result = DecodeResult::ErrorInvalidInput;
+                completeJob(*batch);
+                continue;
+            }
+
+            std::unique_ptr<Strand>& strand = strands[job.instance];
+            if (!strand) {
+                strand = std::make_unique<Strand>();
+                strand->owner = this;
+                strand->batchDecode =
+                    (job.instance->getCapabilities().flags & AJM_PLUGIN_CAP_BATCH_DECODE) != 0;
+            }
+
+            std::lock_guard<std::mutex> strandLock(strand->mutex);
+            strand->queue.push_back(PendingJob{&job, batch});
+            if (!strand->running) {
+                strand->running = true;
+                toSchedule.push_back(strand.get());
+            }
+        }
+    }
+
+    WorkStealingPool& decodePool = getPool();
+    for (Strand* strand : toSchedule) {
+        decodePool.submit(PoolTask{&AjmBatchScheduler::runStrand, strand});
+    }
+
+    LOG_TRACE("AjmBatch", "Submitted batch %u: jobs=%u, strands=%zu", batchId, count,
+        toSchedule.size());
+    return batchId;
+}
+
+void AjmBatchScheduler::runStrand(void* context) {
+    Strand& strand = *static_cast<Strand*>(context);
+    const int runLimit = strand.batchDecode ? kStrandBudget : 1;
+
+    for (int budget = kStrandBudget; budget > 0;) {
+        PendingJob run[kStrandBudget];
+        int runSize = 0;
+        {
+            std::lock_guard<std::mutex> lock(strand.mutex);
+            if (strand.queue.empty()) {
+                strand.running = false;
+                strand.idleCv.notify_all();
+                return;
+            }
+            while (runSize < runLimit && runSize < budget && !strand.queue.empty()) {
+                run[runSize++] = std::move(strand.queue.front());
+                strand.queue.pop_front();
+            }
+        }
+
+        if (runSize == 1) {
+            AjmDecodeJob& job = *run[0].job;
+            job.result = job.instance->decode(job.inputData, job.inputSize, job.outputBuffer,
+                                              job.outputBufferSize, &job.outputSize);
+        } else {
+            decodeRun(run, runSize);
+        }
+
+        for (int i = 0; i < runSize; ++i) {
+            completeJob(*run[i].batch);
+        }
+        budget -= runSize;
+    }
+
+    // Budget used up: requeue behind other work instead of monopolizing the worker
+    strand.owner->getPool().submit(PoolTask{&AjmBatchScheduler::runStrand, &strand});
+}
+
+void AjmBatchScheduler::decodeRun(PendingJob* run, int count) {
+    // All jobs of a strand target the same instance
+    AjmPluginPacket packets[kStrandBudget];
+    for (int i = 0; i < count; ++i) {
+        const AjmDecodeJob& job = *run[i].job;
+        packets[i] = AjmPluginPacket{job.inputData, job.inputSize, job.outputBufferSize,
+                                     job.outputBuffer, 0, 0};
+    }
+
+    run[0].job->instance->decodeBatch(packets, static_cast<uint32_t>(count));
+
+    for (int i = 0; i < count; ++i) {
+        AjmDecodeJob& job = *run[i].job;
+        job.outputSize = packets[i].outputSize;
+        job.result = static_cast<DecodeResult>(packets[i].result);
+    }
+}
+
+void AjmBatchScheduler::completeJob(Batch& batch) {
+    if (batch.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.doneCv.notify_all();
+    }
+}
+
+std::shared_ptr<AjmBatchScheduler::Batch> AjmBatchScheduler::findBatch(uint32_t batchId) {
+    std::lock_guard<std::mutex> lock(batchesMutex);
+    auto it = batches.find(batchId);
+    return it != batches.end() ? it->second : nullptr;
+}
+
+int AjmBatchScheduler::poll(uint32_t batchId, uint32_t* completedJobs) {
+    std::shared_ptr<Batch> batch = findBatch(batchId);
+    if (!batch) {
+        return AJM_BATCH_ERROR_INVALID;
+    }
+
+    uint32_t pending = batch->pending.load(std::memory_order_acquire);
+    if (completedJobs) {
+        *completedJobs = batch->count - pending;
+    }
+    return pending == 0 ? AJM_BATCH_COMPLETE : AJM_BATCH_PENDING;
+}
+
+int AjmBatchScheduler::wait(uint32_t batchId, uint32_t timeoutUs) {
+    std::shared_ptr<Batch> batch = findBatch(batchId);
+    if (!batch) {
+        return AJM_BATCH_ERROR_INVALID;
+    }
+
+    auto done = [&batch] { return batch->pending.load(std::memory_order_acquire) == 0; };
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    if (timeoutUs == AJM_BATCH_WAIT_INFINITE) {
+        batch->doneCv.wait(lock, done);
+        return AJM_BATCH_COMPLETE;
+    }
+    return batch->doneCv.wait_for(lock, std::chrono::microseconds(timeoutUs), done)
+               ? AJM_BATCH_COMPLETE
+               : AJM_BATCH_PENDING;
+}
+
+int AjmBatchScheduler::release(uint32_t batchId) {
+    // The jobs reference caller memory, so never drop a batch that is still running
+    int status = wait(batchId, AJM_BATCH_WAIT_INFINITE);
+    if (status != AJM_BATCH_COMPLETE) {
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(batchesMutex);
+    batches.erase(batchId);
+    return AJM_BATCH_COMPLETE;
+}
+
+void AjmBatchScheduler::waitStrandIdle(Strand& strand) {
+    std::unique_lock<std::mutex> lock(strand.mutex);
+    strand.idleCv.wait(lock, [&strand] { return !strand.running && strand.queue.empty(); });
+}
+
+void AjmBatchScheduler::retireInstance(IAudioPlugin* instance) {
+    // Holding strandsMutex keeps new jobs for this instance out while it drains
+    std::lock_guard<std::mutex> lock(strandsMutex);
+    auto it = strands.find(instance);
+    if (it == strands.end()) {
+        return;
+    }
+
+    waitStrandIdle(*it->second);
+    strands.erase(it);
+}
+
+void AjmBatchScheduler::waitIdle() {
+    std::lock_guard<std::mutex> lock(strandsMutex);
+    for (auto& pair : strands) {
+        waitStrandIdle(*pair.second);
+    }
+}
+
+} // namespace ShadPS4::Audio
+
+// C interface for AJM batches
+extern "C" {
+
+/**
+ * @brief Submit a batch of decode jobs
+ * @param jobs Job array; it and all referenced buffers must stay valid until
+ *        the batch completes
+ * @param count Number of jobs
+ * @param batchId Receives the batch ID
+ * @return 0 on success, negative error code on failure
+ */
+int sceAjmBatchSubmit(ShadPS4::Audio::AjmDecodeJob* jobs, uint32_t count, uint32_t* batchId) {
+    if (!jobs || count == 0 || !batchId) {
+        LOG_ERROR_RATELIMITED("sceAjm", "Error: Invalid parameters for BatchSubmit");
+        return -1;
+    }
+
+    *batchId = ShadPS4::Audio::AjmBatchScheduler::getInstance().submit(jobs, count);
+    return *batchId != 0 ? 0 : -1;
+}
+
+/**
+ * @brief Check whether a batch has completed
+ * @param batchId Batch ID from sceAjmBatchSubmit
+ * @param completedJobs Optional; receives the number of finished jobs
+ * @return 0 if complete, 1 if pending, negative error code on failure
+ */
+int sceAjmBatchPoll(uint32_t batchId, uint32_t* completedJobs) {
+    return ShadPS4::Audio::AjmBatchScheduler::getInstance().poll(batchId, completedJobs);
+}
+
+/**
+ * @brief Wait for a batch to complete
+ * @param batchId Batch ID from sceAjmBatchSubmit
+ * @param timeoutUs Timeout in microseconds, 0xFFFFFFFF to wait forever
+ * @return 0 if complete, 1 on timeout, negative error code on failure
+ */
+int sceAjmBatchWait(uint32_t batchId, uint32_t timeoutUs) {
+    return ShadPS4::Audio::AjmBatchScheduler::getInstance().wait(batchId, timeoutUs);
+}
+
+/**
+ * @brief Release a batch ID, waiting for outstanding jobs first
+ * @param batchId Batch ID from sceAjmBatchSubmit
+ * @return 0 on success, negative error code on failure
+ */
+int sceAjmBatchRelease(uint32_t batchId) {
+    return ShadPS4::Audio::AjmBatchScheduler::getInstance().release(batchId);
+}
+
+} // extern "C"
@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * @file ajm_batch.h
+ * @brief AJM batch job scheduling for ShadPS4
+ *
+ * Modeled on the console's AJM batches: a guest submits many decode jobs,
+ * possibly across many plugin instances, and gets back a batch ID it can
+ * poll or wait on. Jobs run on a work-stealing pool sized to the host's
+ * cores. Jobs that target the same plugin instance run one at a time, in
+ * submission order (a per-instance strand); jobs on different instances
+ * run in parallel. Instances that advertise AJM_PLUGIN_CAP_BATCH_DECODE get
+ * the queued jobs of their strand in one decodeBatch() call.
+ */
+
+#include "plugin_interface.h"
+#include "ajm_thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief One decode job in a batch
+ *
+ * The caller owns the job array and every buffer it references; they must
+ * stay valid until the batch completes. The scheduler fills in outputSize
+ * and result.
+ */
+struct AjmDecodeJob {
+    IAudioPlugin* instance;     // Plugin instance from sceAjmAcquirePlugin
+    const uint8_t* inputData;   // Compressed audio data
+    uint32_t inputSize;         // Size of input data in bytes
+    void* outputBuffer;         // PCM output buffer
+    uint32_t outputBufferSize;  // Size of output buffer in bytes
+    uint32_t outputSize;        // Bytes written (filled by scheduler)
+    DecodeResult result;        // Decode result (filled by scheduler)
+};
+
+/**
+ * @brief Batch status codes returned by poll and wait
+ */
+enum AjmBatchStatus : int {
+    AJM_BATCH_COMPLETE = 0,         // All jobs finished
+    AJM_BATCH_PENDING = 1,          // Jobs still queued or running
+    AJM_BATCH_ERROR_INVALID = -1    // Unknown batch ID or bad arguments
+};
+
+// Timeout value for AjmBatchScheduler::wait() that never expires
+constexpr uint32_t AJM_BATCH_WAIT_INFINITE = 0xFFFFFFFF;
+
+/**
+ * @brief Schedules batches of decode jobs onto the decode pool
+ */
+class AjmBatchScheduler {
+public:
+    static AjmBatchScheduler& getInstance();
+
+    /**
+     * @brief Queue a batch of jobs
+     * @param jobs Job array, owned by the caller until the batch completes
+     * @param count Number of jobs
+     * @return Batch ID (never 0), or 0 if the arguments are invalid
+     */
+    uint32_t submit(AjmDecodeJob* jobs, uint32_t count);
+
+    /**
+     * @brief Check a batch without blocking
+     * @param completedJobs Optional; receives the number of finished jobs
+     * @return AJM_BATCH_COMPLETE, AJM_BATCH_PENDING or AJM_BATCH_ERROR_INVALID
+     */
+    int poll(uint32_t batchId, uint32_t* completedJobs = nullptr);
+
+    /**
+     * @brief Block until a batch completes or the timeout expires
+     * @param timeoutUs Timeout in microseconds, or AJM_BATCH_WAIT_INFINITE
+     * @return AJM_BATCH_COMPLETE, AJM_BATCH_PENDING on timeout, or
+     *         AJM_BATCH_ERROR_INVALID
+     */
+    int wait(uint32_t batchId, uint32_t timeoutUs);
+
+    /**
+     * @brief Forget a batch ID, waiting for its jobs first if necessary
+     * @return AJM_BATCH_COMPLETE or AJM_BATCH_ERROR_INVALID
+     */
+    int release(uint32_t batchId);
+
+    /**
+     * @brief Wait for all queued jobs of an instance and drop its strand
+     *
+     * Must be called before a plugin instance is destroyed.
+     */
+    void retireInstance(IAudioPlugin* instance);
+
+    /**
+     * @brief Wait until every queued job has finished
+     */
+    void waitIdle();
+
+private:
+    struct Batch {
+        AjmDecodeJob* jobs;
+        uint32_t count;
+        std::atomic<uint32_t> pending;
+        std::mutex mutex;
+        std::condition_variable doneCv;
+    };
+
+    struct PendingJob {
+        AjmDecodeJob* job;
+        std::shared_ptr<Batch> batch;
+    };
+
+    struct Strand {
+        AjmBatchScheduler* owner;
+        std::mutex mutex;
+        std::condition_variable idleCv;
+        std::deque<PendingJob> queue;
+        bool running = false;   // A pool task currently owns this strand
+        bool batchDecode = false; // Instance takes several queued jobs per decodeBatch() call
+    };
+
+    AjmBatchScheduler() = default;
+    ~AjmBatchScheduler() = default;
+
+    // Disable copy constructor and assignment
+    AjmBatchScheduler(const AjmBatchScheduler&) = delete;
+    AjmBatchScheduler& operator=(const AjmBatchScheduler&) = delete;
+
+    WorkStealingPool& getPool();
+    std::shared_ptr<Batch> findBatch(uint32_t batchId);
+    static void runStrand(void* context);
+    static void decodeRun(PendingJob* run, int count);
+    static void completeJob(Batch& batch);
+    static void waitStrandIdle(Strand& strand);
+
+    std::unique_ptr<WorkStealingPool> pool;
+    std::once_flag poolOnce;
+
+    std::unordered_map<IAudioPlugin*, std::unique_ptr<Strand>> strands;
+    std::mutex strandsMutex;
+
+    std::unordered_map<uint32_t, std::shared_ptr<Batch>> batches;
+    uint32_t nextBatchId = 1;
+    std::mutex batchesMutex;
+};
+
+} // namespace ShadPS4::Audio
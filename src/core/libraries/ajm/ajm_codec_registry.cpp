@@ -0,0 +1,163 @@
+/**
+ * @file ajm_codec_registry.cpp
+ * @brief Lock-free codec name registry for ShadPS4 AJM
+ *
+ * This file implements the copy-on-write snapshots behind codec name
+ * interning, the central alias table and plugin bindings.
+ */
+
+#include "ajm_codec_registry.h"
+#include "common/logging/log.h"
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+/**
+ * @brief Built-in codec names and the other spellings games and tools use for them
+ */
+struct BuiltInCodec {
+    const char* name;
+    const char* aliases[2];
+};
+
+constexpr BuiltInCodec kBuiltInCodecs[] = {
+    {"M4AAC", {"AAC", "MPEG4AAC"}},
+    {"OPUS", {nullptr, nullptr}},
+    {"AT9", {"ATRAC9", nullptr}},
+};
+
+} // namespace
+
+CodecRegistry& CodecRegistry::getInstance() {
+    // Intentionally leaked: plugins resolve codecs from static destructors during shutdown
+    static CodecRegistry* instance = new CodecRegistry();
+    return *instance;
+}
+
+CodecRegistry::CodecRegistry() : current(nullptr) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->canonicalNames.emplace_back();
+    snapshot->bindings.push_back(CodecBinding{});
+    publishLocked(std::move(snapshot));
+
+    for (const BuiltInCodec& codec : kBuiltInCodecs) {
+        CodecId codecId = internLocked(codec.name);
+        for (const char* alias : codec.aliases) {
+            if (alias) {
+                addAliasLocked(alias, codecId);
+            }
+        }
+    }
+}
+
+std::string CodecRegistry::normalize(std::string_view name) {
+    // Codec names are short enough to stay in the small-string buffer
+    std::string result(name);
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+void CodecRegistry::publishLocked(std::unique_ptr<Snapshot> snapshot) {
+    current.store(snapshot.get(), std::memory_order_release);
+    versions.push_back(std::move(snapshot));
+}
+
+CodecId CodecRegistry::internLocked(std::string_view name) {
+    if (name.empty()) {
+        return kInvalidCodecId;
+    }
+
+    const Snapshot* snapshot = current.load(std::memory_order_relaxed);
+    std::string key = normalize(name);
+    auto it = snapshot->names.find(key);
+    if (it != snapshot->names.end()) {
+        return it->second;
+    }
+
+    auto next = std::make_unique<Snapshot>(*snapshot);
+    CodecId codecId = static_cast<CodecId>(next->canonicalNames.size());
+    next->names.emplace(std::move(key), codecId);
+    next->canonicalNames.emplace_back(name);
+    next->bindings.push_back(CodecBinding{});
+    publishLocked(std::move(next));
+
+    LOG_DEBUG("CodecRegistry", "Interned codec %.*s as %u", static_cast<int>(name.size()),
+        name.data(), codecId);
+    return codecId;
+}
+
+CodecId CodecRegistry::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return internLocked(name);
+}
+
+bool CodecRegistry::addAlias(std::string_view alias, CodecId codecId) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return addAliasLocked(alias, codecId);
+}
+
+bool CodecRegistry::addAliasLocked(std::string_view alias, CodecId codecId) {
+    const Snapshot* snapshot = current.load(std::memory_order_relaxed);
+    if (alias.empty() || codecId == kInvalidCodecId || codecId >= snapshot->canonicalNames.size()) {
+        return false;
+    }
+
+    std::string key = normalize(alias);
+    auto it = snapshot->names.find(key);
+    if (it != snapshot->names.end()) {
+        return it->second == codecId;
+    }
+
+    auto next = std::make_unique<Snapshot>(*snapshot);
+    next->names.emplace(std::move(key), codecId);
+    publishLocked(std::move(next));
+    return true;
+}
+
+CodecId CodecRegistry::resolve(std::string_view name) const {
+    const Snapshot* snapshot = current.load(std::memory_order_acquire);
+    auto it = snapshot->names.find(normalize(name));
+    return it != snapshot->names.end() ? it->second : kInvalidCodecId;
+}
+
+const char* CodecRegistry::getName(CodecId codecId) const {
+    const Snapshot* snapshot = current.load(std::memory_order_acquire);
+    if (codecId >= snapshot->canonicalNames.size()) {
+        return "";
+    }
+    return snapshot->canonicalNames[codecId].c_str();
+}
+
+CodecBinding CodecRegistry::lookup(CodecId codecId) const {
+    const Snapshot* snapshot = current.load(std::memory_order_acquire);
+    if (codecId == kInvalidCodecId || codecId >= snapshot->bindings.size()) {
+        return CodecBinding{};
+    }
+    return snapshot->bindings[codecId];
+}
+
+void CodecRegistry::bind(CodecId codecId, const CodecBinding& binding) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    const Snapshot* snapshot = current.load(std::memory_order_relaxed);
+    if (codecId == kInvalidCodecId || codecId >= snapshot->bindings.size()) {
+        return;
+    }
+
+    auto next = std::make_unique<Snapshot>(*snapshot);
+    next->bindings[codecId] = binding;
+    publishLocked(std::move(next));
+}
+
+void CodecRegistry::unbind(CodecId codecId) {
+    bind(codecId, CodecBinding{});
+}
+
+} // namespace ShadPS4::Audio
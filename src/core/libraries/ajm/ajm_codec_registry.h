@@ -0,0 +1,124 @@
+#pragma once
+
+/**
+ * @file ajm_codec_registry.h
+ * @brief Lock-free codec name registry for ShadPS4 AJM
+ *
+ * Codec names are interned into small integer IDs when plugins register,
+ * and every spelling of a codec (case-insensitive, plus aliases such as
+ * "AAC" for "M4AAC") maps to the same ID. The name table and the plugin
+ * bound to each ID live in an immutable snapshot that writers replace with
+ * an atomic pointer swap; readers never take a lock.
+ *
+ * Writers (plugin registration, lazy loading, unloading) are rare, so
+ * replaced snapshots are simply kept until process exit instead of being
+ * reclaimed. This keeps readers wait-free without hazard pointers or epochs.
+ */
+
+#include "plugin_interface.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+using CodecId = uint32_t;
+constexpr CodecId kInvalidCodecId = 0;
+
+class PluginModule;
+
+/**
+ * @brief Plugin bound to a codec ID
+ *
+ * plugin is nullptr for lazily loaded plugins whose library is not open yet;
+ * module is nullptr until then as well.
+ */
+struct CodecBinding {
+    IAudioPlugin* plugin;                   // Shared plugin instance (sceAjmGetPlugin)
+    PluginModule* module;                   // Factory for per-stream instances
+    uint32_t apiVersion;                    // Interface version the plugin was built against
+};
+
+/**
+ * @brief Process-wide codec name and plugin binding registry
+ */
+class CodecRegistry {
+public:
+    static CodecRegistry& getInstance();
+
+    /**
+     * @brief Get the ID for a codec name, creating it if unknown
+     * @param name Codec name or alias (case-insensitive)
+     * @return Codec ID, or kInvalidCodecId for an empty name
+     */
+    CodecId intern(std::string_view name);
+
+    /**
+     * @brief Make another name resolve to an existing codec
+     * @return true if the alias now maps to codecId, false if it already names another codec
+     */
+    bool addAlias(std::string_view alias, CodecId codecId);
+
+    /**
+     * @brief Look up a codec name without creating it (lock-free)
+     * @return Codec ID, or kInvalidCodecId if the name is unknown
+     */
+    CodecId resolve(std::string_view name) const;
+
+    /**
+     * @brief Get the canonical name of a codec (lock-free)
+     * @return Name as first interned, or "" for an unknown ID; valid until process exit
+     */
+    const char* getName(CodecId codecId) const;
+
+    /**
+     * @brief Get the plugin bound to a codec (lock-free)
+     * @return Binding; all fields are null if no plugin is bound
+     */
+    CodecBinding lookup(CodecId codecId) const;
+
+    /**
+     * @brief Bind a plugin to a codec, replacing any previous binding
+     */
+    void bind(CodecId codecId, const CodecBinding& binding);
+
+    /**
+     * @brief Remove the plugin bound to a codec
+     */
+    void unbind(CodecId codecId);
+
+private:
+    /**
+     * @brief Immutable registry contents
+     */
+    struct Snapshot {
+        std::unordered_map<std::string, CodecId> names;    // Lowercased name or alias -> ID
+        std::vector<std::string> canonicalNames;           // Indexed by ID; [0] unused
+        std::vector<CodecBinding> bindings;                // Indexed by ID; [0] unused
+    };
+
+    CodecRegistry();
+    ~CodecRegistry() = default;
+
+    // Disable copy constructor and assignment
+    CodecRegistry(const CodecRegistry&) = delete;
+    CodecRegistry& operator=(const CodecRegistry&) = delete;
+
+    static std::string normalize(std::string_view name);
+
+    CodecId internLocked(std::string_view name);
+    bool addAliasLocked(std::string_view alias, CodecId codecId);
+    void publishLocked(std::unique_ptr<Snapshot> snapshot);
+
+    std::atomic<const Snapshot*> current;
+    std::vector<std::unique_ptr<Snapshot>> versions;   // Every published snapshot (never freed)
+    std::mutex writerMutex;
+};
+
+} // namespace ShadPS4::Audio
@@ -7,7 +7,12 @@
  */
 
 #include "plugin_interface.h"
-#include <iostream>
+#include "ajm_batch.h"
+#include "ajm_codec_registry.h"
+#include "ajm_plugin_manifest.h"
+#include "ajm_plugin_module.h"
+#include "common/logging/log.h"
+#include <filesystem>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -24,16 +29,37 @@
 
 namespace ShadPS4::Audio {
 
+// Built-in plugin factories (plugin_m4aac.cpp, plugin_opus.cpp, plugin_at9.cpp)
+IAudioPlugin* createM4aacPlugin();
+void destroyM4aacPlugin(IAudioPlugin* plugin);
+IAudioPlugin* createOpusPlugin();
+void destroyOpusPlugin(IAudioPlugin* plugin);
+IAudioPlugin* createAt9Plugin();
+void destroyAt9Plugin(IAudioPlugin* plugin);
+
 /**
  * @brief Plugin registry entry
  */
 struct PluginEntry {
     std::unique_ptr<IAudioPlugin> plugin;
     PluginInfo info;
+    CodecId codecId;     // Interned info.codecType
     bool isBuiltIn;
-    void* libraryHandle; // For dynamically loaded plugins
+    void* libraryHandle; // For dynamically loaded plugins (nullptr until first use if lazy)
+    std::string libraryPath; // Library to open on first use (lazy plugins from the directory scan)
+    std::unique_ptr<PluginModule> module; // Factory for per-stream instances (must die before the library)
+    int pendingInstances;   // Instances being created outside the lock; the module must stay loaded
     
-    PluginEntry() : plugin(nullptr), isBuiltIn(true), libraryHandle(nullptr) {}
+    PluginEntry() : plugin(nullptr), codecId(kInvalidCodecId), isBuiltIn(true), libraryHandle(nullptr),
+                    pendingInstances(0) {}
+};
+
+/**
+ * @brief Bookkeeping for a per-stream plugin instance handed out by the loader
+ */
+struct LiveInstance {
+    CodecId codecId;
+    PluginModule* module;   // Module that created the instance
 };
 
 /**
@@ -48,14 +74,24 @@ public:
     bool initializePlugins();
     void shutdownPlugins();
     
-    bool registerBuiltInPlugin(std::unique_ptr<IAudioPlugin> plugin);
+    bool registerBuiltInPlugin(std::unique_ptr<IAudioPlugin> plugin,
+                               CreatePluginInstanceFunc createFunc = nullptr,
+                               DestroyPluginInstanceFunc destroyFunc = nullptr);
     bool loadDynamicPlugin(const std::string& pluginPath);
     void unloadDynamicPlugin(const std::string& codecType);
     
     IAudioPlugin* getPlugin(const std::string& codecType);
+    IAudioPlugin* getPlugin(CodecId codecId);
     std::vector<PluginInfo> getAvailablePlugins() const;
     
+    IAudioPlugin* acquirePluginInstance(const std::string& codecType, const AudioFormat& format);
+    IAudioPlugin* acquirePluginInstance(CodecId codecId, const AudioFormat& format);
+    void releasePluginInstance(IAudioPlugin* instance);
+    int prewarmPluginInstances(const std::string& codecType, const AudioFormat& format, int count);
+    bool getInstanceStats(IAudioPlugin* instance, PluginStats& stats) const;
+    
     bool isInitialized() const { return initialized; }
+    void setPluginDirectory(const std::string& directory);
 
 private:
     AjmPluginLoader() = default;
@@ -66,10 +102,22 @@ private:
     AjmPluginLoader& operator=(const AjmPluginLoader&) = delete;
     
     void registerBuiltInPlugins();
+    bool registerPluginLocked(PluginEntry& entry);
+    void destroyEntryPlugin(PluginEntry& entry);
+    void scanPluginDirectoryLocked();
+    PluginManifestEntry probeLibrary(const std::string& path, uint64_t fileSize, int64_t modifiedTime);
+    void registerLazyPluginLocked(const PluginManifestEntry& manifestEntry);
+    bool ensureLoadedLocked(PluginEntry& entry);
+    CodecBinding loadBinding(CodecId codecId);
+    void publishBindingLocked(const PluginEntry& entry);
+    std::unique_ptr<PluginModule> openModule(void* handle, const std::string& path);
     void* loadLibrary(const std::string& path);
     void unloadLibrary(void* handle);
+    void* findSymbol(void* handle, const char* name);
     
-    std::unordered_map<std::string, PluginEntry> plugins;
+    std::unordered_map<CodecId, PluginEntry> plugins;  // Lookups by name go through CodecRegistry
+    std::string pluginDirectory = "plugins";
+    std::unordered_map<IAudioPlugin*, LiveInstance> liveInstances;
     mutable std::mutex pluginMutex;
     bool initialized = false;
 };
@@ -87,22 +135,22 @@ bool AjmPluginLoader::initializePlugins() {
     std::lock_guard<std::mutex> lock(pluginMutex);
     
     if (initialized) {
-        std::cout << "[AjmPluginLoader] Already initialized" << std::endl;
+        LOG_INFO("AjmPluginLoader", "Already initialized");
         return true;
     }
     
-    std::cout << "[AjmPluginLoader] Initializing plugin system" << std::endl;
+    LOG_INFO("AjmPluginLoader", "Initializing plugin system");
     
     // Register built-in plugins
     registerBuiltInPlugins();
     
-    // TODO: Scan for dynamic plugins in plugin directory
-    // This would involve scanning a plugins/ directory for .dll/.so files
+    // Register dynamic plugins from the plugin directory; libraries are
+    // opened the first time their codec is requested
+    scanPluginDirectoryLocked();
     
     initialized = true;
     
-    std::cout << "[AjmPluginLoader] Plugin system initialized with " 
-              << plugins.size() << " plugins" << std::endl;
+    LOG_INFO("AjmPluginLoader", "Plugin system initialized with %zu plugins", plugins.size());
     
     return true;
 }
@@ -114,16 +162,27 @@ void AjmPluginLoader::shutdownPlugins() {
         return;
     }
     
-    std::cout << "[AjmPluginLoader] Shutting down plugin system" << std::endl;
+    LOG_INFO("AjmPluginLoader", "Shutting down plugin system");
+    
+    // Destroy per-stream instances before their libraries go away
+    if (!liveInstances.empty()) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Destroying %zu unreleased plugin instances",
+            liveInstances.size());
+    }
+    for (auto& pair : liveInstances) {
+        AjmBatchScheduler::getInstance().retireInstance(pair.first);
+        pair.first->shutdown();
+        pair.second.module->destroyInstance(pair.first);
+    }
+    liveInstances.clear();
     
     // Shutdown and unload all plugins
     for (auto& pair : plugins) {
         PluginEntry& entry = pair.second;
         
-        if (entry.plugin) {
-            entry.plugin->shutdown();
-            entry.plugin.reset();
-        }
+        CodecRegistry::getInstance().unbind(entry.codecId);
+        destroyEntryPlugin(entry);
+        entry.module.reset();
         
         // Unload dynamic libraries
         if (!entry.isBuiltIn && entry.libraryHandle) {
@@ -135,109 +194,129 @@ void AjmPluginLoader::shutdownPlugins() {
     plugins.clear();
     initialized = false;
     
-    std::cout << "[AjmPluginLoader] Plugin system shutdown completed" << std::endl;
+    LOG_INFO("AjmPluginLoader", "Plugin system shutdown completed");
 }
 
-bool AjmPluginLoader::registerBuiltInPlugin(std::unique_ptr<IAudioPlugin> plugin) {
+bool AjmPluginLoader::registerBuiltInPlugin(std::unique_ptr<IAudioPlugin> plugin,
+                                            CreatePluginInstanceFunc createFunc,
+                                            DestroyPluginInstanceFunc destroyFunc) {
     if (!plugin) {
-        std::cerr << "[AjmPluginLoader] Error: Null plugin provided" << std::endl;
-        return false;
-    }
-    
-    PluginInfo info = plugin->getPluginInfo();
-    std::string codecType = info.codecType;
-    
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    // Check if plugin already exists
-    if (plugins.find(codecType) != plugins.end()) {
-        std::cerr << "[AjmPluginLoader] Warning: Plugin for codec " << codecType 
-                  << " already registered" << std::endl;
+        LOG_ERROR("AjmPluginLoader", "Error: Null plugin provided");
         return false;
     }
     
     // Create plugin entry
     PluginEntry entry;
+    entry.info = plugin->getPluginInfo();
     entry.plugin = std::move(plugin);
-    entry.info = info;
     entry.isBuiltIn = true;
     entry.libraryHandle = nullptr;
+    if (createFunc && destroyFunc) {
+        entry.module = std::make_unique<BuiltInPluginModule>(createFunc, destroyFunc);
+    }
+    
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    if (!registerPluginLocked(entry)) {
+        destroyEntryPlugin(entry);
+        return false;
+    }
+    return true;
+}
+
+bool AjmPluginLoader::registerPluginLocked(PluginEntry& entry) {
+    const std::string& codecType = entry.info.codecType;
+    
+    // Aliases and other spellings intern to the same ID as the codec they name
+    CodecId codecId = CodecRegistry::getInstance().intern(codecType);
+    if (codecId == kInvalidCodecId) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Plugin %s has no codec type", entry.info.name.c_str());
+        return false;
+    }
     
-    plugins[codecType] = std::move(entry);
+    // Check if plugin already exists
+    if (plugins.find(codecId) != plugins.end()) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Plugin for codec %s already registered",
+            CodecRegistry::getInstance().getName(codecId));
+        return false;
+    }
     
-    std::cout << "[AjmPluginLoader] Registered built-in plugin: " << info.name 
-              << " (v" << info.version << ") for codec " << codecType << std::endl;
+    LOG_INFO("AjmPluginLoader", "Registered %s plugin: %s (v%s) for codec %s",
+        (entry.isBuiltIn ? "built-in" : "dynamic"), entry.info.name.c_str(), entry.info.version.c_str(), codecType.c_str());
     
+    entry.codecId = codecId;
+    PluginEntry& stored = plugins[codecId];
+    stored = std::move(entry);
+    publishBindingLocked(stored);
     return true;
 }
 
+void AjmPluginLoader::publishBindingLocked(const PluginEntry& entry) {
+    CodecBinding binding{entry.plugin.get(), entry.module.get(), entry.info.apiVersion};
+    CodecRegistry::getInstance().bind(entry.codecId, binding);
+}
+
+void AjmPluginLoader::destroyEntryPlugin(PluginEntry& entry) {
+    if (!entry.plugin) {
+        return;
+    }
+    
+    entry.plugin->shutdown();
+    if (entry.module) {
+        // Free through the module that allocated the instance
+        entry.module->destroyInstance(entry.plugin.release());
+    } else {
+        entry.plugin.reset();
+    }
+}
+
 bool AjmPluginLoader::loadDynamicPlugin(const std::string& pluginPath) {
-    std::cout << "[AjmPluginLoader] Loading dynamic plugin: " << pluginPath << std::endl;
+    LOG_INFO("AjmPluginLoader", "Loading dynamic plugin: %s", pluginPath.c_str());
     
     // Load the library
     void* handle = loadLibrary(pluginPath);
     if (!handle) {
-        std::cerr << "[AjmPluginLoader] Error: Failed to load plugin library: " 
-                  << pluginPath << std::endl;
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to load plugin library: %s",
+            pluginPath.c_str());
         return false;
     }
     
-    // Get function pointers
-    CreatePluginInstanceFunc createFunc = nullptr;
-    DestroyPluginInstanceFunc destroyFunc = nullptr;
-    
-#ifdef _WIN32
-    createFunc = reinterpret_cast<CreatePluginInstanceFunc>(
-        GetProcAddress(static_cast<HMODULE>(handle), "createPluginInstance"));
-    destroyFunc = reinterpret_cast<DestroyPluginInstanceFunc>(
-        GetProcAddress(static_cast<HMODULE>(handle), "destroyPluginInstance"));
-#else
-    createFunc = reinterpret_cast<CreatePluginInstanceFunc>(
-        dlsym(handle, "createPluginInstance"));
-    destroyFunc = reinterpret_cast<DestroyPluginInstanceFunc>(
-        dlsym(handle, "destroyPluginInstance"));
-#endif
-    
-    if (!createFunc || !destroyFunc) {
-        std::cerr << "[AjmPluginLoader] Error: Plugin missing required functions" << std::endl;
+    std::unique_ptr<PluginModule> module = openModule(handle, pluginPath);
+    if (!module) {
+        LOG_ERROR("AjmPluginLoader", "Error: Plugin missing required functions");
         unloadLibrary(handle);
         return false;
     }
     
     // Create plugin instance
-    IAudioPlugin* pluginPtr = createFunc();
+    IAudioPlugin* pluginPtr = module->createInstance();
     if (!pluginPtr) {
-        std::cerr << "[AjmPluginLoader] Error: Failed to create plugin instance" << std::endl;
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to create plugin instance");
+        module.reset();
         unloadLibrary(handle);
         return false;
     }
     
-    std::unique_ptr<IAudioPlugin> plugin(pluginPtr);
-    PluginInfo info = plugin->getPluginInfo();
-    std::string codecType = info.codecType;
-    
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    // Check if plugin already exists
-    if (plugins.find(codecType) != plugins.end()) {
-        std::cerr << "[AjmPluginLoader] Warning: Plugin for codec " << codecType 
-                  << " already registered" << std::endl;
-        destroyFunc(pluginPtr);
-        unloadLibrary(handle);
-        return false;
-    }
+    PluginInfo info = pluginPtr->getPluginInfo();
     
     // Create plugin entry
     PluginEntry entry;
-    entry.plugin = std::move(plugin);
+    entry.plugin.reset(pluginPtr);
     entry.info = info;
     entry.isBuiltIn = false;
     entry.libraryHandle = handle;
+    entry.module = std::move(module);
     
-    plugins[codecType] = std::move(entry);
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    if (!registerPluginLocked(entry)) {
+        destroyEntryPlugin(entry);
+        entry.module.reset();
+        unloadLibrary(handle);
+        return false;
+    }
     
-    std::cout << "[AjmPluginLoader] Successfully loaded dynamic plugin: " << info.name 
-              << " (v" << info.version << ") for codec " << codecType << std::endl;
+    LOG_INFO("AjmPluginLoader", "Successfully loaded dynamic plugin: %s (v%s) for codec %s",
+        info.name.c_str(), info.version.c_str(), info.codecType.c_str());
     
     return true;
 }
@@ -245,28 +324,39 @@ bool AjmPluginLoader::loadDynamicPlugin(const std::string& pluginPath) {
 void AjmPluginLoader::unloadDynamicPlugin(const std::string& codecType) {
     std::lock_guard<std::mutex> lock(pluginMutex);
     
-    auto it = plugins.find(codecType);
+    CodecId codecId = CodecRegistry::getInstance().resolve(codecType);
+    auto it = plugins.find(codecId);
     if (it == plugins.end()) {
-        std::cerr << "[AjmPluginLoader] Warning: Plugin for codec " << codecType 
-                  << " not found" << std::endl;
+        LOG_WARNING("AjmPluginLoader", "Warning: Plugin for codec %s not found", codecType.c_str());
         return;
     }
     
     PluginEntry& entry = it->second;
     
     if (entry.isBuiltIn) {
-        std::cerr << "[AjmPluginLoader] Warning: Cannot unload built-in plugin for codec " 
-                  << codecType << std::endl;
+        LOG_WARNING("AjmPluginLoader", "Warning: Cannot unload built-in plugin for codec %s",
+            codecType.c_str());
+        return;
+    }
+    
+    bool acquired = entry.pendingInstances > 0;
+    for (const auto& live : liveInstances) {
+        acquired = acquired || live.second.codecId == codecId;
+    }
+    if (acquired) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Cannot unload plugin for codec %s while stream instances are still acquired",
+            codecType.c_str());
         return;
     }
     
-    std::cout << "[AjmPluginLoader] Unloading dynamic plugin for codec: " << codecType << std::endl;
+    LOG_INFO("AjmPluginLoader", "Unloading dynamic plugin for codec: %s", codecType.c_str());
+    
+    // Stop new lookups before the plugin goes away
+    CodecRegistry::getInstance().unbind(codecId);
     
     // Shutdown plugin
-    if (entry.plugin) {
-        entry.plugin->shutdown();
-        entry.plugin.reset();
-    }
+    destroyEntryPlugin(entry);
+    entry.module.reset();
     
     // Unload library
     if (entry.libraryHandle) {
@@ -275,19 +365,162 @@ void AjmPluginLoader::unloadDynamicPlugin(const std::string& codecType) {
     
     plugins.erase(it);
     
-    std::cout << "[AjmPluginLoader] Successfully unloaded plugin for codec: " << codecType << std::endl;
+    LOG_INFO("AjmPluginLoader", "Successfully unloaded plugin for codec: %s", codecType.c_str());
 }
 
-IAudioPlugin* AjmPluginLoader::getPlugin(const std::string& codecType) {
+CodecBinding AjmPluginLoader::loadBinding(CodecId codecId) {
+    // Fast path: the registry snapshot already has a loaded plugin
+    CodecBinding binding = CodecRegistry::getInstance().lookup(codecId);
+    if (binding.plugin) {
+        return binding;
+    }
+    
+    // Slow path: lazily scanned plugin whose library is not open yet
     std::lock_guard<std::mutex> lock(pluginMutex);
+    auto it = plugins.find(codecId);
+    if (it == plugins.end() || !ensureLoadedLocked(it->second)) {
+        return CodecBinding{};
+    }
+    return CodecRegistry::getInstance().lookup(codecId);
+}
+
+IAudioPlugin* AjmPluginLoader::getPlugin(const std::string& codecType) {
+    CodecId codecId = CodecRegistry::getInstance().resolve(codecType);
+    IAudioPlugin* plugin = getPlugin(codecId);
+    if (!plugin) {
+        LOG_ERROR_RATELIMITED("AjmPluginLoader", "Error: No plugin found for codec: %s", codecType.c_str());
+    }
+    return plugin;
+}
+
+IAudioPlugin* AjmPluginLoader::getPlugin(CodecId codecId) {
+    if (codecId == kInvalidCodecId) {
+        return nullptr;
+    }
+    return loadBinding(codecId).plugin;
+}
+
+IAudioPlugin* AjmPluginLoader::acquirePluginInstance(const std::string& codecType,
+                                                    const AudioFormat& format) {
+    CodecId codecId = CodecRegistry::getInstance().resolve(codecType);
+    if (codecId == kInvalidCodecId) {
+        LOG_ERROR("AjmPluginLoader", "Error: No plugin found for codec: %s", codecType.c_str());
+        return nullptr;
+    }
+    return acquirePluginInstance(codecId, format);
+}
+
+IAudioPlugin* AjmPluginLoader::acquirePluginInstance(CodecId codecId, const AudioFormat& format) {
+    const char* codecName = CodecRegistry::getInstance().getName(codecId);
     
-    auto it = plugins.find(codecType);
-    if (it == plugins.end()) {
-        std::cerr << "[AjmPluginLoader] Error: No plugin found for codec: " << codecType << std::endl;
+    CodecBinding binding = loadBinding(codecId);
+    if (!binding.plugin) {
+        LOG_ERROR("AjmPluginLoader", "Error: No plugin found for codec: %s", codecName);
+        return nullptr;
+    }
+    
+    if (!binding.module) {
+        LOG_ERROR("AjmPluginLoader", "Error: Plugin for codec %s does not support per-stream instances",
+            codecName);
         return nullptr;
     }
     
-    return it->second.plugin.get();
+    // The binding is a lock-free snapshot; pin the module so it cannot be unloaded meanwhile
+    PluginEntry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        auto it = plugins.find(codecId);
+        if (it == plugins.end() || it->second.module.get() != binding.module) {
+            LOG_ERROR("AjmPluginLoader", "Error: Plugin for codec %s was unloaded", codecName);
+            return nullptr;
+        }
+        entry = &it->second;
+        ++entry->pendingInstances;
+    }
+    
+    // Create and initialize outside the lock; decoders come from the pool
+    IAudioPlugin* instance = binding.module->createInstance();
+    if (!instance) {
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to create plugin instance for codec: %s",
+            codecName);
+    } else if (!instance->initialize(format)) {
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to initialize plugin instance for codec: %s",
+            codecName);
+        binding.module->destroyInstance(instance);
+        instance = nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    --entry->pendingInstances;
+    if (instance) {
+        liveInstances[instance] = LiveInstance{codecId, binding.module};
+    }
+    return instance;
+}
+
+void AjmPluginLoader::releasePluginInstance(IAudioPlugin* instance) {
+    if (!instance) {
+        return;
+    }
+    
+    PluginModule* module = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        
+        auto it = liveInstances.find(instance);
+        if (it == liveInstances.end()) {
+            LOG_WARNING("AjmPluginLoader", "Warning: Releasing unknown plugin instance");
+            return;
+        }
+        
+        module = it->second.module;
+        liveInstances.erase(it);
+    }
+    
+    // Let queued batch jobs for this instance finish first
+    AjmBatchScheduler::getInstance().retireInstance(instance);
+    
+    // Shutdown returns the decoder to the pool
+    instance->shutdown();
+    module->destroyInstance(instance);
+}
+
+int AjmPluginLoader::prewarmPluginInstances(const std::string& codecType,
+                                            const AudioFormat& format, int count) {
+    // Instances initialized and released again leave their decoders in the pool
+    std::vector<IAudioPlugin*> instances;
+    instances.reserve(count > 0 ? count : 0);
+    
+    for (int i = 0; i < count; ++i) {
+        IAudioPlugin* instance = acquirePluginInstance(codecType, format);
+        if (!instance) {
+            break;
+        }
+        instances.push_back(instance);
+    }
+    
+    for (IAudioPlugin* instance : instances) {
+        releasePluginInstance(instance);
+    }
+    
+    LOG_INFO("AjmPluginLoader", "Prewarmed %zu decoders for codec %s",
+        instances.size(), codecType.c_str());
+    return static_cast<int>(instances.size());
+}
+
+bool AjmPluginLoader::getInstanceStats(IAudioPlugin* instance, PluginStats& stats) const {
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        
+        if (liveInstances.find(instance) == liveInstances.end()) {
+            LOG_WARNING("AjmPluginLoader", "Warning: Stats requested for unknown plugin instance");
+            return false;
+        }
+    }
+    
+    // Counters are read without the loader lock; plugins keep them atomic.
+    // Adapters around older v1 libraries report no counters.
+    return instance->getStats(stats);
 }
 
 std::vector<PluginInfo> AjmPluginLoader::getAvailablePlugins() const {
@@ -304,19 +537,222 @@ std::vector<PluginInfo> AjmPluginLoader::getAvailablePlugins() const {
 }
 
 void AjmPluginLoader::registerBuiltInPlugins() {
-    // Forward declaration of built-in plugin creation functions
-    extern IAudioPlugin* createM4aacPlugin();
-    
-    // Register M4AAC plugin
-    std::unique_ptr<IAudioPlugin> m4aacPlugin(createM4aacPlugin());
-    if (m4aacPlugin) {
-        registerBuiltInPlugin(std::move(m4aacPlugin));
-        std::cout << "[AjmPluginLoader] Plugin M4aacDec registered" << std::endl;
-    } else {
-        std::cerr << "[AjmPluginLoader] Error: Failed to create M4AAC plugin" << std::endl;
+    // Called with pluginMutex held
+    
+    struct BuiltInPlugin {
+        const char* name;
+        CreatePluginInstanceFunc createFunc;
+        DestroyPluginInstanceFunc destroyFunc;
+    };
+    static const BuiltInPlugin builtIns[] = {
+        {"M4aacDec", createM4aacPlugin, destroyM4aacPlugin},
+        {"OpusDec", createOpusPlugin, destroyOpusPlugin},
+        {"At9Dec", createAt9Plugin, destroyAt9Plugin},
+    };
+    
+    for (const BuiltInPlugin& builtIn : builtIns) {
+        PluginEntry entry;
+        entry.module = std::make_unique<BuiltInPluginModule>(builtIn.createFunc, builtIn.destroyFunc);
+        entry.plugin.reset(entry.module->createInstance());
+        if (!entry.plugin) {
+            LOG_ERROR("AjmPluginLoader", "Error: Failed to create %s plugin", builtIn.name);
+            continue;
+        }
+        
+        entry.info = entry.plugin->getPluginInfo();
+        entry.isBuiltIn = true;
+        if (registerPluginLocked(entry)) {
+            LOG_INFO("AjmPluginLoader", "Plugin %s registered", builtIn.name);
+        } else {
+            destroyEntryPlugin(entry);
+        }
     }
 }
 
+void AjmPluginLoader::setPluginDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    if (initialized) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Plugin directory set after initialization; used on next initialization");
+    }
+    pluginDirectory = directory;
+}
+
+void AjmPluginLoader::scanPluginDirectoryLocked() {
+    namespace fs = std::filesystem;
+    
+    std::error_code error;
+    const fs::path directory(pluginDirectory);
+    if (!fs::is_directory(directory, error)) {
+        LOG_DEBUG("AjmPluginLoader", "No plugin directory at %s", pluginDirectory.c_str());
+        return;
+    }
+    
+    const std::string manifestPath = (directory / "ajm_plugins.manifest").string();
+    PluginManifest manifest;
+    manifest.load(manifestPath);
+    
+    // Only stat the libraries; unchanged ones are described by the manifest
+    std::vector<std::string> seen;
+    size_t probed = 0;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        const fs::directory_entry& file = *it;
+        if (!file.is_regular_file(error) || file.path().extension() != PLUGIN_EXTENSION) {
+            continue;
+        }
+        
+        const std::string path = file.path().string();
+        const uint64_t fileSize = file.file_size(error);
+        if (error) {
+            continue;
+        }
+        const int64_t modifiedTime = static_cast<int64_t>(
+            file.last_write_time(error).time_since_epoch().count());
+        if (error) {
+            continue;
+        }
+        seen.push_back(path);
+        
+        const PluginManifestEntry* manifestEntry = manifest.findCurrent(path, fileSize, modifiedTime);
+        if (!manifestEntry) {
+            manifest.set(probeLibrary(path, fileSize, modifiedTime));
+            manifestEntry = manifest.findCurrent(path, fileSize, modifiedTime);
+            ++probed;
+        }
+        
+        if (manifestEntry && manifestEntry->isValid) {
+            registerLazyPluginLocked(*manifestEntry);
+        }
+    }
+    
+    const size_t dropped = manifest.retainOnly(seen);
+    if (probed > 0 || dropped > 0) {
+        manifest.save(manifestPath);
+    }
+    
+    LOG_INFO("AjmPluginLoader", "Scanned %zu plugin libraries in %s (%zu probed, %zu from manifest)",
+        seen.size(), pluginDirectory.c_str(), probed, seen.size() - probed);
+}
+
+PluginManifestEntry AjmPluginLoader::probeLibrary(const std::string& path, uint64_t fileSize,
+                                                  int64_t modifiedTime) {
+    // Codec names offered to supportsCodec() to discover aliases
+    static const char* const knownCodecs[] = {"M4AAC", "AAC", "OPUS", "AT9", "ATRAC9", "MP3", "PCM"};
+    
+    PluginManifestEntry result;
+    result.path = path;
+    result.fileSize = fileSize;
+    result.modifiedTime = modifiedTime;
+    result.isValid = false;
+    result.info.apiVersion = 0;
+    
+    void* handle = loadLibrary(path);
+    if (!handle) {
+        LOG_WARNING("AjmPluginLoader", "Warning: Cannot load plugin library %s", path.c_str());
+        return result;
+    }
+    
+    // v2 libraries describe themselves from static data; v1 ones are asked
+    std::unique_ptr<PluginModule> module = openModule(handle, path);
+    if (module) {
+        result.isValid = module->describe(knownCodecs, std::size(knownCodecs), result.info,
+                                          result.aliases);
+        module.reset();
+    }
+    
+    if (!result.isValid) {
+        LOG_WARNING("AjmPluginLoader", "Warning: %s is not a usable audio plugin", path.c_str());
+    }
+    
+    unloadLibrary(handle);
+    return result;
+}
+
+void AjmPluginLoader::registerLazyPluginLocked(const PluginManifestEntry& manifestEntry) {
+    PluginEntry entry;
+    entry.info = manifestEntry.info;
+    entry.isBuiltIn = false;
+    entry.libraryPath = manifestEntry.path;
+    if (!registerPluginLocked(entry)) {
+        return;
+    }
+    
+    // Spellings the library accepts join the central alias table
+    CodecRegistry& registry = CodecRegistry::getInstance();
+    CodecId codecId = registry.resolve(manifestEntry.info.codecType);
+    for (const std::string& alias : manifestEntry.aliases) {
+        if (!registry.addAlias(alias, codecId)) {
+            LOG_DEBUG("AjmPluginLoader", "Alias %s of %s already names another codec",
+                alias.c_str(), manifestEntry.info.codecType.c_str());
+        }
+    }
+}
+
+bool AjmPluginLoader::ensureLoadedLocked(PluginEntry& entry) {
+    if (entry.isBuiltIn || entry.libraryHandle || entry.libraryPath.empty()) {
+        return true;
+    }
+    
+    LOG_INFO("AjmPluginLoader", "Loading plugin library %s on first use of codec %s",
+        entry.libraryPath.c_str(), entry.info.codecType.c_str());
+    
+    void* handle = loadLibrary(entry.libraryPath);
+    if (!handle) {
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to load plugin library: %s",
+            entry.libraryPath.c_str());
+        return false;
+    }
+    
+    std::unique_ptr<PluginModule> module = openModule(handle, entry.libraryPath);
+    IAudioPlugin* plugin = module ? module->createInstance() : nullptr;
+    if (!plugin) {
+        LOG_ERROR("AjmPluginLoader", "Error: Failed to create plugin instance from %s",
+            entry.libraryPath.c_str());
+        module.reset();
+        unloadLibrary(handle);
+        return false;
+    }
+    
+    // The library may have been replaced since the scan
+    PluginInfo info = plugin->getPluginInfo();
+    if (CodecRegistry::getInstance().resolve(info.codecType) != entry.codecId) {
+        LOG_ERROR("AjmPluginLoader", "Error: %s now provides codec %s instead of %s",
+            entry.libraryPath.c_str(), info.codecType.c_str(), entry.info.codecType.c_str());
+        module->destroyInstance(plugin);
+        module.reset();
+        unloadLibrary(handle);
+        return false;
+    }
+    
+    entry.plugin.reset(plugin);
+    entry.info = info;
+    entry.libraryHandle = handle;
+    entry.module = std::move(module);
+    publishBindingLocked(entry);
+    return true;
+}
+
+std::unique_ptr<PluginModule> AjmPluginLoader::openModule(void* handle, const std::string& path) {
+    // The v2 C ABI takes precedence when a library exports both entry points
+    auto entryPoint = reinterpret_cast<AjmGetPluginApiFunc>(findSymbol(handle, AJM_PLUGIN_API_ENTRY));
+    if (entryPoint) {
+        if (const AjmPluginApi* api = AbiPluginModule::negotiate(entryPoint, path)) {
+            return std::make_unique<AbiPluginModule>(*api);
+        }
+    }
+    
+    auto createFunc = reinterpret_cast<CreatePluginInstanceFunc>(
+        findSymbol(handle, "createPluginInstance"));
+    auto destroyFunc = reinterpret_cast<DestroyPluginInstanceFunc>(
+        findSymbol(handle, "destroyPluginInstance"));
+    if (!createFunc || !destroyFunc) {
+        return nullptr;
+    }
+    
+    auto infoFunc = reinterpret_cast<GetPluginInfoFunc>(findSymbol(handle, "getPluginInfo"));
+    auto supportsFunc = reinterpret_cast<SupportsCodecFunc>(findSymbol(handle, "supportsCodec"));
+    return std::make_unique<LegacyPluginModule>(createFunc, destroyFunc, infoFunc, supportsFunc);
+}
+
 void* AjmPluginLoader::loadLibrary(const std::string& path) {
 #ifdef _WIN32
     return LoadLibraryA(path.c_str());
@@ -325,6 +761,14 @@ void* AjmPluginLoader::loadLibrary(const std::string& path) {
 #endif
 }
 
+void* AjmPluginLoader::findSymbol(void* handle, const char* name) {
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+    return dlsym(handle, name);
+#endif
+}
+
 void AjmPluginLoader::unloadLibrary(void* handle) {
     if (!handle) return;
     
@@ -345,15 +789,33 @@ extern "C" {
  * @return 0 on success, negative error code on failure
  */
 int sceAjmInstanceCreate() {
-    std::cout << "[sceAjm] Creating AJM instance" << std::endl;
+    LOG_INFO("sceAjm", "Creating AJM instance");
     
     auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
     if (!loader.initializePlugins()) {
-        std::cerr << "[sceAjm] Error: Failed to initialize plugin system" << std::endl;
+        LOG_ERROR("sceAjm", "Error: Failed to initialize plugin system");
         return -1;
     }
     
-    std::cout << "[sceAjm] AJM instance created successfully" << std::endl;
+    LOG_INFO("sceAjm", "AJM instance created successfully");
+    return 0;
+}
+
+/**
+ * @brief Set the directory scanned for plugin libraries
+ * 
+ * Takes effect on the next sceAjmInstanceCreate. Defaults to "plugins".
+ * 
+ * @param directory Directory path
+ * @return 0 on success, negative error code on failure
+ */
+int sceAjmSetPluginDirectory(const char* directory) {
+    if (!directory) {
+        LOG_ERROR("sceAjm", "Error: Invalid plugin directory");
+        return -1;
+    }
+    
+    ShadPS4::Audio::AjmPluginLoader::getInstance().setPluginDirectory(directory);
     return 0;
 }
 
@@ -362,12 +824,12 @@ int sceAjmInstanceCreate() {
  * @return 0 on success, negative error code on failure
  */
 int sceAjmInstanceDestroy() {
-    std::cout << "[sceAjm] Destroying AJM instance" << std::endl;
+    LOG_INFO("sceAjm", "Destroying AJM instance");
     
     auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
     loader.shutdownPlugins();
     
-    std::cout << "[sceAjm] AJM instance destroyed successfully" << std::endl;
+    LOG_INFO("sceAjm", "AJM instance destroyed successfully");
     return 0;
 }
 
@@ -378,7 +840,7 @@ int sceAjmInstanceDestroy() {
  */
 ShadPS4::Audio::IAudioPlugin* sceAjmGetPlugin(const char* codecType) {
     if (!codecType) {
-        std::cerr << "[sceAjm] Error: Invalid codec type" << std::endl;
+        LOG_ERROR("sceAjm", "Error: Invalid codec type");
         return nullptr;
     }
     
@@ -386,11 +848,90 @@ ShadPS4::Audio::IAudioPlugin* sceAjmGetPlugin(const char* codecType) {
     return loader.getPlugin(std::string(codecType));
 }
 
-} // extern "C"
+/**
+ * @brief Resolve a codec name or alias to its interned ID
+ * 
+ * Names are case-insensitive. The ID stays valid for the life of the process,
+ * so callers that look up their plugin repeatedly can resolve once.
+ * 
+ * @param codecType String identifier for the codec
+ * @return Codec ID, or 0 if no plugin registered this codec
+ */
+uint32_t sceAjmResolveCodec(const char* codecType) {
+    if (!codecType) {
+        return ShadPS4::Audio::kInvalidCodecId;
+    }
+    return ShadPS4::Audio::CodecRegistry::getInstance().resolve(codecType);
+}
 
-// Built-in plugin creation function
-extern "C" ShadPS4::Audio::IAudioPlugin* createM4aacPlugin() {
-    // Forward declaration from plugin_m4aac.cpp
-    extern ShadPS4::Audio::IAudioPlugin* createPluginInstance();
-    return createPluginInstance();
+/**
+ * @brief Get the plugin for a codec ID without taking any lock
+ * @param codecId ID from sceAjmResolveCodec
+ * @return Pointer to the plugin, or nullptr if none is registered
+ */
+ShadPS4::Audio::IAudioPlugin* sceAjmGetPluginById(uint32_t codecId) {
+    return ShadPS4::Audio::AjmPluginLoader::getInstance().getPlugin(
+        static_cast<ShadPS4::Audio::CodecId>(codecId));
 }
+
+/**
+ * @brief Acquire an independent plugin instance for one audio stream
+ * @param codecType String identifier for the codec
+ * @param format Input audio format of the stream
+ * @return Initialized plugin instance owned by the caller, or nullptr on failure
+ */
+ShadPS4::Audio::IAudioPlugin* sceAjmAcquirePlugin(const char* codecType,
+                                                  const ShadPS4::Audio::AudioFormat* format) {
+    if (!codecType || !format) {
+        LOG_ERROR("sceAjm", "Error: Invalid parameters for AcquirePlugin");
+        return nullptr;
+    }
+    
+    auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
+    return loader.acquirePluginInstance(std::string(codecType), *format);
+}
+
+/**
+ * @brief Release a plugin instance obtained from sceAjmAcquirePlugin
+ * @param plugin Plugin instance to release
+ */
+void sceAjmReleasePlugin(ShadPS4::Audio::IAudioPlugin* plugin) {
+    auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
+    loader.releasePluginInstance(plugin);
+}
+
+/**
+ * @brief Open decoders ahead of time so later stream creation is a pool pop
+ * @param codecType String identifier for the codec
+ * @param format Audio format the streams will use
+ * @param count Number of decoders to prepare
+ * @return Number of decoders prepared, or negative error code on failure
+ */
+int sceAjmPrewarmDecoders(const char* codecType, const ShadPS4::Audio::AudioFormat* format,
+                          uint32_t count) {
+    if (!codecType || !format) {
+        LOG_ERROR("sceAjm", "Error: Invalid parameters for PrewarmDecoders");
+        return -1;
+    }
+    
+    auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
+    return loader.prewarmPluginInstances(std::string(codecType), *format, static_cast<int>(count));
+}
+
+/**
+ * @brief Get performance counters of a plugin instance
+ * @param plugin Plugin instance obtained from sceAjmAcquirePlugin
+ * @param stats Pointer to store the counters
+ * @return 0 on success, negative error code if the instance is unknown or keeps no counters
+ */
+int sceAjmGetPluginStats(ShadPS4::Audio::IAudioPlugin* plugin, ShadPS4::Audio::PluginStats* stats) {
+    if (!plugin || !stats) {
+        LOG_ERROR("sceAjm", "Error: Invalid parameters for GetPluginStats");
+        return -1;
+    }
+    
+    auto& loader = ShadPS4::Audio::AjmPluginLoader::getInstance();
+    return loader.getInstanceStats(plugin, *stats) ? 0 : -1;
+}
+
+} // extern "C"
@@ -0,0 +1,189 @@
+/**
+ * @file ajm_plugin_manifest.cpp
+ * @brief Cached plugin directory manifest for ShadPS4 AJM
+ *
+ * This file implements reading and atomically rewriting the plugin manifest
+ * used by the AJM plugin loader's lazy directory scan.
+ */
+
+#include "ajm_plugin_manifest.h"
+#include "common/logging/log.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+constexpr const char* kManifestMagic = "SHADPS4_AJM_MANIFEST";
+constexpr int kManifestFormatVersion = 1;
+constexpr int kManifestFields = 9;
+
+/**
+ * @brief Split a line on tabs
+ */
+std::vector<std::string> splitFields(const std::string& line, char separator) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(line);
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    if (!line.empty() && line.back() == separator) {
+        fields.emplace_back();
+    }
+    return fields;
+}
+
+/**
+ * @brief Make a string safe to store in a tab-separated line
+ */
+std::string sanitize(const std::string& value) {
+    std::string result = value;
+    for (char& c : result) {
+        if (c == '\t' || c == '\n' || c == '\r' || c == ',') {
+            c = ' ';
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Get the header line; changing either host API version invalidates the manifest
+ *
+ * v2 libraries are probed with AJM_PLUGIN_API_VERSION and may decline an
+ * older host, so a library recorded as invalid must be probed again once
+ * that version changes.
+ */
+std::string makeHeader() {
+    std::ostringstream header;
+    header << kManifestMagic << '\t' << kManifestFormatVersion << '\t' << PLUGIN_API_VERSION << '\t'
+           << AJM_PLUGIN_API_VERSION;
+    return header.str();
+}
+
+} // namespace
+
+bool PluginManifest::load(const std::string& manifestPath) {
+    entries.clear();
+
+    std::ifstream file(manifestPath);
+    if (!file) {
+        LOG_DEBUG("AjmPluginManifest", "No manifest at %s", manifestPath.c_str());
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != makeHeader()) {
+        LOG_INFO("AjmPluginManifest", "Ignoring outdated manifest %s", manifestPath.c_str());
+        return false;
+    }
+
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields = splitFields(line, '\t');
+        if (fields.size() != kManifestFields) {
+            LOG_WARNING("AjmPluginManifest", "Warning: Skipping malformed manifest line");
+            continue;
+        }
+
+        PluginManifestEntry entry;
+        try {
+            entry.path = fields[0];
+            entry.fileSize = std::stoull(fields[1]);
+            entry.modifiedTime = std::stoll(fields[2]);
+            entry.isValid = fields[3] == "1";
+            entry.info.apiVersion = static_cast<uint32_t>(std::stoul(fields[4]));
+        } catch (const std::exception&) {
+            LOG_WARNING("AjmPluginManifest", "Warning: Skipping malformed manifest line");
+            continue;
+        }
+        entry.info.codecType = fields[5];
+        entry.info.name = fields[6];
+        entry.info.version = fields[7];
+        if (!fields[8].empty()) {
+            entry.aliases = splitFields(fields[8], ',');
+        }
+        entries[entry.path] = std::move(entry);
+    }
+
+    LOG_DEBUG("AjmPluginManifest", "Loaded %zu manifest entries from %s", entries.size(),
+        manifestPath.c_str());
+    return true;
+}
+
+bool PluginManifest::save(const std::string& manifestPath) const {
+    const std::string tempPath = manifestPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file) {
+            LOG_WARNING("AjmPluginManifest", "Warning: Cannot write manifest %s", tempPath.c_str());
+            return false;
+        }
+
+        file << makeHeader() << '\n';
+        for (const auto& pair : entries) {
+            const PluginManifestEntry& entry = pair.second;
+            if (entry.path.find_first_of("\t\r\n") != std::string::npos) {
+                continue;   // Not representable; the library is probed again next time
+            }
+
+            file << entry.path << '\t' << entry.fileSize << '\t' << entry.modifiedTime << '\t'
+                 << (entry.isValid ? 1 : 0) << '\t' << entry.info.apiVersion << '\t'
+                 << sanitize(entry.info.codecType) << '\t' << sanitize(entry.info.name) << '\t'
+                 << sanitize(entry.info.version) << '\t';
+            for (size_t i = 0; i < entry.aliases.size(); ++i) {
+                file << (i ? "," : "") << sanitize(entry.aliases[i]);
+            }
+            file << '\n';
+        }
+
+        if (!file.flush()) {
+            LOG_WARNING("AjmPluginManifest", "Warning: Failed writing manifest %s", tempPath.c_str());
+            return false;
+        }
+    }
+
+    // Replace the old manifest in one step so readers never see a partial file
+    std::error_code error;
+    std::filesystem::rename(tempPath, manifestPath, error);
+    if (error) {
+        LOG_WARNING("AjmPluginManifest", "Warning: Cannot replace manifest %s: %s",
+            manifestPath.c_str(), error.message().c_str());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+const PluginManifestEntry* PluginManifest::findCurrent(const std::string& path, uint64_t fileSize,
+                                                       int64_t modifiedTime) const {
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.fileSize != fileSize ||
+        it->second.modifiedTime != modifiedTime) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void PluginManifest::set(PluginManifestEntry entry) {
+    std::string path = entry.path;
+    entries[path] = std::move(entry);
+}
+
+size_t PluginManifest::retainOnly(const std::vector<std::string>& paths) {
+    std::unordered_set<std::string> keep(paths.begin(), paths.end());
+    size_t dropped = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (keep.count(it->first) == 0) {
+            it = entries.erase(it);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+    return dropped;
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file ajm_plugin_manifest.h
+ * @brief Cached plugin directory manifest for ShadPS4 AJM
+ *
+ * Opening every plugin library at startup costs a dlopen (relocations,
+ * static constructors, dependent libraries) per installed codec. The
+ * manifest records what each library reported the last time it was probed,
+ * keyed by path, size and modification time, so later startups only stat
+ * the files and defer dlopen until a codec is first requested.
+ *
+ * The file is plain text, one tab-separated line per library, and is
+ * rewritten atomically (temporary file + rename) whenever it changes.
+ */
+
+#include "plugin_interface.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief What a plugin library reported when it was probed
+ */
+struct PluginManifestEntry {
+    std::string path;               // Library path
+    uint64_t fileSize;              // Size in bytes when probed
+    int64_t modifiedTime;           // Modification time when probed (filesystem clock ticks)
+    bool isValid;                   // false if the library could not be loaded or queried
+    PluginInfo info;                // getPluginInfo() result
+    std::vector<std::string> aliases; // Known codec names supportsCodec() accepted
+};
+
+/**
+ * @brief In-memory copy of the manifest file
+ */
+class PluginManifest {
+public:
+    /**
+     * @brief Read a manifest file
+     *
+     * A missing, unreadable or outdated file yields an empty manifest.
+     *
+     * @return true if the file was read, false otherwise
+     */
+    bool load(const std::string& manifestPath);
+
+    /**
+     * @brief Write the manifest file atomically
+     * @return true if the file was written, false otherwise
+     */
+    bool save(const std::string& manifestPath) const;
+
+    /**
+     * @brief Find the entry for a library if it has not changed since it was probed
+     * @return Entry, or nullptr if the library is unknown or its size or mtime differ
+     */
+    const PluginManifestEntry* findCurrent(const std::string& path, uint64_t fileSize,
+                                           int64_t modifiedTime) const;
+
+    /**
+     * @brief Add or replace the entry for entry.path
+     */
+    void set(PluginManifestEntry entry);
+
+    /**
+     * @brief Drop entries whose path is not in the given list
+     * @return Number of entries dropped
+     */
+    size_t retainOnly(const std::vector<std::string>& paths);
+
+    const std::unordered_map<std::string, PluginManifestEntry>& getEntries() const { return entries; }
+
+private:
+    std::unordered_map<std::string, PluginManifestEntry> entries;
+};
+
+} // namespace ShadPS4::Audio
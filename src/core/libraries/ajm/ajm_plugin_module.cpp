@@ -0,0 +1,498 @@
+/**
+ * @file ajm_plugin_module.cpp
+ * @brief Plugin modules and ABI adapters for the ShadPS4 AJM plugin loader
+ *
+ * This file implements the three plugin module kinds and the adapters that
+ * present v1 and v2 library instances to the host as IAudioPlugin objects.
+ */
+
+#include "ajm_plugin_module.h"
+#include "ajm_codec_registry.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+static_assert(AJM_PLUGIN_STATS_ERROR_KINDS == PLUGIN_STATS_ERROR_KINDS,
+              "C ABI stats layout must match PluginStats");
+static_assert(AJM_PLUGIN_STATS_HISTOGRAM_BUCKETS == PLUGIN_STATS_HISTOGRAM_BUCKETS,
+              "C ABI stats layout must match PluginStats");
+
+namespace {
+
+AjmPluginFormat toAbiFormat(const AudioFormat& format) {
+    AjmPluginFormat result{};
+    result.sampleRate = format.sampleRate;
+    result.channels = format.channels;
+    result.bitsPerSample = format.bitsPerSample;
+    result.frameSize = format.frameSize;
+    result.sampleFormat = static_cast<uint16_t>(format.sampleFormat);
+    result.codecConfig = format.codecConfig;
+    result.codecConfigSize = format.codecConfigSize;
+    result.targetSampleRate = format.targetSampleRate;
+    result.resampleQuality = static_cast<uint16_t>(format.resampleQuality);
+    result.channelMix = static_cast<uint16_t>(format.channelMix);
+    return result;
+}
+
+AudioFormat fromAbiFormat(const AjmPluginFormat& format) {
+    AudioFormat result{};
+    result.sampleRate = format.sampleRate;
+    result.channels = format.channels;
+    result.bitsPerSample = format.bitsPerSample;
+    result.frameSize = format.frameSize;
+    result.sampleFormat = static_cast<SampleFormat>(format.sampleFormat);
+    return result;
+}
+
+DecodeResult toDecodeResult(int32_t result) {
+    if (result > AJM_PLUGIN_OK || result < AJM_PLUGIN_ERROR_END_OF_STREAM) {
+        return DecodeResult::ErrorCodecFailure;
+    }
+    return static_cast<DecodeResult>(result);
+}
+
+// AudioFormat as API 1.0.0 declared it
+struct AudioFormatV10 {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bitsPerSample;
+    uint32_t frameSize;
+};
+
+// AudioFormat as API 1.1.0 and 1.2.0 declared it
+struct AudioFormatV11 {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bitsPerSample;
+    uint32_t frameSize;
+    SampleFormat sampleFormat;
+};
+
+static_assert(sizeof(AudioFormatV10) == 12 && sizeof(AudioFormatV11) == 16,
+              "Pre-1.3.0 AudioFormat layouts are fixed by the libraries built against them");
+
+/**
+ * @brief IAudioPlugin as libraries before API 1.3.0 were built against, up to getOutputFormat()
+ *
+ * Their AudioFormat is 12 or 16 bytes, which SysV x86-64 returns in RAX:RDX
+ * while today's larger struct goes through a hidden pointer. Calling the
+ * old slot through this declaration makes the compiler use the convention
+ * the library was built with; the vtable order is unchanged.
+ */
+template <typename Format>
+class LegacyPluginInterface {
+public:
+    virtual ~LegacyPluginInterface() = default;
+    virtual PluginInfo getPluginInfo() const = 0;
+    virtual bool initialize(const Format& format) = 0;
+    virtual void shutdown() = 0;
+    virtual DecodeResult decode(const uint8_t* inputData, uint32_t inputSize, void* outputBuffer,
+                                uint32_t outputBufferSize, uint32_t* outputSize) = 0;
+    virtual Format getOutputFormat() const = 0;
+};
+
+template <typename Format>
+Format getLegacyOutputFormat(const IAudioPlugin* plugin) {
+    return reinterpret_cast<const LegacyPluginInterface<Format>*>(plugin)->getOutputFormat();
+}
+
+/**
+ * @brief IAudioPlugin view of an instance created by a v1 library
+ */
+class LegacyPluginAdapter : public IAudioPlugin {
+public:
+    LegacyPluginAdapter(IAudioPlugin* plugin, DestroyPluginInstanceFunc destroyFunc,
+                        uint32_t apiVersion)
+        : plugin(plugin), destroyFunc(destroyFunc), apiVersion(apiVersion) {}
+
+    ~LegacyPluginAdapter() override {
+        destroyFunc(plugin);
+    }
+
+    PluginInfo getPluginInfo() const override { return plugin->getPluginInfo(); }
+
+    bool initialize(const AudioFormat& format) override {
+        // The library would write S16 into a buffer the host reads in the requested format
+        if (format.sampleFormat != SampleFormat::S16) {
+            LOG_ERROR("AjmPluginModule", "Error: %s is a v1 plugin and only produces S16 output",
+                plugin->getPluginInfo().codecType.c_str());
+            return false;
+        }
+        // Older libraries never read targetSampleRate and would hand out the stream's rate
+        if (apiVersion < PLUGIN_API_VERSION_RESAMPLE && format.targetSampleRate != 0 &&
+            format.targetSampleRate != format.sampleRate) {
+            LOG_ERROR("AjmPluginModule", "Error: %s predates plugin API 1.4.0 and cannot resample to %u Hz",
+                plugin->getPluginInfo().codecType.c_str(), format.targetSampleRate);
+            return false;
+        }
+        // Likewise channelMix: the codec order would be taken as remapped or downmixed
+        if (apiVersion < PLUGIN_API_VERSION_CHANNEL_MIX && format.channelMix != ChannelMix::None) {
+            LOG_ERROR("AjmPluginModule", "Error: %s predates plugin API 1.5.0 and cannot mix channels",
+                plugin->getPluginInfo().codecType.c_str());
+            return false;
+        }
+        return plugin->initialize(format);
+    }
+
+    void shutdown() override { plugin->shutdown(); }
+
+    DecodeResult decode(const uint8_t* inputData, uint32_t inputSize, void* outputBuffer,
+                        uint32_t outputBufferSize, uint32_t* outputSize) override {
+        return plugin->decode(inputData, inputSize, outputBuffer, outputBufferSize, outputSize);
+    }
+
+    AudioFormat getOutputFormat() const override {
+        // Before 1.3.0 the struct is small enough to come back in registers; see LegacyPluginInterface
+        if (apiVersion < PLUGIN_API_VERSION_SAMPLE_FORMAT) {
+            return fromLegacyFormat(getLegacyOutputFormat<AudioFormatV10>(plugin), SampleFormat::S16);
+        }
+        if (apiVersion < PLUGIN_API_VERSION_CODEC_CONFIG) {
+            const AudioFormatV11 legacy = getLegacyOutputFormat<AudioFormatV11>(plugin);
+            return fromLegacyFormat(legacy, legacy.sampleFormat);
+        }
+
+        // From 1.3.0 on it is returned through memory; the library fills only the fields it knows
+        AudioFormat format = plugin->getOutputFormat();
+        if (apiVersion < PLUGIN_API_VERSION_RESAMPLE) {
+            format.targetSampleRate = 0;
+            format.resampleQuality = ResampleQuality::Balanced;
+        }
+        if (apiVersion < PLUGIN_API_VERSION_CHANNEL_MIX) {
+            format.channelMix = ChannelMix::None;
+        }
+        return format;
+    }
+
+    bool reset() override { return plugin->reset(); }
+
+    bool supportsCodec(const std::string& codecType) const override {
+        return plugin->supportsCodec(codecType);
+    }
+
+    bool getStats(PluginStats& stats) const override {
+        // Older plugins have no getStats() slot in their vtable
+        return apiVersion >= PLUGIN_API_VERSION_STATS && plugin->getStats(stats);
+    }
+
+    PluginCapabilities getCapabilities() const override {
+        // The library's own object is never asked; v1 plugins only ever wrote S16
+        return PluginCapabilities{0, AJM_PLUGIN_FORMAT_BIT(static_cast<uint32_t>(SampleFormat::S16))};
+    }
+
+private:
+    template <typename Format>
+    static AudioFormat fromLegacyFormat(const Format& legacy, SampleFormat sampleFormat) {
+        AudioFormat format{};
+        format.sampleRate = legacy.sampleRate;
+        format.channels = legacy.channels;
+        format.bitsPerSample = legacy.bitsPerSample;
+        format.frameSize = legacy.frameSize;
+        format.sampleFormat = sampleFormat;
+        return format;
+    }
+
+    IAudioPlugin* plugin;
+    DestroyPluginInstanceFunc destroyFunc;
+    uint32_t apiVersion;
+};
+
+/**
+ * @brief IAudioPlugin view of a v2 library's function table
+ */
+class AbiPluginAdapter : public IAudioPlugin {
+public:
+    explicit AbiPluginAdapter(const AjmPluginApi& api)
+        : api(api)
+        , descriptor(*api.descriptor)
+        , codecId(CodecRegistry::getInstance().intern(api.descriptor->codecType))
+        , instance(nullptr) {}
+
+    ~AbiPluginAdapter() override {
+        shutdown();
+    }
+
+    PluginInfo getPluginInfo() const override {
+        PluginInfo info;
+        info.name = descriptor.name ? descriptor.name : "";
+        info.version = descriptor.version ? descriptor.version : "";
+        info.codecType = descriptor.codecType;
+        info.apiVersion = api.apiVersion;
+        return info;
+    }
+
+    bool initialize(const AudioFormat& format) override {
+        shutdown();
+
+        const uint32_t formatBit = AJM_PLUGIN_FORMAT_BIT(static_cast<uint32_t>(format.sampleFormat));
+        if ((getCapabilities().outputFormats & formatBit) == 0) {
+            LOG_ERROR("AjmPluginModule", "Error: %s does not produce sample format %u",
+                descriptor.codecType, static_cast<unsigned>(format.sampleFormat));
+            return false;
+        }
+        // A 2.0 plugin never reads channelMix and would hand out the codec's channel order
+        if (api.apiVersion < AJM_PLUGIN_API_VERSION_CHANNEL_MIX && format.channelMix != ChannelMix::None) {
+            LOG_ERROR("AjmPluginModule", "Error: %s predates plugin API 2.1 and cannot mix channels",
+                descriptor.codecType);
+            return false;
+        }
+
+        const AjmPluginFormat abiFormat = toAbiFormat(format);
+        instance = api.create(&abiFormat);
+        return instance != nullptr;
+    }
+
+    void shutdown() override {
+        if (instance) {
+            api.destroy(instance);
+            instance = nullptr;
+        }
+    }
+
+    DecodeResult decode(const uint8_t* inputData, uint32_t inputSize, void* outputBuffer,
+                        uint32_t outputBufferSize, uint32_t* outputSize) override {
+        if (!instance) {
+            return DecodeResult::ErrorNotInitialized;
+        }
+        if (inputData && !(descriptor.capabilities & AJM_PLUGIN_CAP_ZERO_COPY_INPUT)) {
+            inputData = stageInput(inputData, inputSize);
+        }
+        return toDecodeResult(api.decode(instance, inputData, inputSize, outputBuffer,
+                                         outputBufferSize, outputSize));
+    }
+
+    AudioFormat getOutputFormat() const override {
+        AjmPluginFormat format{};
+        if (!instance || api.getOutputFormat(instance, &format) != AJM_PLUGIN_OK) {
+            return AudioFormat{};
+        }
+        return fromAbiFormat(format);
+    }
+
+    bool reset() override {
+        return instance && api.reset(instance) == AJM_PLUGIN_OK;
+    }
+
+    bool supportsCodec(const std::string& codecType) const override {
+        // Aliases from the descriptor are in the registry
+        return CodecRegistry::getInstance().resolve(codecType) == codecId;
+    }
+
+    bool getStats(PluginStats& stats) const override {
+        AjmPluginStats abiStats{};
+        if (!instance || !api.getStats || api.getStats(instance, &abiStats) != AJM_PLUGIN_OK) {
+            return false;
+        }
+
+        stats.packets = abiStats.packets;
+        stats.frames = abiStats.frames;
+        stats.inputBytes = abiStats.inputBytes;
+        stats.outputBytes = abiStats.outputBytes;
+        stats.eagainCount = abiStats.eagainCount;
+        std::memcpy(stats.errors, abiStats.errors, sizeof(stats.errors));
+        stats.decodeTimeTotalNs = abiStats.decodeTimeTotalNs;
+        stats.decodeTimeMaxNs = abiStats.decodeTimeMaxNs;
+        std::memcpy(stats.decodeTimeHistogram, abiStats.decodeTimeHistogram,
+                    sizeof(stats.decodeTimeHistogram));
+        return true;
+    }
+
+    PluginCapabilities getCapabilities() const override {
+        PluginCapabilities capabilities{descriptor.capabilities,
+                                        AJM_PLUGIN_FORMAT_BIT(static_cast<uint32_t>(SampleFormat::S16))};
+        if (descriptor.capabilities & AJM_PLUGIN_CAP_OUTPUT_FORMATS) {
+            capabilities.outputFormats = descriptor.outputFormats;
+        }
+        // Batches would need every packet staged at once; decode them one by one instead
+        if (!(descriptor.capabilities & AJM_PLUGIN_CAP_ZERO_COPY_INPUT)) {
+            capabilities.flags &= ~AJM_PLUGIN_CAP_BATCH_DECODE;
+        }
+        return capabilities;
+    }
+
+    void decodeBatch(AjmPluginPacket* packets, uint32_t count) override {
+        if (instance && (getCapabilities().flags & AJM_PLUGIN_CAP_BATCH_DECODE)) {
+            api.decodeBatch(instance, packets, count);
+            return;
+        }
+        IAudioPlugin::decodeBatch(packets, count);
+    }
+
+    bool seek(AjmPluginPacket* primingPackets, uint32_t primingCount, uint32_t trimSamples) override {
+        if (instance && (descriptor.capabilities & AJM_PLUGIN_CAP_SEEK)) {
+            return api.seek(instance, primingPackets, primingCount, trimSamples) == AJM_PLUGIN_OK;
+        }
+        return IAudioPlugin::seek(primingPackets, primingCount, trimSamples);
+    }
+
+private:
+    /**
+     * @brief Copy input into a buffer the plugin may over-read
+     *
+     * The buffer only grows, so steady-state decoding does not allocate.
+     */
+    const uint8_t* stageInput(const uint8_t* inputData, uint32_t inputSize) {
+        const size_t required = static_cast<size_t>(inputSize) + AJM_PLUGIN_INPUT_PADDING;
+        if (staging.size() < required) {
+            staging.resize(std::max(required, staging.size() * 2));
+        }
+        std::memcpy(staging.data(), inputData, inputSize);
+        std::memset(staging.data() + inputSize, 0, AJM_PLUGIN_INPUT_PADDING);
+        return staging.data();
+    }
+
+    const AjmPluginApi& api;
+    const AjmPluginDescriptor& descriptor;
+    CodecId codecId;
+    AjmPluginInstance* instance;
+    std::vector<uint8_t> staging;
+};
+
+} // namespace
+
+BuiltInPluginModule::BuiltInPluginModule(CreatePluginInstanceFunc createFunc,
+                                         DestroyPluginInstanceFunc destroyFunc)
+    : createFunc(createFunc), destroyFunc(destroyFunc) {}
+
+IAudioPlugin* BuiltInPluginModule::createInstance() {
+    return createFunc();
+}
+
+void BuiltInPluginModule::destroyInstance(IAudioPlugin* instance) {
+    destroyFunc(instance);
+}
+
+bool BuiltInPluginModule::describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                                   std::vector<std::string>& aliases) {
+    (void)knownCodecs;
+    (void)count;
+    IAudioPlugin* instance = createFunc();
+    if (!instance) {
+        return false;
+    }
+    info = instance->getPluginInfo();
+    aliases.clear();
+    destroyFunc(instance);
+    return !info.codecType.empty();
+}
+
+LegacyPluginModule::LegacyPluginModule(CreatePluginInstanceFunc createFunc,
+                                       DestroyPluginInstanceFunc destroyFunc,
+                                       GetPluginInfoFunc infoFunc, SupportsCodecFunc supportsFunc)
+    : createFunc(createFunc)
+    , destroyFunc(destroyFunc)
+    , infoFunc(infoFunc)
+    , supportsFunc(supportsFunc)
+    , apiVersion(0) {}
+
+IAudioPlugin* LegacyPluginModule::createInstance() {
+    IAudioPlugin* plugin = createFunc();
+    if (!plugin) {
+        return nullptr;
+    }
+
+    // The reported version decides which vtable slots the adapter may use
+    std::call_once(versionOnce, [&] {
+        apiVersion = infoFunc ? infoFunc().apiVersion : plugin->getPluginInfo().apiVersion;
+    });
+    return new LegacyPluginAdapter(plugin, destroyFunc, apiVersion);
+}
+
+void LegacyPluginModule::destroyInstance(IAudioPlugin* instance) {
+    delete instance;
+}
+
+bool LegacyPluginModule::describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                                  std::vector<std::string>& aliases) {
+    // Prefer the instance-free exports; fall back to a temporary instance
+    IAudioPlugin* instance = (infoFunc && supportsFunc) ? nullptr : createFunc();
+    if (!infoFunc && !instance) {
+        return false;
+    }
+
+    info = infoFunc ? infoFunc() : instance->getPluginInfo();
+    aliases.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const char* codec = knownCodecs[i];
+        bool supported = supportsFunc ? supportsFunc(codec) : instance->supportsCodec(codec);
+        if (supported && info.codecType != codec) {
+            aliases.push_back(codec);
+        }
+    }
+
+    if (instance) {
+        destroyFunc(instance);
+    }
+    return !info.codecType.empty();
+}
+
+const AjmPluginApi* AbiPluginModule::negotiate(AjmGetPluginApiFunc entryPoint,
+                                               const std::string& path) {
+    const AjmPluginApi* api = entryPoint(AJM_PLUGIN_API_VERSION);
+    if (!api) {
+        LOG_WARNING("AjmPluginModule", "Warning: %s declined plugin API version 0x%08x",
+            path.c_str(), AJM_PLUGIN_API_VERSION);
+        return nullptr;
+    }
+
+    if (AJM_PLUGIN_API_VERSION_MAJOR(api->apiVersion) != AJM_PLUGIN_API_VERSION_MAJOR(AJM_PLUGIN_API_VERSION)) {
+        LOG_WARNING("AjmPluginModule", "Warning: %s uses plugin API version 0x%08x, host has 0x%08x",
+            path.c_str(), api->apiVersion, AJM_PLUGIN_API_VERSION);
+        return nullptr;
+    }
+
+    // Every field of the 2.0 structs is used; later minor versions only append
+    const AjmPluginDescriptor* descriptor = api->descriptor;
+    if (api->structSize < offsetof(AjmPluginApi, seek) || !descriptor ||
+        descriptor->structSize < sizeof(AjmPluginDescriptor)) {
+        LOG_WARNING("AjmPluginModule", "Warning: %s has a truncated plugin API table", path.c_str());
+        return nullptr;
+    }
+
+    if (!descriptor->codecType || !descriptor->codecType[0] || !api->create || !api->destroy ||
+        !api->decode || !api->getOutputFormat || !api->reset ||
+        ((descriptor->capabilities & AJM_PLUGIN_CAP_BATCH_DECODE) && !api->decodeBatch) ||
+        ((descriptor->capabilities & AJM_PLUGIN_CAP_SEEK) &&
+         (api->structSize < offsetof(AjmPluginApi, seek) + sizeof(api->seek) || !api->seek))) {
+        LOG_WARNING("AjmPluginModule", "Warning: %s has an incomplete plugin API table", path.c_str());
+        return nullptr;
+    }
+
+    return api;
+}
+
+AbiPluginModule::AbiPluginModule(const AjmPluginApi& api) : api(api) {}
+
+IAudioPlugin* AbiPluginModule::createInstance() {
+    return new AbiPluginAdapter(api);
+}
+
+void AbiPluginModule::destroyInstance(IAudioPlugin* instance) {
+    delete instance;
+}
+
+bool AbiPluginModule::describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                               std::vector<std::string>& aliases) {
+    (void)knownCodecs;
+    (void)count;
+    const AjmPluginDescriptor& descriptor = *api.descriptor;
+
+    // Everything comes from static data; no call into the library
+    info.name = descriptor.name ? descriptor.name : "";
+    info.version = descriptor.version ? descriptor.version : "";
+    info.codecType = descriptor.codecType;
+    info.apiVersion = api.apiVersion;
+
+    aliases.clear();
+    for (uint32_t i = 0; descriptor.aliases && i < descriptor.aliasCount; ++i) {
+        if (descriptor.aliases[i] && descriptor.aliases[i][0]) {
+            aliases.push_back(descriptor.aliases[i]);
+        }
+    }
+    return true;
+}
+
+} // namespace ShadPS4::Audio
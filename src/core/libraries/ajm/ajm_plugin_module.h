@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * @file ajm_plugin_module.h
+ * @brief Plugin modules and ABI adapters for the ShadPS4 AJM plugin loader
+ *
+ * A PluginModule is the host's handle on one source of plugin instances:
+ * the built-in factories, a v1 library (C++ interface) or a v2 library
+ * (C function table, plugin_abi.h). Dynamic libraries never hand their own
+ * objects to the rest of the host; every instance is wrapped in an adapter
+ * compiled with the host, which translates calls and only uses the parts of
+ * the library's interface its version provides.
+ */
+
+#include "plugin_interface.h"
+#include "plugin_abi.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Factory for the plugin instances of one built-in codec or library
+ */
+class PluginModule {
+public:
+    virtual ~PluginModule() = default;
+
+    /**
+     * @brief Create an uninitialized plugin instance
+     * @return Instance to be freed with destroyInstance(), or nullptr on failure
+     */
+    virtual IAudioPlugin* createInstance() = 0;
+
+    /**
+     * @brief Free an instance created by this module
+     */
+    virtual void destroyInstance(IAudioPlugin* instance) = 0;
+
+    /**
+     * @brief Describe the plugin without keeping an instance around
+     * @param knownCodecs Codec names to test against v1 supportsCodec()
+     * @param count Number of entries in knownCodecs
+     * @param info Receives the plugin information
+     * @param aliases Receives accepted codec names other than info.codecType
+     * @return true if the module describes a usable plugin
+     */
+    virtual bool describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                          std::vector<std::string>& aliases) = 0;
+};
+
+/**
+ * @brief Built-in plugin factories compiled into the host
+ */
+class BuiltInPluginModule : public PluginModule {
+public:
+    BuiltInPluginModule(CreatePluginInstanceFunc createFunc, DestroyPluginInstanceFunc destroyFunc);
+
+    IAudioPlugin* createInstance() override;
+    void destroyInstance(IAudioPlugin* instance) override;
+    bool describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                  std::vector<std::string>& aliases) override;
+
+private:
+    CreatePluginInstanceFunc createFunc;
+    DestroyPluginInstanceFunc destroyFunc;
+};
+
+/**
+ * @brief v1 library exporting createPluginInstance/destroyPluginInstance
+ *
+ * Instances are wrapped in LegacyPluginAdapter, which forwards only the
+ * vtable slots that exist in the interface version the library reports.
+ */
+class LegacyPluginModule : public PluginModule {
+public:
+    LegacyPluginModule(CreatePluginInstanceFunc createFunc, DestroyPluginInstanceFunc destroyFunc,
+                       GetPluginInfoFunc infoFunc, SupportsCodecFunc supportsFunc);
+
+    IAudioPlugin* createInstance() override;
+    void destroyInstance(IAudioPlugin* instance) override;
+    bool describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                  std::vector<std::string>& aliases) override;
+
+private:
+    CreatePluginInstanceFunc createFunc;
+    DestroyPluginInstanceFunc destroyFunc;
+    GetPluginInfoFunc infoFunc;         // Optional export
+    SupportsCodecFunc supportsFunc;     // Optional export
+    std::once_flag versionOnce;
+    uint32_t apiVersion;                // Read from the first instance
+};
+
+/**
+ * @brief v2 library exporting ajmGetPluginApi
+ */
+class AbiPluginModule : public PluginModule {
+public:
+    /**
+     * @brief Ask a library for its function table and check it against the host
+     * @param entryPoint The library's ajmGetPluginApi export
+     * @param path Library path, for log messages
+     * @return Validated table, or nullptr if the library is incompatible
+     */
+    static const AjmPluginApi* negotiate(AjmGetPluginApiFunc entryPoint, const std::string& path);
+
+    explicit AbiPluginModule(const AjmPluginApi& api);
+
+    IAudioPlugin* createInstance() override;
+    void destroyInstance(IAudioPlugin* instance) override;
+    bool describe(const char* const* knownCodecs, size_t count, PluginInfo& info,
+                  std::vector<std::string>& aliases) override;
+
+private:
+    const AjmPluginApi& api;
+};
+
+} // namespace ShadPS4::Audio
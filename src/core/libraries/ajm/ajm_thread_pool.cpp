@@ -0,0 +1,120 @@
+/**
+ * @file ajm_thread_pool.cpp
+ * @brief Work-stealing thread pool for AJM decode jobs
+ *
+ * This file implements the per-worker deques, stealing and the sleep/wake
+ * protocol of the AJM decode pool.
+ */
+
+#include "ajm_thread_pool.h"
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Identifies the pool and deque of the current worker thread
+thread_local const WorkStealingPool* t_currentPool = nullptr;
+thread_local size_t t_currentIndex = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(PoolTask task) {
+    size_t index;
+    if (t_currentPool == this) {
+        index = t_currentIndex;
+    } else {
+        index = nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+
+    // Count the task before it becomes visible so a sleeping worker cannot
+    // miss it; a worker that races ahead at most spins once more
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(task);
+    }
+    sleepCv.notify_one();
+}
+
+bool WorkStealingPool::popLocal(size_t index, PoolTask& task) {
+    Worker& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, PoolTask& task) {
+    const size_t count = workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    t_currentPool = this;
+    t_currentIndex = index;
+
+    while (true) {
+        PoolTask task;
+        if (popLocal(index, task) || steal(index, task)) {
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            task.func(task.context);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCv.wait(lock, [this] {
+            return stopping || pendingTasks.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping && pendingTasks.load(std::memory_order_relaxed) <= 0) {
+            return;
+        }
+    }
+}
+
+} // namespace ShadPS4::Audio
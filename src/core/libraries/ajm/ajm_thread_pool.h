@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * @file ajm_thread_pool.h
+ * @brief Work-stealing thread pool for AJM decode jobs
+ *
+ * Every worker owns a task deque. Workers pop their own deque LIFO (tasks a
+ * worker spawns stay hot in its cache) and steal FIFO from the other workers
+ * when they run dry. Tasks submitted from outside the pool are spread over
+ * the worker deques round-robin.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Unit of work executed by the pool
+ *
+ * A plain function pointer and context so submitting never allocates
+ * beyond the deque node.
+ */
+struct PoolTask {
+    void (*func)(void* context);
+    void* context;
+};
+
+/**
+ * @brief Fixed-size work-stealing thread pool
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Start the worker threads
+     * @param threadCount Number of workers; 0 uses the number of host cores
+     */
+    explicit WorkStealingPool(size_t threadCount = 0);
+
+    /**
+     * @brief Run all queued tasks to completion and join the workers
+     */
+    ~WorkStealingPool();
+
+    /**
+     * @brief Queue a task
+     *
+     * Called from a worker of this pool, the task goes to that worker's own
+     * deque; otherwise it is distributed round-robin.
+     */
+    void submit(PoolTask task);
+
+    /**
+     * @brief Get the number of worker threads
+     */
+    size_t getThreadCount() const { return workers.size(); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<PoolTask> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, PoolTask& task);
+    bool steal(size_t thief, PoolTask& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nextQueue{0};       // Round-robin cursor for external submits
+    std::atomic<int64_t> pendingTasks{0};   // Queued but not yet started
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    bool stopping = false;
+
+    // Disable copy constructor and assignment
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+};
+
+} // namespace ShadPS4::Audio
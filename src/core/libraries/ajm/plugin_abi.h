@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file plugin_abi.h
+ * @brief Version 2 C ABI for dynamic audio plugins in ShadPS4
+ *
+ * The v1 interface (plugin_interface.h) hands C++ objects, vtables and
+ * std::string across the library boundary, so a plugin has to be built with
+ * the host's compiler and standard library. The v2 ABI uses only POD structs
+ * and plain function pointers:
+ *
+ * - The library exports AJM_PLUGIN_API_ENTRY ("ajmGetPluginApi"). The host
+ *   passes its own AJM_PLUGIN_API_VERSION and the library returns a pointer
+ *   to a static AjmPluginApi table, or NULL if it needs a newer host.
+ * - The descriptor (names, aliases, capabilities) is static data, so the
+ *   host never calls into the library just to describe it and nothing is
+ *   allocated per call.
+ * - Minor versions only append to the structs; structSize tells the host
+ *   which fields exist. Structs the host fills in or hands out without a
+ *   structSize (AjmPluginFormat) are sized for the hostApiVersion passed to
+ *   ajmGetPluginApi, so a plugin must not write fields newer than that.
+ *
+ * Libraries that export both entry points are loaded through the v2 table.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Major version in the high 16 bits; the host rejects a different major */
+#define AJM_PLUGIN_API_VERSION 0x00020002u
+#define AJM_PLUGIN_API_VERSION_MAJOR(version) ((version) >> 16)
+
+/* First version whose AjmPluginFormat carries channelMix */
+#define AJM_PLUGIN_API_VERSION_CHANNEL_MIX 0x00020001u
+
+/* Name of the exported AjmGetPluginApiFunc */
+#define AJM_PLUGIN_API_ENTRY "ajmGetPluginApi"
+
+/* Bytes past the end of the input a plugin without ZERO_COPY_INPUT may read */
+#define AJM_PLUGIN_INPUT_PADDING 64u
+
+/* Capability flags (AjmPluginDescriptor::capabilities) */
+#define AJM_PLUGIN_CAP_BATCH_DECODE    0x00000001u /* decodeBatch is implemented */
+#define AJM_PLUGIN_CAP_OUTPUT_FORMATS  0x00000002u /* outputFormats is valid; otherwise S16 only */
+#define AJM_PLUGIN_CAP_ZERO_COPY_INPUT 0x00000004u /* decode reads exactly inputSize bytes in place */
+#define AJM_PLUGIN_CAP_SEEK            0x00000008u /* seek is implemented (API 2.2) */
+
+/* Bit for a sample format in AjmPluginDescriptor::outputFormats (values of SampleFormat) */
+#define AJM_PLUGIN_FORMAT_BIT(sampleFormat) (1u << (sampleFormat))
+
+/* Return codes; identical to the DecodeResult values of the v1 interface */
+#define AJM_PLUGIN_OK                      0
+#define AJM_PLUGIN_ERROR_INVALID_INPUT     (-1)
+#define AJM_PLUGIN_ERROR_INSUFFICIENT_BUFFER (-2)
+#define AJM_PLUGIN_ERROR_CODEC_FAILURE     (-3)
+#define AJM_PLUGIN_ERROR_NOT_INITIALIZED   (-4)
+#define AJM_PLUGIN_ERROR_END_OF_STREAM     (-5)
+
+#define AJM_PLUGIN_STATS_ERROR_KINDS 8
+#define AJM_PLUGIN_STATS_HISTOGRAM_BUCKETS 32
+
+/**
+ * @brief Static description of a plugin library
+ */
+typedef struct AjmPluginDescriptor {
+    uint32_t structSize;            /* sizeof(AjmPluginDescriptor) the plugin was built with */
+    uint32_t reserved;
+    const char* name;               /* e.g. "MP3 Decoder" */
+    const char* version;            /* e.g. "1.0.0" */
+    const char* codecType;          /* Canonical codec name, e.g. "MP3" */
+    const char* const* aliases;     /* Other accepted names; may be NULL */
+    uint32_t aliasCount;
+    uint32_t capabilities;          /* AJM_PLUGIN_CAP_* */
+    uint32_t outputFormats;         /* AJM_PLUGIN_FORMAT_BIT mask (with AJM_PLUGIN_CAP_OUTPUT_FORMATS) */
+    uint32_t reserved2;
+} AjmPluginDescriptor;
+
+/**
+ * @brief Stream format; the C layout of AudioFormat
+ */
+typedef struct AjmPluginFormat {
+    uint32_t sampleRate;            /* Hz */
+    uint16_t channels;
+    uint16_t bitsPerSample;
+    uint32_t frameSize;             /* Bytes per frame of output */
+    uint16_t sampleFormat;          /* SampleFormat value */
+    uint16_t resampleQuality;       /* ResampleQuality value, used with targetSampleRate */
+    const uint8_t* codecConfig;     /* Codec setup data; valid during create() only */
+    uint32_t codecConfigSize;
+    uint32_t targetSampleRate;      /* Output rate to resample to; 0 (older hosts) keeps the stream's rate */
+    /* 2.1 */
+    uint16_t channelMix;            /* ChannelMix value; 0 keeps the codec's channel order */
+    uint16_t reserved;
+    uint32_t reserved2;
+} AjmPluginFormat;
+
+/**
+ * @brief One packet of a decodeBatch() call
+ */
+typedef struct AjmPluginPacket {
+    const uint8_t* inputData;       /* Compressed data, or NULL with inputSize 0 to drain */
+    uint32_t inputSize;
+    uint32_t outputBufferSize;
+    void* outputBuffer;
+    uint32_t outputSize;            /* Filled by the plugin */
+    int32_t result;                 /* Filled by the plugin (AJM_PLUGIN_OK or error) */
+} AjmPluginPacket;
+
+/**
+ * @brief Performance counters; the C layout of PluginStats
+ */
+typedef struct AjmPluginStats {
+    uint64_t packets;
+    uint64_t frames;
+    uint64_t inputBytes;
+    uint64_t outputBytes;
+    uint64_t eagainCount;
+    uint64_t errors[AJM_PLUGIN_STATS_ERROR_KINDS];
+    uint64_t decodeTimeTotalNs;
+    uint64_t decodeTimeMaxNs;
+    uint64_t decodeTimeHistogram[AJM_PLUGIN_STATS_HISTOGRAM_BUCKETS];
+} AjmPluginStats;
+
+/* Opaque per-stream decoder state owned by the plugin */
+typedef struct AjmPluginInstance AjmPluginInstance;
+
+/**
+ * @brief Function table returned by the library's entry point
+ *
+ * All functions except decodeBatch, getStats and seek are required. Calls on one
+ * instance are never concurrent; calls on different instances may be.
+ */
+typedef struct AjmPluginApi {
+    uint32_t structSize;            /* sizeof(AjmPluginApi) the plugin was built with */
+    uint32_t apiVersion;            /* AJM_PLUGIN_API_VERSION the plugin was built with */
+    const AjmPluginDescriptor* descriptor;
+
+    /* Create a decoder for one stream; NULL if the format is not supported */
+    AjmPluginInstance* (*create)(const AjmPluginFormat* format);
+    void (*destroy)(AjmPluginInstance* instance);
+
+    /* Same contract as IAudioPlugin::decode, including draining with NULL/0 input */
+    int32_t (*decode)(AjmPluginInstance* instance, const uint8_t* inputData, uint32_t inputSize,
+                      void* outputBuffer, uint32_t outputBufferSize, uint32_t* outputSize);
+
+    /* Decode packets in order, filling each packet's outputSize and result */
+    void (*decodeBatch)(AjmPluginInstance* instance, AjmPluginPacket* packets, uint32_t count);
+
+    int32_t (*getOutputFormat)(const AjmPluginInstance* instance, AjmPluginFormat* format);
+    int32_t (*reset)(AjmPluginInstance* instance);
+
+    /* Must be safe to call while another thread decodes on the instance */
+    int32_t (*getStats)(const AjmPluginInstance* instance, AjmPluginStats* stats);
+
+    /* 2.2: same contract as IAudioPlugin::seek; returns AJM_PLUGIN_OK once positioned */
+    int32_t (*seek)(AjmPluginInstance* instance, AjmPluginPacket* primingPackets,
+                    uint32_t primingCount, uint32_t trimSamples);
+} AjmPluginApi;
+
+typedef const AjmPluginApi* (*AjmGetPluginApiFunc)(uint32_t hostApiVersion);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file plugin_at9.cpp
+ * @brief AT9 Audio Plugin Implementation for ShadPS4
+ *
+ * This file implements the built-in ATRAC9 decoding plugin. AT9 streams are
+ * described by a 4-byte config word rather than a container header; the
+ * plugin turns it into the extradata FFmpeg's atrac9 decoder expects.
+ */
+
+#include "plugin_ffmpeg.h"
+#include "../audio/CodecConfig.h"
+#include "common/logging/log.h"
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief AT9 Audio Plugin Implementation
+ *
+ * AudioFormat::codecConfig must hold the config word (or the 12-byte AT9
+ * WAVE extension). The sample rate and channel count are taken from it.
+ */
+class At9AudioPlugin : public FfmpegAudioPlugin {
+public:
+    At9AudioPlugin() : FfmpegAudioPlugin("At9Plugin", "AT9"), config{} {}
+
+    PluginInfo getPluginInfo() const override;
+
+protected:
+    bool prepareDecoder(const AudioFormat& format, DecoderSetup& setup) override;
+
+private:
+    At9CodecInfo config;    // Parsed configuration; owns the extradata during initialize()
+};
+
+PluginInfo At9AudioPlugin::getPluginInfo() const {
+    PluginInfo info;
+    info.name = "AT9 Decoder";
+    info.version = "1.0.0";
+    info.codecType = "AT9";
+    info.apiVersion = PLUGIN_API_VERSION;
+
+    return info;
+}
+
+bool At9AudioPlugin::prepareDecoder(const AudioFormat& format, DecoderSetup& setup) {
+    if (!format.codecConfig || format.codecConfigSize == 0) {
+        LOG_ERROR(logTag, "Error: AT9 needs its config word as codecConfig");
+        return false;
+    }
+
+    if (!parseAt9Config(format.codecConfig, format.codecConfigSize, config)) {
+        return false;
+    }
+
+    if (config.channels != format.channels) {
+        LOG_ERROR(logTag, "Error: AT9 config declares %d channels, format has %u",
+            config.channels, format.channels);
+        return false;
+    }
+    if (config.sampleRate != static_cast<int>(format.sampleRate)) {
+        LOG_WARNING(logTag, "Warning: AT9 config declares %d Hz, format has %u Hz; using %d Hz",
+            config.sampleRate, format.sampleRate, config.sampleRate);
+    }
+
+    setup.codecId = AV_CODEC_ID_ATRAC9;
+    setup.sampleRate = config.sampleRate;
+    setup.channels = config.channels;
+    setup.codecConfig = config.extradata;
+    setup.codecConfigSize = kAt9ExtradataSize;
+    return true;
+}
+
+/**
+ * @brief Create a built-in AT9 plugin instance
+ * @return Pointer to the created plugin instance
+ */
+IAudioPlugin* createAt9Plugin() {
+    return new At9AudioPlugin();
+}
+
+/**
+ * @brief Destroy a built-in AT9 plugin instance
+ * @param plugin Pointer to the plugin instance to destroy
+ */
+void destroyAt9Plugin(IAudioPlugin* plugin) {
+    delete plugin;
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,376 @@
+/**
+ * @file plugin_ffmpeg.cpp
+ * @brief Shared base for FFmpeg-backed audio plugins in ShadPS4
+ *
+ * This file implements the IAudioPlugin methods common to the built-in
+ * codec plugins. Decoders are taken from and returned to the shared
+ * DecoderPool.
+ */
+
+#include "plugin_ffmpeg.h"
+#include "../audio/DecodeTrace.h"
+#include "../audio/DecoderPool.h"
+#include "common/logging/log.h"
+#include <vector>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+/**
+ * @brief Map a plugin sample format to the FFmpeg format the decoder writes
+ */
+AVSampleFormat toAVSampleFormat(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::S16:       return AV_SAMPLE_FMT_S16;
+    case SampleFormat::S32:       return AV_SAMPLE_FMT_S32;
+    case SampleFormat::F32:       return AV_SAMPLE_FMT_FLT;
+    case SampleFormat::S16Planar: return AV_SAMPLE_FMT_S16P;
+    case SampleFormat::S32Planar: return AV_SAMPLE_FMT_S32P;
+    case SampleFormat::F32Planar: return AV_SAMPLE_FMT_FLTP;
+    }
+    return AV_SAMPLE_FMT_NONE;
+}
+
+/**
+ * @brief Map a plugin resampling quality to the decoder's preset
+ */
+ResamplePreset toResamplePreset(ResampleQuality quality) {
+    switch (quality) {
+    case ResampleQuality::Fast: return ResamplePreset::Fast;
+    case ResampleQuality::High: return ResamplePreset::High;
+    case ResampleQuality::Balanced:
+    default: return ResamplePreset::Balanced;
+    }
+}
+
+/**
+ * @brief Map a plugin channel mix to the decoder's matrix preset
+ */
+bool toChannelMixPreset(ChannelMix mix, ChannelMixPreset& preset) {
+    switch (mix) {
+    case ChannelMix::None:          preset = ChannelMixPreset::None; return true;
+    case ChannelMix::Ps4Order71:    preset = ChannelMixPreset::Ps4Order71; return true;
+    case ChannelMix::Downmix51To20: preset = ChannelMixPreset::Downmix51To20; return true;
+    case ChannelMix::Downmix71To20: preset = ChannelMixPreset::Downmix71To20; return true;
+    case ChannelMix::Downmix71To51: preset = ChannelMixPreset::Downmix71To51; return true;
+    }
+    return false;
+}
+
+// Packets handed to OrbisAudioDecoder::decodePackets() per call
+constexpr uint32_t kBatchChunk = 16;
+
+/**
+ * @brief Map an OrbisAudioDecoder return code to a DecodeResult
+ */
+DecodeResult toDecodeResult(int result) {
+    if (result == 0) {
+        return DecodeResult::Success;
+    } else if (result == -2) {
+        return DecodeResult::ErrorInsufficientBuffer;
+    } else if (result == AVERROR_EOF) {
+        return DecodeResult::ErrorEndOfStream;
+    }
+    return DecodeResult::ErrorCodecFailure;
+}
+
+bool isBatchablePacket(const AjmPluginPacket& packet) {
+    return packet.inputData && packet.inputSize > 0 && packet.outputBuffer &&
+           packet.outputBufferSize > 0;
+}
+
+} // namespace
+
+FfmpegAudioPlugin::FfmpegAudioPlugin(const char* tag, const char* codecName)
+    : logTag(tag)
+    , codecId(CodecRegistry::getInstance().intern(codecName))
+    , decoder(nullptr)
+    , isInitialized(false) {
+
+    // Initialize format structures
+    inputFormat = {};
+    outputFormat = {};
+
+    LOG_DEBUG(logTag, "Plugin instance created");
+}
+
+FfmpegAudioPlugin::~FfmpegAudioPlugin() {
+    shutdown();
+    LOG_DEBUG(logTag, "Plugin instance destroyed");
+}
+
+bool FfmpegAudioPlugin::initialize(const AudioFormat& format) {
+    if (isInitialized) {
+        LOG_INFO(logTag, "Already initialized, shutting down first");
+        shutdown();
+    }
+
+    LOG_INFO(logTag, "Initializing with format - Sample Rate: %u, Channels: %u, Sample Format: %u, Target Rate: %u",
+        format.sampleRate, format.channels, static_cast<unsigned>(format.sampleFormat),
+        format.targetSampleRate);
+
+    // Validate input format
+    AVSampleFormat pcmFormat = toAVSampleFormat(format.sampleFormat);
+    if (format.sampleRate == 0 || format.channels == 0 || pcmFormat == AV_SAMPLE_FMT_NONE) {
+        LOG_ERROR(logTag, "Error: Invalid audio format parameters");
+        return false;
+    }
+
+    DecoderSetup setup{AV_CODEC_ID_NONE, 0, 0, nullptr, 0};
+    if (!prepareDecoder(format, setup)) {
+        return false;
+    }
+
+    ChannelMixPreset mixPreset;
+    ChannelMatrix channelMatrix;
+    if (!toChannelMixPreset(format.channelMix, mixPreset) || !channelMatrix.setPreset(mixPreset) ||
+        (channelMatrix.isActive() && channelMatrix.getInputChannels() != setup.channels)) {
+        LOG_ERROR(logTag, "Error: Channel mix %u does not apply to %d channels",
+            static_cast<unsigned>(format.channelMix), setup.channels);
+        return false;
+    }
+
+    // Store input format; codecConfig is only valid during this call
+    inputFormat = format;
+    inputFormat.sampleRate = static_cast<uint32_t>(setup.sampleRate);
+    inputFormat.channels = static_cast<uint16_t>(setup.channels);
+    inputFormat.codecConfig = nullptr;
+    inputFormat.codecConfigSize = 0;
+
+    // Take an initialized decoder from the pool
+    decoder = DecoderPool::getInstance().acquire(setup.codecId, setup.sampleRate, setup.channels,
+                                                 pcmFormat, setup.codecConfig,
+                                                 setup.codecConfigSize,
+                                                 static_cast<int>(format.targetSampleRate),
+                                                 toResamplePreset(format.resampleQuality),
+                                                 channelMatrix);
+    if (!decoder) {
+        LOG_ERROR(logTag, "Error: Failed to initialize decoder");
+        return false;
+    }
+
+    // Update output format based on decoder capabilities
+    updateOutputFormat();
+
+    isInitialized = true;
+    LOG_INFO(logTag, "Successfully initialized plugin");
+
+    return true;
+}
+
+void FfmpegAudioPlugin::shutdown() {
+    if (isInitialized) {
+        DecoderPool::getInstance().release(std::move(decoder));
+        isInitialized = false;
+        LOG_INFO(logTag, "Plugin shutdown completed");
+    }
+}
+
+DecodeResult FfmpegAudioPlugin::decode(const uint8_t* inputData, uint32_t inputSize,
+                                      void* outputBuffer, uint32_t outputBufferSize,
+                                      uint32_t* outputSize) {
+    if (!isInitialized || !decoder) {
+        LOG_ERROR_RATELIMITED(logTag, "Error: Plugin not initialized");
+        return DecodeResult::ErrorNotInitialized;
+    }
+    TraceSpan span("IAudioPlugin::decode", decoder->getTraceId(), decoder->getCodecName(),
+                   static_cast<int32_t>(inputSize));
+
+    // No input at all means "hand out PCM buffered from earlier packets"
+    const bool drainOnly = !inputData && inputSize == 0;
+    if (!drainOnly && (!inputData || inputSize == 0)) {
+        LOG_ERROR_RATELIMITED(logTag, "Error: Invalid input data");
+        decoder->getStats().recordError(DecodeErrorKind::InvalidInput);
+        return DecodeResult::ErrorInvalidInput;
+    }
+
+    if (!outputBuffer || outputBufferSize == 0 || !outputSize) {
+        LOG_ERROR_RATELIMITED(logTag, "Error: Invalid output parameters");
+        decoder->getStats().recordError(DecodeErrorKind::InvalidInput);
+        return DecodeResult::ErrorInvalidInput;
+    }
+
+    // Perform decoding using OrbisAudioDecoder
+    int actualOutputSize = 0;
+    int result = drainOnly
+                     ? decoder->readBuffered(static_cast<uint8_t*>(outputBuffer),
+                                             outputBufferSize, &actualOutputSize)
+                     : decoder->decodePacket(inputData, inputSize,
+                                             static_cast<uint8_t*>(outputBuffer),
+                                             outputBufferSize, &actualOutputSize);
+    span.setResult(result);
+
+    // Convert decoder result to plugin result
+    if (result == 0) {
+        *outputSize = actualOutputSize;
+        LOG_TRACE(logTag, "Successfully decoded %u bytes to %d bytes",
+            inputSize, actualOutputSize);
+        return DecodeResult::Success;
+    } else if (result == -2) {
+        LOG_ERROR_RATELIMITED(logTag, "Error: Output buffer too small");
+        return DecodeResult::ErrorInsufficientBuffer;
+    } else if (result == AVERROR_EOF) {
+        LOG_DEBUG(logTag, "End of stream reached");
+        return DecodeResult::ErrorEndOfStream;
+    } else {
+        LOG_ERROR_RATELIMITED(logTag, "Error: Codec failure with code %d", result);
+        return DecodeResult::ErrorCodecFailure;
+    }
+}
+
+AudioFormat FfmpegAudioPlugin::getOutputFormat() const {
+    return outputFormat;
+}
+
+bool FfmpegAudioPlugin::reset() {
+    if (!isInitialized || !decoder) {
+        LOG_ERROR(logTag, "Error: Plugin not initialized");
+        return false;
+    }
+
+    bool result = decoder->reset();
+    if (result) {
+        LOG_DEBUG(logTag, "Plugin reset successfully");
+    } else {
+        LOG_ERROR(logTag, "Error: Failed to reset plugin");
+    }
+
+    return result;
+}
+
+bool FfmpegAudioPlugin::supportsCodec(const std::string& codecType) const {
+    // Spellings and aliases are resolved centrally
+    return CodecRegistry::getInstance().resolve(codecType) == codecId;
+}
+
+bool FfmpegAudioPlugin::getStats(PluginStats& stats) const {
+    if (!isInitialized || !decoder) {
+        return false;
+    }
+
+    DecoderStatsSnapshot snapshot;
+    decoder->getStats().snapshot(snapshot);
+
+    stats = {};
+    stats.packets = snapshot.packets;
+    stats.frames = snapshot.frames;
+    stats.inputBytes = snapshot.inputBytes;
+    stats.outputBytes = snapshot.outputBytes;
+    stats.eagainCount = snapshot.eagainCount;
+    for (int i = 0; i < kDecodeErrorKinds && i < PLUGIN_STATS_ERROR_KINDS; ++i) {
+        stats.errors[i] = snapshot.errors[i];
+    }
+    stats.decodeTimeTotalNs = snapshot.decodeTimeTotalNs;
+    stats.decodeTimeMaxNs = snapshot.decodeTimeMaxNs;
+    for (int i = 0; i < kDecodeTimeBuckets && i < PLUGIN_STATS_HISTOGRAM_BUCKETS; ++i) {
+        stats.decodeTimeHistogram[i] = snapshot.decodeTimeHistogram[i];
+    }
+    return true;
+}
+
+void FfmpegAudioPlugin::decodeBatch(AjmPluginPacket* packets, uint32_t count) {
+    if (!isInitialized || !decoder) {
+        IAudioPlugin::decodeBatch(packets, count);
+        return;
+    }
+
+    PacketDecodeRequest requests[kBatchChunk];
+    uint32_t index = 0;
+    while (index < count) {
+        // Drains and malformed packets take the single-packet path and its checks
+        if (!isBatchablePacket(packets[index])) {
+            AjmPluginPacket& packet = packets[index++];
+            packet.outputSize = 0;
+            packet.result = static_cast<int32_t>(decode(packet.inputData, packet.inputSize,
+                                                        packet.outputBuffer, packet.outputBufferSize,
+                                                        &packet.outputSize));
+            continue;
+        }
+
+        uint32_t chunk = 0;
+        while (chunk < kBatchChunk && index + chunk < count &&
+               isBatchablePacket(packets[index + chunk])) {
+            const AjmPluginPacket& packet = packets[index + chunk];
+            requests[chunk] = PacketDecodeRequest{packet.inputData, static_cast<int>(packet.inputSize),
+                                                  static_cast<uint8_t*>(packet.outputBuffer),
+                                                  static_cast<int>(packet.outputBufferSize), 0, 0};
+            ++chunk;
+        }
+
+        decoder->decodePackets(requests, static_cast<int>(chunk));
+        for (uint32_t i = 0; i < chunk; ++i) {
+            AjmPluginPacket& packet = packets[index + i];
+            packet.outputSize = static_cast<uint32_t>(requests[i].outputSize);
+            packet.result = static_cast<int32_t>(toDecodeResult(requests[i].result));
+        }
+        index += chunk;
+    }
+}
+
+bool FfmpegAudioPlugin::seek(AjmPluginPacket* primingPackets, uint32_t primingCount,
+                             uint32_t trimSamples) {
+    if (!isInitialized || !decoder) {
+        LOG_ERROR(logTag, "Error: Plugin not initialized");
+        return false;
+    }
+    if (trimSamples > static_cast<uint32_t>(INT32_MAX) || (primingCount > 0 && !primingPackets)) {
+        return false;
+    }
+
+    // Priming needs every packet in one call, after the decoder's own reset
+    std::vector<PacketDecodeRequest> requests(primingCount);
+    for (uint32_t i = 0; i < primingCount; ++i) {
+        const AjmPluginPacket& packet = primingPackets[i];
+        requests[i] = PacketDecodeRequest{packet.inputData, static_cast<int>(packet.inputSize),
+                                          nullptr, 0, 0, 0};
+    }
+
+    const int primed = decoder->seek(requests.data(), static_cast<int>(primingCount),
+                                     static_cast<int>(trimSamples));
+    for (uint32_t i = 0; i < primingCount; ++i) {
+        primingPackets[i].outputSize = 0;
+        primingPackets[i].result = static_cast<int32_t>(toDecodeResult(requests[i].result));
+    }
+    if (primed < 0) {
+        return false;
+    }
+
+    LOG_DEBUG(logTag, "Seek primed with %d of %u packets, trimming %u samples",
+        primed, primingCount, trimSamples);
+    return true;
+}
+
+PluginCapabilities FfmpegAudioPlugin::getCapabilities() const {
+    // Input is staged into the decoder's padded buffer, and swresample writes every format
+    PluginCapabilities capabilities;
+    capabilities.flags = AJM_PLUGIN_CAP_BATCH_DECODE | AJM_PLUGIN_CAP_OUTPUT_FORMATS |
+                         AJM_PLUGIN_CAP_ZERO_COPY_INPUT;
+    capabilities.outputFormats = 0;
+    for (uint32_t format = static_cast<uint32_t>(SampleFormat::S16);
+         format <= static_cast<uint32_t>(SampleFormat::F32Planar); ++format) {
+        capabilities.outputFormats |= AJM_PLUGIN_FORMAT_BIT(format);
+    }
+    return capabilities;
+}
+
+void FfmpegAudioPlugin::updateOutputFormat() {
+    // Output matches the requested PCM format at the target rate (or the codec's native rate)
+    outputFormat = {};
+    outputFormat.sampleRate = static_cast<uint32_t>(decoder->getOutputSampleRate());
+    outputFormat.channels = static_cast<uint16_t>(decoder->getOutputChannels());
+    outputFormat.sampleFormat = inputFormat.sampleFormat;
+    outputFormat.bitsPerSample = static_cast<uint16_t>(
+        av_get_bytes_per_sample(decoder->getOutputSampleFormat()) * 8);
+    outputFormat.frameSize = (outputFormat.bitsPerSample / 8) * outputFormat.channels;
+
+    LOG_INFO(logTag, "Output format - Sample Rate: %u, Channels: %u, Bits per Sample: %u, Frame Size: %u, Format: %s",
+        outputFormat.sampleRate, outputFormat.channels, outputFormat.bitsPerSample, outputFormat.frameSize,
+        av_get_sample_fmt_name(decoder->getOutputSampleFormat()));
+}
+
+} // namespace ShadPS4::Audio
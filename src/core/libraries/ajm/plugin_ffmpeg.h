@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file plugin_ffmpeg.h
+ * @brief Shared base for FFmpeg-backed audio plugins in ShadPS4
+ *
+ * The built-in M4AAC, Opus and AT9 plugins differ only in how they turn an
+ * AudioFormat into a decoder configuration. FfmpegAudioPlugin implements the
+ * rest of IAudioPlugin once on top of a pooled OrbisAudioDecoder, so every
+ * codec gets the same decode path (pooled input staging, PCM FIFO, SIMD
+ * conversion) and the same counters.
+ */
+
+#include "plugin_interface.h"
+#include "ajm_codec_registry.h"
+#include "../audio/OrbisAudioDecoder.h"
+
+#include <memory>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief IAudioPlugin implementation around one pooled OrbisAudioDecoder
+ */
+class FfmpegAudioPlugin : public IAudioPlugin {
+public:
+    ~FfmpegAudioPlugin() override;
+
+    // IAudioPlugin interface implementation
+    bool initialize(const AudioFormat& format) override;
+    void shutdown() override;
+    DecodeResult decode(const uint8_t* inputData, uint32_t inputSize,
+                       void* outputBuffer, uint32_t outputBufferSize,
+                       uint32_t* outputSize) override;
+    AudioFormat getOutputFormat() const override;
+    bool reset() override;
+    bool supportsCodec(const std::string& codecType) const override;
+    bool getStats(PluginStats& stats) const override;
+    PluginCapabilities getCapabilities() const override;
+    void decodeBatch(AjmPluginPacket* packets, uint32_t count) override;
+    bool seek(AjmPluginPacket* primingPackets, uint32_t primingCount, uint32_t trimSamples) override;
+
+protected:
+    /**
+     * @brief Decoder configuration derived from the caller's AudioFormat
+     */
+    struct DecoderSetup {
+        AVCodecID codecId;          // FFmpeg codec ID
+        int sampleRate;             // Sample rate passed to the decoder
+        int channels;               // Channel count passed to the decoder
+        const uint8_t* codecConfig; // Extradata (must outlive initialize())
+        int codecConfigSize;        // Size of codecConfig in bytes
+    };
+
+    /**
+     * @param tag Log tag of the concrete plugin (must be a string literal)
+     * @param codecName Codec this plugin decodes; every alias of it in
+     *        CodecRegistry is accepted by supportsCodec()
+     */
+    FfmpegAudioPlugin(const char* tag, const char* codecName);
+
+    /**
+     * @brief Validate the caller's format and describe the decoder to open
+     * @param format Format passed to initialize(); channels and sampleRate are non-zero
+     * @param setup Receives the decoder configuration
+     * @return true if the format is valid for this codec, false otherwise
+     */
+    virtual bool prepareDecoder(const AudioFormat& format, DecoderSetup& setup) = 0;
+
+    const char* logTag;
+    CodecId codecId;
+
+private:
+    std::unique_ptr<OrbisAudioDecoder> decoder;
+    AudioFormat inputFormat;
+    AudioFormat outputFormat;
+    bool isInitialized;
+
+    void updateOutputFormat();
+};
+
+} // namespace ShadPS4::Audio
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "plugin_abi.h"
+
 #include <cstdint>
 #include <string>
 
@@ -24,6 +26,41 @@ struct PluginInfo {
     uint32_t apiVersion;        // API version for compatibility checking
 };
 
+/**
+ * @brief PCM sample formats a plugin can produce
+ * 
+ * Interleaved formats store one frame (all channels) after another. Planar
+ * formats split the output buffer into one equally sized region per channel.
+ */
+enum class SampleFormat : uint16_t {
+    S16 = 0,                    // Signed 16-bit, interleaved (default)
+    S32 = 1,                    // Signed 32-bit, interleaved
+    F32 = 2,                    // 32-bit float, interleaved
+    S16Planar = 3,              // Signed 16-bit, one plane per channel
+    S32Planar = 4,              // Signed 32-bit, one plane per channel
+    F32Planar = 5               // 32-bit float, one plane per channel
+};
+
+/**
+ * @brief Resampling quality when a target sample rate is requested
+ */
+enum class ResampleQuality : uint16_t {
+    Balanced = 0,               // Default
+    Fast = 1,                   // Shortest filter, lowest CPU cost
+    High = 2                    // Longest filter, flattest passband
+};
+
+/**
+ * @brief Output channel layout applied by the decoder
+ */
+enum class ChannelMix : uint16_t {
+    None = 0,                   // Codec channel order
+    Ps4Order71 = 1,             // 7.1 as L R C LFE Ls Rs Lb Rb
+    Downmix51To20 = 2,          // 5.1 to stereo
+    Downmix71To20 = 3,          // 7.1 to stereo
+    Downmix71To51 = 4           // 7.1 to 5.1
+};
+
 /**
  * @brief Audio format information
  */
@@ -32,6 +69,12 @@ struct AudioFormat {
     uint16_t channels;          // Number of channels (1=mono, 2=stereo, etc.)
     uint16_t bitsPerSample;     // Bits per sample (typically 16 or 24)
     uint32_t frameSize;         // Size of one audio frame in bytes
+    SampleFormat sampleFormat;  // Requested PCM output format (S16 if zero-initialized)
+    const uint8_t* codecConfig; // Codec setup data, e.g. AT9 config word, OpusHead or AAC AudioSpecificConfig/ADTS header (API 1.3.0+)
+    uint32_t codecConfigSize;   // Size of codecConfig in bytes (0 if none)
+    uint32_t targetSampleRate;  // Output rate to resample to, 0 for the stream's rate (API 1.4.0+)
+    ResampleQuality resampleQuality; // Filter quality used with targetSampleRate
+    ChannelMix channelMix;      // Output remap/downmix; channels stays the stream's count (API 1.5.0+)
 };
 
 /**
@@ -46,6 +89,32 @@ enum class DecodeResult : int32_t {
     ErrorEndOfStream = -5       // End of audio stream reached
 };
 
+constexpr int PLUGIN_STATS_ERROR_KINDS = 8;          // Indexed by -DecodeResult; index 0 unused
+constexpr int PLUGIN_STATS_HISTOGRAM_BUCKETS = 32;   // Bucket i: decodes taking [2^i, 2^(i+1)) ns
+
+/**
+ * @brief Per-instance performance counters
+ */
+struct PluginStats {
+    uint64_t packets;           // Packets handed to the codec
+    uint64_t frames;            // Frames produced by the codec
+    uint64_t inputBytes;        // Compressed bytes consumed
+    uint64_t outputBytes;       // PCM bytes written
+    uint64_t eagainCount;       // Packets that produced no frame (codec wanted more input)
+    uint64_t errors[PLUGIN_STATS_ERROR_KINDS]; // Failed decode calls by -DecodeResult
+    uint64_t decodeTimeTotalNs; // Sum of per-packet decode times
+    uint64_t decodeTimeMaxNs;   // Slowest single packet
+    uint64_t decodeTimeHistogram[PLUGIN_STATS_HISTOGRAM_BUCKETS]; // Log2 buckets of decode time
+};
+
+/**
+ * @brief What a plugin instance can do beyond the basic decode contract
+ */
+struct PluginCapabilities {
+    uint32_t flags;             // AJM_PLUGIN_CAP_* from plugin_abi.h
+    uint32_t outputFormats;     // AJM_PLUGIN_FORMAT_BIT mask of accepted SampleFormats
+};
+
 /**
  * @brief Abstract base class for audio plugins
  * 
@@ -64,7 +133,9 @@ public:
 
     /**
      * @brief Initialize the plugin with specific audio format
-     * @param format Input audio format parameters
+     * @param format Input audio format parameters; sampleFormat selects the
+     *        PCM format decode() writes, codecConfig carries codec setup data
+     *        and only needs to stay valid for the duration of the call
      * @return true if initialization successful, false otherwise
      */
     virtual bool initialize(const AudioFormat& format) = 0;
@@ -76,6 +147,11 @@ public:
 
     /**
      * @brief Decode an audio packet
+     * 
+     * Decoded samples that do not fit into the output buffer are kept by the
+     * plugin and returned first by the next call. Passing no input
+     * (inputData == nullptr, inputSize == 0) only returns such buffered samples.
+     * 
      * @param inputData Pointer to compressed audio data
      * @param inputSize Size of input data in bytes
      * @param outputBuffer Pointer to output PCM buffer
@@ -109,6 +185,75 @@ public:
      * @return true if plugin supports this codec, false otherwise
      */
     virtual bool supportsCodec(const std::string& codecType) const = 0;
+
+    /**
+     * @brief Get performance counters (API version 1.2.0 and later)
+     * 
+     * Must be safe to call while another thread is decoding. The host only
+     * calls this on plugins that report apiVersion >= PLUGIN_API_VERSION_STATS.
+     * 
+     * @param stats Structure to fill
+     * @return true if the plugin keeps counters, false otherwise
+     */
+    virtual bool getStats(PluginStats& stats) const {
+        (void)stats;
+        return false;
+    }
+
+    /**
+     * @brief Get capability flags and accepted output formats
+     * 
+     * Host-side extension, like decodeBatch(): the host only calls these on
+     * objects it built itself (built-in plugins and the adapters the loader
+     * puts around every dynamic library), never on a v1 library's own
+     * IAudioPlugin.
+     * 
+     * @return Capabilities; S16 output only unless overridden
+     */
+    virtual PluginCapabilities getCapabilities() const {
+        return PluginCapabilities{0, AJM_PLUGIN_FORMAT_BIT(static_cast<uint32_t>(SampleFormat::S16))};
+    }
+
+    /**
+     * @brief Decode several packets of this stream in order
+     * @param packets Packets to decode; outputSize and result are filled in
+     * @param count Number of packets
+     */
+    virtual void decodeBatch(AjmPluginPacket* packets, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            AjmPluginPacket& packet = packets[i];
+            packet.outputSize = 0;
+            packet.result = static_cast<int32_t>(decode(packet.inputData, packet.inputSize,
+                                                        packet.outputBuffer, packet.outputBufferSize,
+                                                        &packet.outputSize));
+        }
+    }
+
+    /**
+     * @brief Restart at a new stream position without reinitializing
+     *
+     * Host-side extension, like decodeBatch(). Resets the decoder, decodes
+     * the priming packets (the packets just before the target) and drops
+     * their output, then drops the first trimSamples samples per channel,
+     * counted at the codec's rate, that later decode() calls produce. The
+     * output buffers of the priming packets are scratch space the plugin may
+     * use; their outputSize and result are filled in as for decodeBatch().
+     *
+     * The default implementation cannot trim; it refuses a non-zero
+     * trimSamples without touching the decoder.
+     *
+     * @param primingPackets Packets preceding the target, in stream order
+     * @param primingCount Number of priming packets (may be 0)
+     * @param trimSamples Samples per channel to drop after the priming packets
+     * @return true if the decoder is positioned, false otherwise
+     */
+    virtual bool seek(AjmPluginPacket* primingPackets, uint32_t primingCount, uint32_t trimSamples) {
+        if (trimSamples != 0 || !reset()) {
+            return false;
+        }
+        decodeBatch(primingPackets, primingCount);
+        return true;
+    }
 };
 
 /**
@@ -127,7 +272,32 @@ typedef IAudioPlugin* (*CreatePluginInstanceFunc)();
  */
 typedef void (*DestroyPluginInstanceFunc)(IAudioPlugin* plugin);
 
-// API version constant for compatibility checking
-constexpr uint32_t PLUGIN_API_VERSION = 0x00010000; // Version 1.0.0
+/**
+ * @brief Optional plugin information export
+ * 
+ * Plugins may export "getPluginInfo" and "supportsCodec" so the loader can
+ * describe a library without creating an instance.
+ */
+typedef PluginInfo (*GetPluginInfoFunc)();
+typedef bool (*SupportsCodecFunc)(const char* codecType);
+
+// API version constant for compatibility checking (v1 C++ interface; the
+// v2 C ABI is versioned by AJM_PLUGIN_API_VERSION in plugin_abi.h)
+constexpr uint32_t PLUGIN_API_VERSION = 0x00010500; // Version 1.5.0
+
+// First API version whose AudioFormat carries sampleFormat
+constexpr uint32_t PLUGIN_API_VERSION_SAMPLE_FORMAT = 0x00010100;
+
+// First API version whose IAudioPlugin vtable includes getStats()
+constexpr uint32_t PLUGIN_API_VERSION_STATS = 0x00010200;
+
+// First API version whose AudioFormat carries codecConfig
+constexpr uint32_t PLUGIN_API_VERSION_CODEC_CONFIG = 0x00010300;
+
+// First API version whose AudioFormat carries targetSampleRate
+constexpr uint32_t PLUGIN_API_VERSION_RESAMPLE = 0x00010400;
+
+// First API version whose AudioFormat carries channelMix
+constexpr uint32_t PLUGIN_API_VERSION_CHANNEL_MIX = 0x00010500;
 
 } // namespace ShadPS4::Audio
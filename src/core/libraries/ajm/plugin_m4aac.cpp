@@ -3,14 +3,13 @@
  * @brief M4AAC Audio Plugin Implementation for ShadPS4
  * 
  * This file implements the M4AAC audio decoding plugin using the
- * plugin interface defined in plugin_interface.h. It leverages the
- * OrbisAudioDecoder for actual FFmpeg-based decoding.
+ * plugin interface defined in plugin_interface.h. Decoding is shared
+ * with the other built-in codecs through FfmpegAudioPlugin.
  */
 
-#include "plugin_interface.h"
-#include "../audio/OrbisAudioDecoder.h"
-#include <iostream>
-#include <memory>
+#include "plugin_ffmpeg.h"
+#include "CodecConfig.h"
+#include "common/logging/log.h"
 
 extern "C" {
     #include <libavcodec/avcodec.h>
@@ -22,49 +21,23 @@ namespace ShadPS4::Audio {
  * @brief M4AAC Audio Plugin Implementation
  * 
  * This class implements the IAudioPlugin interface specifically for M4AAC codec.
- * It uses the OrbisAudioDecoder internally for FFmpeg-based decoding.
+ * It uses the OrbisAudioDecoder internally for FFmpeg-based decoding. Each
+ * instance owns its decoder exclusively; decoders are taken from and returned
+ * to the shared DecoderPool.
  */
-class M4aacAudioPlugin : public IAudioPlugin {
+class M4aacAudioPlugin : public FfmpegAudioPlugin {
 public:
-    M4aacAudioPlugin();
-    ~M4aacAudioPlugin() override;
+    M4aacAudioPlugin() : FfmpegAudioPlugin("M4aacPlugin", "M4AAC") {}
 
-    // IAudioPlugin interface implementation
     PluginInfo getPluginInfo() const override;
-    bool initialize(const AudioFormat& format) override;
-    void shutdown() override;
-    DecodeResult decode(const uint8_t* inputData, uint32_t inputSize,
-                       void* outputBuffer, uint32_t outputBufferSize,
-                       uint32_t* outputSize) override;
-    AudioFormat getOutputFormat() const override;
-    bool reset() override;
-    bool supportsCodec(const std::string& codecType) const override;
 
-private:
-    std::unique_ptr<OrbisAudioDecoder> decoder;
-    AudioFormat inputFormat;
-    AudioFormat outputFormat;
-    bool isInitialized;
+protected:
+    bool prepareDecoder(const AudioFormat& format, DecoderSetup& setup) override;
 
-    void updateOutputFormat();
+private:
+    AacCodecInfo config{};  // Parsed configuration; owns an ADTS header's AudioSpecificConfig during initialize()
 };
 
-M4aacAudioPlugin::M4aacAudioPlugin() 
-    : decoder(nullptr)
-    , isInitialized(false) {
-    
-    // Initialize format structures
-    inputFormat = {};
-    outputFormat = {};
-    
-    std::cout << "[M4aacPlugin] Plugin instance created" << std::endl;
-}
-
-M4aacAudioPlugin::~M4aacAudioPlugin() {
-    shutdown();
-    std::cout << "[M4aacPlugin] Plugin instance destroyed" << std::endl;
-}
-
 PluginInfo M4aacAudioPlugin::getPluginInfo() const {
     PluginInfo info;
     info.name = "M4AAC Decoder";
@@ -75,134 +48,48 @@ PluginInfo M4aacAudioPlugin::getPluginInfo() const {
     return info;
 }
 
-bool M4aacAudioPlugin::initialize(const AudioFormat& format) {
-    if (isInitialized) {
-        std::cout << "[M4aacPlugin] Already initialized, shutting down first" << std::endl;
-        shutdown();
-    }
-
-    std::cout << "[M4aacPlugin] Initializing with format - Sample Rate: " << format.sampleRate
-              << ", Channels: " << format.channels << ", Bits per Sample: " << format.bitsPerSample << std::endl;
-
-    // Validate input format
-    if (format.sampleRate == 0 || format.channels == 0) {
-        std::cerr << "[M4aacPlugin] Error: Invalid audio format parameters" << std::endl;
-        return false;
+bool M4aacAudioPlugin::prepareDecoder(const AudioFormat& format, DecoderSetup& setup) {
+    // Raw or ADTS-framed AAC frames; an AudioSpecificConfig or ADTS header may be passed as codecConfig
+    const uint8_t* codecConfig = format.codecConfig;
+    int codecConfigSize = codecConfig ? static_cast<int>(format.codecConfigSize) : 0;
+    if (codecConfigSize > 0) {
+        if (!parseAacConfig(format.codecConfig, format.codecConfigSize, config)) {
+            return false;
+        }
+        if (config.channels != 0 && config.channels != format.channels) {
+            LOG_ERROR(logTag, "Error: AAC config declares %d channels, format has %u",
+                config.channels, format.channels);
+            return false;
+        }
+        // Pool and cache by the AudioSpecificConfig, not the first frame's ADTS header with its frame length
+        if (config.adts) {
+            codecConfig = config.builtConfig;
+            codecConfigSize = config.builtConfigSize;
+        }
     }
 
-    // Store input format
-    inputFormat = format;
-
-    // Create decoder instance
-    decoder = std::make_unique<OrbisAudioDecoder>();
-    if (!decoder) {
-        std::cerr << "[M4aacPlugin] Error: Failed to create decoder instance" << std::endl;
-        return false;
-    }
-
-    // Initialize decoder with M4AAC codec
-    if (!decoder->initialize(AV_CODEC_ID_AAC, format.sampleRate, format.channels)) {
-        std::cerr << "[M4aacPlugin] Error: Failed to initialize decoder" << std::endl;
-        decoder.reset();
-        return false;
-    }
-
-    // Update output format based on decoder capabilities
-    updateOutputFormat();
-
-    isInitialized = true;
-    std::cout << "[M4aacPlugin] Successfully initialized M4AAC plugin" << std::endl;
-    
+    setup.codecId = AV_CODEC_ID_AAC;
+    setup.sampleRate = static_cast<int>(format.sampleRate);
+    setup.channels = format.channels;
+    setup.codecConfig = codecConfig;
+    setup.codecConfigSize = codecConfigSize;
     return true;
 }
 
-void M4aacAudioPlugin::shutdown() {
-    if (isInitialized) {
-        decoder.reset();
-        isInitialized = false;
-        std::cout << "[M4aacPlugin] Plugin shutdown completed" << std::endl;
-    }
-}
-
-DecodeResult M4aacAudioPlugin::decode(const uint8_t* inputData, uint32_t inputSize,
-                                     void* outputBuffer, uint32_t outputBufferSize,
-                                     uint32_t* outputSize) {
-    if (!isInitialized || !decoder) {
-        std::cerr << "[M4aacPlugin] Error: Plugin not initialized" << std::endl;
-        return DecodeResult::ErrorNotInitialized;
-    }
-
-    if (!inputData || inputSize == 0) {
-        std::cerr << "[M4aacPlugin] Error: Invalid input data" << std::endl;
-        return DecodeResult::ErrorInvalidInput;
-    }
-
-    if (!outputBuffer || outputBufferSize == 0 || !outputSize) {
-        std::cerr << "[M4aacPlugin] Error: Invalid output parameters" << std::endl;
-        return DecodeResult::ErrorInvalidInput;
-    }
-
-    // Perform decoding using OrbisAudioDecoder
-    int actualOutputSize = 0;
-    int result = decoder->decodePacket(inputData, inputSize,
-                                      static_cast<uint8_t*>(outputBuffer),
-                                      outputBufferSize, &actualOutputSize);
-
-    // Convert decoder result to plugin result
-    if (result == 0) {
-        *outputSize = actualOutputSize;
-        std::cout << "[M4aacPlugin] Successfully decoded " << inputSize 
-                  << " bytes to " << actualOutputSize << " bytes" << std::endl;
-        return DecodeResult::Success;
-    } else if (result == -2) {
-        std::cerr << "[M4aacPlugin] Error: Output buffer too small" << std::endl;
-        return DecodeResult::ErrorInsufficientBuffer;
-    } else if (result == AVERROR_EOF) {
-        std::cout << "[M4aacPlugin] End of stream reached" << std::endl;
-        return DecodeResult::ErrorEndOfStream;
-    } else {
-        std::cerr << "[M4aacPlugin] Error: Codec failure with code " << result << std::endl;
-        return DecodeResult::ErrorCodecFailure;
-    }
-}
-
-AudioFormat M4aacAudioPlugin::getOutputFormat() const {
-    return outputFormat;
-}
-
-bool M4aacAudioPlugin::reset() {
-    if (!isInitialized || !decoder) {
-        std::cerr << "[M4aacPlugin] Error: Plugin not initialized" << std::endl;
-        return false;
-    }
-
-    bool result = decoder->reset();
-    if (result) {
-        std::cout << "[M4aacPlugin] Plugin reset successfully" << std::endl;
-    } else {
-        std::cerr << "[M4aacPlugin] Error: Failed to reset plugin" << std::endl;
-    }
-
-    return result;
-}
-
-bool M4aacAudioPlugin::supportsCodec(const std::string& codecType) const {
-    // This plugin supports M4AAC codec
-    return (codecType == "M4AAC" || codecType == "AAC" || codecType == "m4aac");
+/**
+ * @brief Create a built-in M4AAC plugin instance
+ * @return Pointer to the created plugin instance
+ */
+IAudioPlugin* createM4aacPlugin() {
+    return new M4aacAudioPlugin();
 }
 
-void M4aacAudioPlugin::updateOutputFormat() {
-    // Set output format based on decoder capabilities
-    // For M4AAC, we typically output 16-bit PCM
-    outputFormat.sampleRate = inputFormat.sampleRate;
-    outputFormat.channels = inputFormat.channels;
-    outputFormat.bitsPerSample = 16; // 16-bit PCM output
-    outputFormat.frameSize = (outputFormat.bitsPerSample / 8) * outputFormat.channels;
-
-    std::cout << "[M4aacPlugin] Output format - Sample Rate: " << outputFormat.sampleRate
-              << ", Channels: " << outputFormat.channels 
-              << ", Bits per Sample: " << outputFormat.bitsPerSample
-              << ", Frame Size: " << outputFormat.frameSize << std::endl;
+/**
+ * @brief Destroy a built-in M4AAC plugin instance
+ * @param plugin Pointer to the plugin instance to destroy
+ */
+void destroyM4aacPlugin(IAudioPlugin* plugin) {
+    delete plugin;
 }
 
 } // namespace ShadPS4::Audio
@@ -215,7 +102,7 @@ extern "C" {
  * @return Pointer to the created plugin instance
  */
 ShadPS4::Audio::IAudioPlugin* createPluginInstance() {
-    std::cout << "[M4aacPlugin] Creating new plugin instance" << std::endl;
+    LOG_DEBUG("M4aacPlugin", "Creating new plugin instance");
     return new ShadPS4::Audio::M4aacAudioPlugin();
 }
 
@@ -225,7 +112,7 @@ ShadPS4::Audio::IAudioPlugin* createPluginInstance() {
  */
 void destroyPluginInstance(ShadPS4::Audio::IAudioPlugin* plugin) {
     if (plugin) {
-        std::cout << "[M4aacPlugin] Destroying plugin instance" << std::endl;
+        LOG_DEBUG("M4aacPlugin", "Destroying plugin instance");
         delete plugin;
     }
 }
@@ -252,8 +139,8 @@ ShadPS4::Audio::PluginInfo getPluginInfo() {
 bool supportsCodec(const char* codecType) {
     if (!codecType) return false;
     
-    std::string codec(codecType);
-    return (codec == "M4AAC" || codec == "AAC" || codec == "m4aac");
+    auto& registry = ShadPS4::Audio::CodecRegistry::getInstance();
+    return registry.resolve(codecType) == registry.resolve("M4AAC");
 }
 
 } // extern "C"
@@ -0,0 +1,94 @@
+/**
+ * @file plugin_opus.cpp
+ * @brief Opus Audio Plugin Implementation for ShadPS4
+ *
+ * This file implements the built-in Opus decoding plugin. Opus decodes
+ * natively at 48 kHz, so PCM leaves the codec without resampling whatever
+ * rate the stream was configured for, and each 2.5-20 ms frame is returned
+ * by the decode call that carried it.
+ */
+
+#include "plugin_ffmpeg.h"
+#include "../audio/CodecConfig.h"
+#include "common/logging/log.h"
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Opus Audio Plugin Implementation
+ *
+ * Mono and stereo streams need no setup data. Streams with more channels
+ * must pass their OpusHead header as AudioFormat::codecConfig.
+ */
+class OpusAudioPlugin : public FfmpegAudioPlugin {
+public:
+    OpusAudioPlugin() : FfmpegAudioPlugin("OpusPlugin", "OPUS") {}
+
+    PluginInfo getPluginInfo() const override;
+
+protected:
+    bool prepareDecoder(const AudioFormat& format, DecoderSetup& setup) override;
+};
+
+PluginInfo OpusAudioPlugin::getPluginInfo() const {
+    PluginInfo info;
+    info.name = "Opus Decoder";
+    info.version = "1.0.0";
+    info.codecType = "OPUS";
+    info.apiVersion = PLUGIN_API_VERSION;
+
+    return info;
+}
+
+bool OpusAudioPlugin::prepareDecoder(const AudioFormat& format, DecoderSetup& setup) {
+    if (!isOpusSampleRate(static_cast<int>(format.sampleRate))) {
+        LOG_ERROR(logTag, "Error: Unsupported Opus sample rate %u", format.sampleRate);
+        return false;
+    }
+
+    const bool hasHeader = format.codecConfig && format.codecConfigSize > 0;
+    if (hasHeader) {
+        int headChannels = 0;
+        if (!parseOpusHead(format.codecConfig, format.codecConfigSize, headChannels)) {
+            return false;
+        }
+        if (headChannels != format.channels) {
+            LOG_ERROR(logTag, "Error: OpusHead declares %d channels, format has %u",
+                headChannels, format.channels);
+            return false;
+        }
+    } else if (format.channels > 2) {
+        LOG_ERROR(logTag, "Error: %u-channel Opus needs an OpusHead codecConfig", format.channels);
+        return false;
+    }
+
+    // Always open at the native rate so every configured rate shares pooled decoders
+    setup.codecId = AV_CODEC_ID_OPUS;
+    setup.sampleRate = kOpusDecodeSampleRate;
+    setup.channels = format.channels;
+    setup.codecConfig = hasHeader ? format.codecConfig : nullptr;
+    setup.codecConfigSize = hasHeader ? static_cast<int>(format.codecConfigSize) : 0;
+    return true;
+}
+
+/**
+ * @brief Create a built-in Opus plugin instance
+ * @return Pointer to the created plugin instance
+ */
+IAudioPlugin* createOpusPlugin() {
+    return new OpusAudioPlugin();
+}
+
+/**
+ * @brief Destroy a built-in Opus plugin instance
+ * @param plugin Pointer to the plugin instance to destroy
+ */
+void destroyOpusPlugin(IAudioPlugin* plugin) {
+    delete plugin;
+}
+
+} // namespace ShadPS4::Audio
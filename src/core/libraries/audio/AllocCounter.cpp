@@ -0,0 +1,82 @@
+/**
+ * @file AllocCounter.cpp
+ * @brief Per-thread heap allocation counter for ShadPS4 audio decoding
+ *
+ * This file implements the counter and, with SHADPS4_AUDIO_ALLOC_DEBUG, the
+ * counting replacement of the global operator new.
+ */
+
+#include "AllocCounter.h"
+
+#ifdef SHADPS4_AUDIO_ALLOC_DEBUG
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace ShadPS4::Audio::AllocCounter {
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+} // namespace
+
+void record() {
+    ++t_allocations;
+}
+
+uint64_t getThreadCount() {
+    return t_allocations;
+}
+
+bool isCountingHeap() {
+#ifdef SHADPS4_AUDIO_ALLOC_DEBUG
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace ShadPS4::Audio::AllocCounter
+
+#ifdef SHADPS4_AUDIO_ALLOC_DEBUG
+
+// Over-aligned new/delete keep the standard library versions, which pair with each other
+void* operator new(std::size_t size) {
+    ShadPS4::Audio::AllocCounter::record();
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ShadPS4::Audio::AllocCounter::record();
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+#endif // SHADPS4_AUDIO_ALLOC_DEBUG
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @file AllocCounter.h
+ * @brief Per-thread heap allocation counter for ShadPS4 audio decoding
+ *
+ * Steady-state decoding is meant to run without touching the heap, so audio
+ * threads never contend with the guest's threads for the allocator. Every
+ * pool in the decoder (input blocks, frame buffers) counts the blocks it
+ * allocates here. Builds with SHADPS4_AUDIO_ALLOC_DEBUG also replace the
+ * global operator new and count every C++ allocation.
+ *
+ * Counts are per thread, so a benchmark can read the counter around a
+ * decode loop and expect zero once the pools are warm.
+ */
+
+#include <cstdint>
+
+namespace ShadPS4::Audio::AllocCounter {
+
+/**
+ * @brief Count one allocation on the calling thread
+ */
+void record();
+
+/**
+ * @brief Get the allocations counted on the calling thread so far
+ */
+uint64_t getThreadCount();
+
+/**
+ * @brief Check whether C++ heap allocations are counted (SHADPS4_AUDIO_ALLOC_DEBUG builds)
+ */
+bool isCountingHeap();
+
+} // namespace ShadPS4::Audio::AllocCounter
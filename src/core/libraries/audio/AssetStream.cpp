@@ -0,0 +1,403 @@
+/**
+ * @file AssetStream.cpp
+ * @brief Memory-mapped audio asset streaming for ShadPS4
+ *
+ * This file implements file mapping, packet indexing (container sample
+ * tables and ADTS frame walking) and chunked decoding with read-ahead.
+ */
+
+extern "C" {
+    #include <libavformat/avformat.h>
+    #include <libavutil/avutil.h>
+}
+
+#include "AssetStream.h"
+#include "CodecConfig.h"
+#include "DecoderPool.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Bytes requested from the OS ahead of the read position at a time
+constexpr uint64_t kReadAheadBytes = 1 << 20;
+
+// AVIO buffer the demuxer parses the container header through
+constexpr int kHeaderIoBufferSize = 32768;
+
+// ID3v2 tag some ADTS files start with: "ID3", version, flags, 28-bit syncsafe size
+constexpr size_t kId3HeaderSize = 10;
+
+/**
+ * @brief Read position of the demuxer's AVIO context in the mapping
+ */
+struct MappedReader {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+};
+
+int readMapped(void* opaque, uint8_t* buffer, int bufferSize) {
+    MappedReader* reader = static_cast<MappedReader*>(opaque);
+    const size_t count = std::min(static_cast<size_t>(bufferSize), reader->size - reader->position);
+    if (count == 0) {
+        return AVERROR_EOF;
+    }
+    std::memcpy(buffer, reader->data + reader->position, count);
+    reader->position += count;
+    return static_cast<int>(count);
+}
+
+int64_t seekMapped(void* opaque, int64_t offset, int whence) {
+    MappedReader* reader = static_cast<MappedReader*>(opaque);
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+    case AVSEEK_SIZE: return static_cast<int64_t>(reader->size);
+    case SEEK_SET: target = offset; break;
+    case SEEK_CUR: target = static_cast<int64_t>(reader->position) + offset; break;
+    case SEEK_END: target = static_cast<int64_t>(reader->size) + offset; break;
+    default: return AVERROR(EINVAL);
+    }
+    if (target < 0 || target > static_cast<int64_t>(reader->size)) {
+        return AVERROR(EINVAL);
+    }
+    reader->position = static_cast<size_t>(target);
+    return target;
+}
+
+size_t getId3TagSize(const uint8_t* data, size_t size) {
+    if (size < kId3HeaderSize || std::memcmp(data, "ID3", 3) != 0) {
+        return 0;
+    }
+    const size_t tagSize = (static_cast<size_t>(data[6] & 0x7F) << 21) | ((data[7] & 0x7F) << 14) |
+                           ((data[8] & 0x7F) << 7) | (data[9] & 0x7F);
+    return kId3HeaderSize + tagSize;
+}
+
+} // namespace
+
+AssetStream::AssetStream()
+    : mappedData(nullptr)
+    , mappedSize(0)
+    , codecId(AV_CODEC_ID_NONE)
+    , sampleRate(0)
+    , channels(0)
+    , nextPacket(0)
+    , adviseOffset(0) {
+}
+
+AssetStream::~AssetStream() {
+    close();
+}
+
+bool AssetStream::open(const std::string& path, AVSampleFormat outputFormat, int targetSampleRate,
+                       ResamplePreset resamplePreset) {
+    close();
+
+    if (path.empty() || av_sample_fmt_is_planar(outputFormat)) {
+        LOG_ERROR("AssetStream", "Error: Asset streams need a file path and an interleaved output format");
+        return false;
+    }
+
+    filePath = path;
+    if (!mapFile()) {
+        LOG_ERROR("AssetStream", "Error: Could not map %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+    const size_t id3Size = getId3TagSize(mappedData, mappedSize);
+    const bool adts = id3Size < mappedSize && isAdtsHeader(mappedData + id3Size, mappedSize - id3Size);
+    if (!(adts ? indexAdts() : indexContainer()) || packets.empty()) {
+        LOG_ERROR("AssetStream", "Error: No decodable audio packets in %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+    decoder = DecoderPool::getInstance().acquire(codecId, sampleRate, channels, outputFormat,
+                                                 codecConfig.data(), static_cast<int>(codecConfig.size()),
+                                                 targetSampleRate, resamplePreset);
+    if (!decoder) {
+        LOG_ERROR("AssetStream", "Error: Could not create a decoder for %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+#ifndef _WIN32
+    madvise(const_cast<uint8_t*>(mappedData), mappedSize, MADV_SEQUENTIAL);
+#endif
+    adviseReadAhead(0);
+
+    LOG_INFO("AssetStream", "Opened %s: %s, %d Hz, %d channels, %zu packets", filePath.c_str(),
+        avcodec_get_name(codecId), sampleRate, channels, packets.size());
+    return true;
+}
+
+void AssetStream::close() {
+    if (decoder) {
+        // Pooled decoders go back in their default staging mode
+        decoder->setInputMode(InputMode::Copy);
+        DecoderPool::getInstance().release(std::move(decoder));
+    }
+    unmapFile();
+    filePath.clear();
+    codecId = AV_CODEC_ID_NONE;
+    sampleRate = 0;
+    channels = 0;
+    codecConfig.clear();
+    packets.clear();
+    nextPacket = 0;
+    adviseOffset = 0;
+}
+
+int AssetStream::read(uint8_t* outputBuffer, int outputBufferSize, int* outputSize) {
+    if (!decoder || !outputBuffer || outputBufferSize <= 0 || !outputSize) {
+        return -1;
+    }
+
+    // Whole samples only, so every chunk starts on a sample boundary
+    const int sampleBytes = decoder->getOutputChannels() *
+                            av_get_bytes_per_sample(decoder->getOutputSampleFormat());
+    const int capacity = outputBufferSize / sampleBytes * sampleBytes;
+    *outputSize = 0;
+    if (capacity == 0) {
+        return -2;
+    }
+
+    // PCM left over from the previous call comes first
+    int written = 0;
+    int ret = decoder->readBuffered(outputBuffer, capacity, &written);
+    if (ret < 0) {
+        return ret;
+    }
+
+    while (written < capacity && nextPacket < packets.size()) {
+        const PacketRef& packet = packets[nextPacket++];
+        adviseReadAhead(packet.offset + packet.size);
+
+        // The bytes after a packet belong to the mapping, so they serve as its padding
+        decoder->setInputMode(packet.offset + packet.size + AV_INPUT_BUFFER_PADDING_SIZE <= mappedSize
+                                  ? InputMode::ZeroCopy : InputMode::Copy);
+
+        int chunk = 0;
+        ret = decoder->decodePacket(mappedData + packet.offset, static_cast<int>(packet.size),
+                                    outputBuffer + written, capacity - written, &chunk);
+        if (ret < 0 && ret != -2) {
+            LOG_WARNING_RATELIMITED("AssetStream", "Skipping packet %zu of %s that failed to decode",
+                nextPacket - 1, filePath.c_str());
+            continue;
+        }
+        written += chunk;
+    }
+
+    *outputSize = written;
+    return 0;
+}
+
+bool AssetStream::rewind() {
+    if (!decoder || !decoder->reset()) {
+        return false;
+    }
+    nextPacket = 0;
+    adviseOffset = 0;
+    adviseReadAhead(0);
+    return true;
+}
+
+bool AssetStream::isFinished() const {
+    return !decoder || (nextPacket >= packets.size() && decoder->getBufferedSamples() == 0);
+}
+
+bool AssetStream::getInfo(DecoderInfo& info) const {
+    return decoder && decoder->getDecoderInfo(info);
+}
+
+bool AssetStream::getStats(DecoderStatsSnapshot& stats) const {
+    if (!decoder) {
+        return false;
+    }
+    decoder->getStats().snapshot(stats);
+    return true;
+}
+
+bool AssetStream::mapFile() {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+    // The view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return false;
+    }
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void AssetStream::unmapFile() {
+    if (mappedData) {
+#ifdef _WIN32
+        UnmapViewOfFile(mappedData);
+#else
+        munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+#endif
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+bool AssetStream::indexAdts() {
+    size_t offset = getId3TagSize(mappedData, mappedSize);
+    while (offset < mappedSize) {
+        const int frameSize = getAdtsFrameSize(mappedData + offset, mappedSize - offset);
+        if (frameSize == 0 || static_cast<size_t>(frameSize) > mappedSize - offset) {
+            // Trailing tags or a truncated last frame
+            break;
+        }
+        packets.push_back(PacketRef{offset, static_cast<uint32_t>(frameSize)});
+        offset += static_cast<size_t>(frameSize);
+    }
+    if (packets.empty()) {
+        return false;
+    }
+
+    // The first header configures the decoder through its AudioSpecificConfig; the raw header
+    // would carry that frame's length into the pool key and the cache seed. The decoder's
+    // first-packet probe finds the headers and strips them.
+    const uint8_t* header = mappedData + packets.front().offset;
+    AacCodecInfo config;
+    if (!parseAacConfig(header, kAdtsHeaderSize, config)) {
+        return false;
+    }
+    codecId = AV_CODEC_ID_AAC;
+    sampleRate = config.sampleRate;
+    channels = config.channels;
+    codecConfig.assign(config.builtConfig, config.builtConfig + config.builtConfigSize);
+    return true;
+}
+
+bool AssetStream::indexContainer() {
+    MappedReader reader{mappedData, mappedSize, 0};
+    uint8_t* ioBuffer = static_cast<uint8_t*>(av_malloc(kHeaderIoBufferSize));
+    AVIOContext* io = ioBuffer ? avio_alloc_context(ioBuffer, kHeaderIoBufferSize, 0, &reader,
+                                                    &readMapped, nullptr, &seekMapped)
+                               : nullptr;
+    AVFormatContext* format = io ? avformat_alloc_context() : nullptr;
+    if (!format) {
+        if (io) {
+            av_freep(&io->buffer);
+            avio_context_free(&io);
+        } else {
+            av_free(ioBuffer);
+        }
+        return false;
+    }
+    format->pb = io;
+    format->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    // Only the header is parsed; the demuxer builds the full sample table from it
+    bool indexed = false;
+    if (avformat_open_input(&format, filePath.c_str(), nullptr, nullptr) >= 0) {
+        const int streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamIndex >= 0) {
+            AVStream* stream = format->streams[streamIndex];
+            const AVCodecParameters* parameters = stream->codecpar;
+            const int entryCount = avformat_index_get_entries_count(stream);
+            packets.reserve(static_cast<size_t>(std::max(entryCount, 0)));
+            for (int i = 0; i < entryCount; ++i) {
+                const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+                if (entry->pos < 0 || entry->size <= 0 ||
+                    static_cast<uint64_t>(entry->pos) + entry->size > mappedSize) {
+                    continue;
+                }
+                packets.push_back(PacketRef{static_cast<uint64_t>(entry->pos),
+                                            static_cast<uint32_t>(entry->size)});
+            }
+
+            codecId = parameters->codec_id;
+            sampleRate = parameters->sample_rate;
+            channels = parameters->channels;
+            if (parameters->extradata && parameters->extradata_size > 0) {
+                codecConfig.assign(parameters->extradata, parameters->extradata + parameters->extradata_size);
+            }
+            // Fragmented files carry no sample table in their header
+            indexed = !packets.empty();
+            if (!indexed) {
+                LOG_ERROR("AssetStream", "Error: %s has no sample table (fragmented files are not supported)",
+                    filePath.c_str());
+            }
+        }
+        avformat_close_input(&format);
+    } else {
+        LOG_ERROR("AssetStream", "Error: Unrecognized container in %s", filePath.c_str());
+    }
+
+    // A failed open frees the format context but never a caller-supplied AVIO context
+    av_freep(&io->buffer);
+    avio_context_free(&io);
+    return indexed;
+}
+
+void AssetStream::adviseReadAhead(uint64_t position) {
+    // Keep at least half a window requested ahead of the packet being decoded
+    if (adviseOffset >= mappedSize || position + kReadAheadBytes / 2 < adviseOffset) {
+        return;
+    }
+    // Windows start at multiples of kReadAheadBytes, so they are page aligned
+    const uint64_t start = adviseOffset;
+    const size_t length = static_cast<size_t>(std::min<uint64_t>(kReadAheadBytes, mappedSize - start));
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(mappedData) + start, length};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(const_cast<uint8_t*>(mappedData) + start, length, MADV_WILLNEED);
+#endif
+    adviseOffset = start + length;
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,141 @@
+#pragma once
+
+/**
+ * @file AssetStream.h
+ * @brief Memory-mapped audio asset streaming for ShadPS4
+ *
+ * Decodes whole audio files (MP4/M4A, or raw ADTS .aac) for host-side
+ * tooling and asset preloading, where no game splits the packets. The file
+ * is memory-mapped once. FFmpeg's demuxer only parses the container header
+ * to build the sample table; packets are then handed to the decoder as
+ * pointers into the mapping (zero-copy staging), so the compressed data is
+ * never copied or read through a syscall. ADTS files are split by walking
+ * their frame headers directly.
+ *
+ * read() pulls PCM in caller-sized chunks. The pages ahead of the read
+ * position are requested from the OS one window at a time, and the whole
+ * mapping is marked for sequential access, so large music files stream
+ * with a handful of read-ahead calls.
+ */
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include "OrbisAudioDecoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Decoder fed from a memory-mapped asset file
+ */
+class AssetStream {
+public:
+    AssetStream();
+    ~AssetStream();
+
+    /**
+     * @brief Map a file, index its packets and take a decoder for its audio stream
+     * @param path Asset file path
+     * @param outputFormat Interleaved PCM format read() writes (S16, S32 or FLT)
+     * @param targetSampleRate Rate read() produces; 0 keeps the stream's rate
+     * @param resamplePreset Filter quality used when resampling
+     * @return true if the stream is ready, false otherwise
+     */
+    bool open(const std::string& path, AVSampleFormat outputFormat = AV_SAMPLE_FMT_S16,
+              int targetSampleRate = 0, ResamplePreset resamplePreset = ResamplePreset::Balanced);
+
+    /**
+     * @brief Return the decoder to the pool and unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return decoder != nullptr; }
+
+    /**
+     * @brief Decode the next PCM into the caller's buffer
+     *
+     * Fills the buffer as far as the stream allows; PCM of a packet that
+     * does not fit is kept for the next call. Packets that fail to decode
+     * are skipped (and counted in the decoder statistics).
+     *
+     * @param outputBuffer Destination for interleaved PCM
+     * @param outputBufferSize Size of outputBuffer in bytes
+     * @param outputSize Receives the bytes written; 0 once the stream has ended
+     * @return 0 on success, -2 if the buffer cannot hold a single sample,
+     *         -1 if the stream is not open or the arguments are invalid
+     */
+    int read(uint8_t* outputBuffer, int outputBufferSize, int* outputSize);
+
+    /**
+     * @brief Restart the stream from its first packet
+     * @return true on success, false if the stream is not open
+     */
+    bool rewind();
+
+    /**
+     * @brief Check whether every packet has been decoded and handed out
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Get the decoder's stream information
+     * @return true if info was filled in, false if the stream is not open
+     */
+    bool getInfo(DecoderInfo& info) const;
+
+    /**
+     * @brief Copy the decoder's counters (packets, errors, decode time)
+     * @return true if stats was filled in, false if the stream is not open
+     */
+    bool getStats(DecoderStatsSnapshot& stats) const;
+
+    /**
+     * @brief Get the number of packets in the asset
+     */
+    size_t getPacketCount() const { return packets.size(); }
+
+private:
+    /**
+     * @brief Location of one compressed packet in the mapping
+     */
+    struct PacketRef {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    bool mapFile();
+    void unmapFile();
+    bool indexAdts();
+    bool indexContainer();
+    void adviseReadAhead(uint64_t position);
+
+    std::string filePath;
+    const uint8_t* mappedData;      // Read-only view of the whole file
+    size_t mappedSize;
+
+    // Stream description found while indexing
+    AVCodecID codecId;
+    int sampleRate;
+    int channels;
+    std::vector<uint8_t> codecConfig;   // Container extradata, or the first ADTS header's AudioSpecificConfig
+    std::vector<PacketRef> packets;     // Packets in decode order
+
+    // Read position
+    size_t nextPacket;              // Next packet to decode
+    uint64_t adviseOffset;          // End of the window already requested from the OS
+
+    std::unique_ptr<OrbisAudioDecoder> decoder;
+
+    // Disable copy constructor and assignment operator
+    AssetStream(const AssetStream&) = delete;
+    AssetStream& operator=(const AssetStream&) = delete;
+};
+
+} // namespace ShadPS4::Audio
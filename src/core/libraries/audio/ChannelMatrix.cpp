@@ -0,0 +1,184 @@
+/**
+ * @file ChannelMatrix.cpp
+ * @brief Output channel map and downmix matrix for ShadPS4 decoders
+ *
+ * This file implements the standard remap and downmix presets and the
+ * dispatch to the SIMD matrix kernels in PcmConvert.
+ */
+
+#include "ChannelMatrix.h"
+#include "PcmConvert.h"
+
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// -3 dB, the BS.775 gain for centre and surround channels folded into a front pair
+constexpr float kMinus3dB = 0.70710678f;
+
+// Input channel positions in FFmpeg's default 5.1 and 7.1 layouts
+enum InputChannel : int {
+    kFrontLeft = 0,
+    kFrontRight = 1,
+    kFrontCenter = 2,
+    kLowFrequency = 3,
+    kBackLeft = 4,
+    kBackRight = 5,
+    kSideLeft = 6,
+    kSideRight = 7
+};
+
+} // namespace
+
+ChannelMatrix::ChannelMatrix() {
+    clear();
+}
+
+void ChannelMatrix::clear() {
+    inputChannels = 0;
+    outputChannels = 0;
+    preset = ChannelMixPreset::None;
+    channelMap = false;
+    gains.fill(0.0f);
+    sources.fill(-1);
+}
+
+bool ChannelMatrix::setPreset(ChannelMixPreset newPreset) {
+    clear();
+
+    switch (newPreset) {
+    case ChannelMixPreset::None:
+        return true;
+
+    case ChannelMixPreset::Ps4Order71: {
+        // FFmpeg puts the back pair before the side pair; the console wants sides first
+        static const int map[8] = {kFrontLeft, kFrontRight, kFrontCenter, kLowFrequency,
+                                   kSideLeft, kSideRight, kBackLeft, kBackRight};
+        setChannelMap(8, 8, map);
+        break;
+    }
+
+    case ChannelMixPreset::Downmix51To20: {
+        // Normalized so a full-scale signal on every channel cannot clip
+        const float scale = 1.0f / (1.0f + 2.0f * kMinus3dB);
+        const float matrix[2 * 6] = {
+            scale, 0.0f, kMinus3dB * scale, 0.0f, kMinus3dB * scale, 0.0f,
+            0.0f, scale, kMinus3dB * scale, 0.0f, 0.0f, kMinus3dB * scale,
+        };
+        setMatrix(6, 2, matrix);
+        break;
+    }
+
+    case ChannelMixPreset::Downmix71To20: {
+        const float scale = 1.0f / (1.0f + 3.0f * kMinus3dB);
+        const float c = kMinus3dB * scale;
+        const float matrix[2 * 8] = {
+            scale, 0.0f, c, 0.0f, c, 0.0f, c, 0.0f,
+            0.0f, scale, c, 0.0f, 0.0f, c, 0.0f, c,
+        };
+        setMatrix(8, 2, matrix);
+        break;
+    }
+
+    case ChannelMixPreset::Downmix71To51: {
+        // Front channels and LFE pass through; each surround is side + back at -3 dB
+        float matrix[6 * 8] = {};
+        for (int ch = kFrontLeft; ch <= kLowFrequency; ++ch) {
+            matrix[ch * 8 + ch] = 1.0f;
+        }
+        matrix[kBackLeft * 8 + kBackLeft] = kMinus3dB;
+        matrix[kBackLeft * 8 + kSideLeft] = kMinus3dB;
+        matrix[kBackRight * 8 + kBackRight] = kMinus3dB;
+        matrix[kBackRight * 8 + kSideRight] = kMinus3dB;
+        setMatrix(8, 6, matrix);
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    preset = newPreset;
+    return true;
+}
+
+bool ChannelMatrix::setMatrix(int newInputChannels, int newOutputChannels, const float* newGains) {
+    if (newInputChannels <= 0 || newInputChannels > kMaxChannels || newOutputChannels <= 0 ||
+        newOutputChannels > kMaxChannels || !newGains) {
+        return false;
+    }
+
+    clear();
+    inputChannels = newInputChannels;
+    outputChannels = newOutputChannels;
+    std::memcpy(gains.data(), newGains, sizeof(float) * inputChannels * outputChannels);
+    updateChannelMap();
+    return true;
+}
+
+bool ChannelMatrix::setChannelMap(int newInputChannels, int newOutputChannels,
+                                  const int* sourceChannels) {
+    if (newInputChannels <= 0 || newInputChannels > kMaxChannels || newOutputChannels <= 0 ||
+        newOutputChannels > kMaxChannels || !sourceChannels) {
+        return false;
+    }
+
+    float matrix[kMaxChannels * kMaxChannels] = {};
+    for (int o = 0; o < newOutputChannels; ++o) {
+        if (sourceChannels[o] < 0 || sourceChannels[o] >= newInputChannels) {
+            return false;
+        }
+        matrix[o * newInputChannels + sourceChannels[o]] = 1.0f;
+    }
+    return setMatrix(newInputChannels, newOutputChannels, matrix);
+}
+
+void ChannelMatrix::updateChannelMap() {
+    channelMap = true;
+    for (int o = 0; o < outputChannels; ++o) {
+        int source = -1;
+        for (int c = 0; c < inputChannels; ++c) {
+            const float gain = gains[o * inputChannels + c];
+            if (gain == 0.0f) {
+                continue;
+            }
+            if (gain != 1.0f || source >= 0) {
+                source = -1;
+                break;
+            }
+            source = c;
+        }
+        if (source < 0) {
+            channelMap = false;
+            sources.fill(-1);
+            return;
+        }
+        sources[o] = static_cast<int8_t>(source);
+    }
+}
+
+void ChannelMatrix::mix(const float* const* input, float* const* output, size_t samples) const {
+    PcmConvert::getMixKernel()(input, inputChannels, output, outputChannels, gains.data(), samples);
+}
+
+size_t ChannelMatrix::getHash() const {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = (hash ^ static_cast<uint64_t>(inputChannels)) * 0x100000001b3ULL;
+    hash = (hash ^ static_cast<uint64_t>(outputChannels)) * 0x100000001b3ULL;
+    for (int i = 0; i < inputChannels * outputChannels; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &gains[i], sizeof(bits));
+        hash = (hash ^ bits) * 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool ChannelMatrix::operator==(const ChannelMatrix& other) const {
+    return inputChannels == other.inputChannels && outputChannels == other.outputChannels &&
+           std::memcmp(gains.data(), other.gains.data(),
+                       sizeof(float) * inputChannels * outputChannels) == 0;
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * @file ChannelMatrix.h
+ * @brief Output channel map and downmix matrix for ShadPS4 decoders
+ *
+ * Decoders hand out channels in FFmpeg's order for the stream's default
+ * layout (5.1: FL FR FC LFE BL BR; 7.1: FL FR FC LFE BL BR SL SR). A
+ * ChannelMatrix set on a decoder reorders or downmixes them while the
+ * decoder converts to the output format, so the mixer receives PCM in the
+ * layout it plays and no voice needs a second pass.
+ *
+ * A matrix whose rows each copy one input unchanged is a channel map and
+ * costs nothing: the decoder only reorders plane pointers.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Standard channel matrices
+ */
+enum class ChannelMixPreset : int {
+    None = 0,                   // Codec order, no mixing
+    Ps4Order71 = 1,             // 7.1 in the console's order: L R C LFE Ls Rs Lb Rb
+    Downmix51To20 = 2,          // 5.1 to stereo (ITU-R BS.775, LFE dropped)
+    Downmix71To20 = 3,          // 7.1 to stereo (ITU-R BS.775, LFE dropped)
+    Downmix71To51 = 4           // 7.1 to 5.1, side and back folded into the surround pair
+};
+
+/**
+ * @brief Matrix of gains from decoded channels to output channels
+ */
+class ChannelMatrix {
+public:
+    static constexpr int kMaxChannels = 8;
+
+    /**
+     * @brief Create an inactive matrix (channels pass through unchanged)
+     */
+    ChannelMatrix();
+
+    /**
+     * @brief Load a standard matrix
+     * @return true on success; None clears the matrix
+     */
+    bool setPreset(ChannelMixPreset preset);
+
+    /**
+     * @brief Load an arbitrary matrix
+     * @param inputChannels Decoded channel count (1-8)
+     * @param outputChannels Output channel count (1-8)
+     * @param gains Row-major outputChannels x inputChannels gains
+     * @return true on success, false if the dimensions are out of range
+     */
+    bool setMatrix(int inputChannels, int outputChannels, const float* gains);
+
+    /**
+     * @brief Load a channel map
+     * @param inputChannels Decoded channel count (1-8)
+     * @param outputChannels Output channel count (1-8)
+     * @param sourceChannels Input channel copied to each output channel
+     * @return true on success, false if a dimension or index is out of range
+     */
+    bool setChannelMap(int inputChannels, int outputChannels, const int* sourceChannels);
+
+    /**
+     * @brief Make the matrix inactive
+     */
+    void clear();
+
+    bool isActive() const { return outputChannels > 0; }
+    int getInputChannels() const { return inputChannels; }
+    int getOutputChannels() const { return outputChannels; }
+    ChannelMixPreset getPreset() const { return preset; }
+
+    /**
+     * @brief Check whether every output copies exactly one input at unity gain
+     */
+    bool isChannelMap() const { return channelMap; }
+
+    /**
+     * @brief Input channel copied to an output channel (channel maps only)
+     */
+    int getSourceChannel(int output) const { return sources[output]; }
+
+    /**
+     * @brief Row-major outputChannels x inputChannels gains
+     */
+    const float* getGains() const { return gains.data(); }
+
+    /**
+     * @brief Mix planar float samples with the SIMD kernel of the active level
+     * @param input getInputChannels() planes
+     * @param output getOutputChannels() planes; must not alias input
+     * @param samples Samples per channel
+     */
+    void mix(const float* const* input, float* const* output, size_t samples) const;
+
+    /**
+     * @brief Get a hash of the matrix, for keying decoder pools
+     */
+    size_t getHash() const;
+
+    bool operator==(const ChannelMatrix& other) const;
+    bool operator!=(const ChannelMatrix& other) const { return !(*this == other); }
+
+private:
+    void updateChannelMap();
+
+    int inputChannels;
+    int outputChannels;         // 0 when inactive
+    ChannelMixPreset preset;    // None for custom matrices
+    bool channelMap;
+    std::array<float, kMaxChannels * kMaxChannels> gains;
+    std::array<int8_t, kMaxChannels> sources; // Valid when channelMap is set
+};
+
+} // namespace ShadPS4::Audio
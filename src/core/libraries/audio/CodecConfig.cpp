@@ -0,0 +1,317 @@
+/**
+ * @file CodecConfig.cpp
+ * @brief Codec setup data helpers for ShadPS4
+ *
+ * This file implements the AT9 configuration parser, the Opus header and
+ * rate checks and the AAC configuration parsers shared by sceAudioDec and
+ * the AJM plugins.
+ */
+
+#include "CodecConfig.h"
+#include "common/logging/log.h"
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+constexpr uint8_t kAt9SyncByte = 0xFE;
+constexpr uint32_t kAt9ExtensionVersion = 1;
+
+// Sample rate by 4-bit index; indexes 8 and above are high-rate modes
+constexpr int kAt9SampleRates[8] = {11025, 12000, 8000, 22050, 24000, 16000, 44100, 48000};
+
+// Channel count by 3-bit block configuration index (mono, dual mono, stereo, 5.1, 7.1, quad)
+constexpr int kAt9BlockChannels[6] = {1, 2, 2, 6, 8, 4};
+
+// AAC sample rate by 4-bit index; 15 means an explicit 24-bit rate follows
+constexpr int kAacSampleRates[13] = {96000, 88200, 64000, 48000, 44100, 32000, 24000,
+                                     22050, 16000, 12000, 11025, 8000, 7350};
+constexpr int kAacExplicitRateIndex = 15;
+
+// Channel count by AAC channel configuration 1-7 (0: program config element)
+constexpr int kAacConfigChannels[8] = {0, 1, 2, 3, 4, 5, 6, 8};
+
+constexpr int kAacObjectTypeLc = 2;
+constexpr int kAacObjectTypeSbr = 5;
+constexpr int kAacObjectTypePs = 29;
+constexpr int kAacObjectTypeEscape = 31;
+
+/**
+ * @brief MSB-first reader over a configuration blob
+ */
+struct BitReader {
+    const uint8_t* data;
+    size_t bitCount;
+    size_t position = 0;
+
+    bool read(int bits, uint32_t& value) {
+        if (position + bits > bitCount) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bits; ++i, ++position) {
+            value = (value << 1) | ((data[position >> 3] >> (7 - (position & 7))) & 1);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief MSB-first writer for building an AudioSpecificConfig
+ */
+struct BitWriter {
+    uint8_t* data;
+    size_t position = 0;
+
+    void write(int bits, uint32_t value) {
+        for (int i = bits - 1; i >= 0; --i, ++position) {
+            if ((value >> i) & 1) {
+                data[position >> 3] |= static_cast<uint8_t>(0x80 >> (position & 7));
+            }
+        }
+    }
+};
+
+bool readObjectType(BitReader& reader, int& objectType) {
+    uint32_t value;
+    if (!reader.read(5, value)) {
+        return false;
+    }
+    if (value == kAacObjectTypeEscape) {
+        uint32_t extension;
+        if (!reader.read(6, extension)) {
+            return false;
+        }
+        value = 32 + extension;
+    }
+    objectType = static_cast<int>(value);
+    return true;
+}
+
+bool readSampleRate(BitReader& reader, int& sampleRate) {
+    uint32_t index;
+    if (!reader.read(4, index)) {
+        return false;
+    }
+    if (index == kAacExplicitRateIndex) {
+        uint32_t rate;
+        if (!reader.read(24, rate)) {
+            return false;
+        }
+        sampleRate = static_cast<int>(rate);
+    } else {
+        sampleRate = index < 13 ? kAacSampleRates[index] : 0;
+    }
+    return sampleRate > 0;
+}
+
+int findAacRateIndex(int sampleRate) {
+    for (int i = 0; i < 13; ++i) {
+        if (kAacSampleRates[i] == sampleRate) {
+            return i;
+        }
+    }
+    return kAacExplicitRateIndex;
+}
+
+void writeAacConfig(int objectType, int sampleRate, int channelConfig, AacCodecInfo& info) {
+    std::memset(info.builtConfig, 0, sizeof(info.builtConfig));
+    BitWriter writer{info.builtConfig};
+    const int rateIndex = findAacRateIndex(sampleRate);
+    writer.write(5, static_cast<uint32_t>(objectType));
+    writer.write(4, static_cast<uint32_t>(rateIndex));
+    if (rateIndex == kAacExplicitRateIndex) {
+        writer.write(24, static_cast<uint32_t>(sampleRate));
+    }
+    writer.write(4, static_cast<uint32_t>(channelConfig));
+    // GASpecificConfig: 1024-sample frames, no core coder delay, no extension
+    writer.write(3, 0);
+    info.builtConfigSize = static_cast<int>((writer.position + 7) / 8);
+}
+
+bool parseAdtsConfig(const uint8_t* data, AacCodecInfo& info) {
+    const int profile = data[2] >> 6;
+    const int rateIndex = (data[2] >> 2) & 0xF;
+    const int channelConfig = ((data[2] & 0x1) << 2) | (data[3] >> 6);
+    if (rateIndex >= 13) {
+        LOG_ERROR("CodecConfig", "Error: Invalid ADTS sample rate index %d", rateIndex);
+        return false;
+    }
+    if (channelConfig == 0) {
+        // The layout would only be known from the first frame's program config element
+        LOG_ERROR("CodecConfig", "Error: ADTS header without a channel configuration");
+        return false;
+    }
+
+    info.objectType = profile + 1;
+    info.extensionObjectType = 0;
+    info.sampleRate = kAacSampleRates[rateIndex];
+    info.extensionSampleRate = 0;
+    info.channels = kAacConfigChannels[channelConfig];
+    info.adts = true;
+    writeAacConfig(info.objectType, info.sampleRate, channelConfig, info);
+    return true;
+}
+
+} // namespace
+
+bool parseAt9Config(const uint8_t* data, size_t size, At9CodecInfo& info) {
+    if (!data || (size != kAt9ConfigWordSize && size != kAt9ExtradataSize)) {
+        LOG_ERROR("CodecConfig", "Error: AT9 config must be %d or %d bytes", kAt9ConfigWordSize,
+            kAt9ExtradataSize);
+        return false;
+    }
+
+    // The config word follows the 4-byte version in the WAVE extension layout
+    const uint8_t* word = (size == kAt9ExtradataSize) ? data + 4 : data;
+    if (word[0] != kAt9SyncByte) {
+        LOG_ERROR("CodecConfig", "Error: AT9 config has bad sync byte 0x%02x", word[0]);
+        return false;
+    }
+
+    const int sampleRateIndex = word[1] >> 4;
+    const int blockConfigIndex = (word[1] >> 1) & 0x7;
+    if (sampleRateIndex >= 8) {
+        LOG_ERROR("CodecConfig", "Error: Unsupported AT9 sample rate index %d", sampleRateIndex);
+        return false;
+    }
+    if (blockConfigIndex >= 6) {
+        LOG_ERROR("CodecConfig", "Error: Invalid AT9 block configuration %d", blockConfigIndex);
+        return false;
+    }
+
+    info.sampleRate = kAt9SampleRates[sampleRateIndex];
+    info.channels = kAt9BlockChannels[blockConfigIndex];
+
+    if (size == kAt9ExtradataSize) {
+        std::memcpy(info.extradata, data, kAt9ExtradataSize);
+    } else {
+        std::memset(info.extradata, 0, sizeof(info.extradata));
+        info.extradata[0] = static_cast<uint8_t>(kAt9ExtensionVersion);
+        std::memcpy(info.extradata + 4, data, kAt9ConfigWordSize);
+    }
+    return true;
+}
+
+bool parseOpusHead(const uint8_t* data, size_t size, int& channels) {
+    if (!data || size < kOpusHeadMinSize || std::memcmp(data, "OpusHead", 8) != 0) {
+        LOG_ERROR("CodecConfig", "Error: Opus config is not an OpusHead header");
+        return false;
+    }
+
+    // Byte 8: version (major 0), byte 9: channels, byte 18: mapping family
+    const int version = data[8];
+    const int headChannels = data[9];
+    const int mappingFamily = data[18];
+    if ((version >> 4) != 0 || headChannels == 0) {
+        LOG_ERROR("CodecConfig", "Error: Unsupported OpusHead (version %d, %d channels)", version,
+            headChannels);
+        return false;
+    }
+    if (mappingFamily != 0 && size < static_cast<size_t>(kOpusHeadMinSize + 2 + headChannels)) {
+        LOG_ERROR("CodecConfig", "Error: OpusHead channel mapping table is truncated");
+        return false;
+    }
+
+    channels = headChannels;
+    return true;
+}
+
+bool parseAacConfig(const uint8_t* data, size_t size, AacCodecInfo& info) {
+    if (!data || size == 0) {
+        LOG_ERROR("CodecConfig", "Error: Empty AAC config");
+        return false;
+    }
+    if (isAdtsHeader(data, size)) {
+        return parseAdtsConfig(data, info);
+    }
+
+    BitReader reader{data, size * 8};
+    uint32_t channelConfig = 0;
+    if (!readObjectType(reader, info.objectType) || !readSampleRate(reader, info.sampleRate) ||
+        !reader.read(4, channelConfig)) {
+        LOG_ERROR("CodecConfig", "Error: AudioSpecificConfig is truncated (%zu bytes)", size);
+        return false;
+    }
+
+    // Explicit SBR/PS signalling: the extension rate and the core object type follow
+    info.extensionObjectType = 0;
+    info.extensionSampleRate = 0;
+    if (info.objectType == kAacObjectTypeSbr || info.objectType == kAacObjectTypePs) {
+        info.extensionObjectType = info.objectType;
+        if (!readSampleRate(reader, info.extensionSampleRate) || !readObjectType(reader, info.objectType)) {
+            LOG_ERROR("CodecConfig", "Error: AudioSpecificConfig SBR extension is truncated");
+            return false;
+        }
+    }
+
+    if (info.objectType == 0 || info.objectType == kAacObjectTypeEscape) {
+        LOG_ERROR("CodecConfig", "Error: Invalid AAC object type %d", info.objectType);
+        return false;
+    }
+    if (channelConfig >= 8) {
+        LOG_ERROR("CodecConfig", "Error: Unsupported AAC channel configuration %u", channelConfig);
+        return false;
+    }
+
+    info.channels = kAacConfigChannels[channelConfig];
+    info.adts = false;
+    info.builtConfigSize = 0;
+    return true;
+}
+
+bool buildAacConfig(int sampleRate, int channels, AacCodecInfo& info) {
+    int channelConfig = 0;
+    for (int i = 1; i < 8; ++i) {
+        if (kAacConfigChannels[i] == channels) {
+            channelConfig = i;
+            break;
+        }
+    }
+    if (sampleRate <= 0 || sampleRate >= (1 << 24) || channelConfig == 0) {
+        return false;
+    }
+
+    info.objectType = kAacObjectTypeLc;
+    info.extensionObjectType = 0;
+    info.sampleRate = sampleRate;
+    info.extensionSampleRate = 0;
+    info.channels = channels;
+    info.adts = false;
+    writeAacConfig(kAacObjectTypeLc, sampleRate, channelConfig, info);
+    return true;
+}
+
+int getAdtsFrameSize(const uint8_t* data, size_t size) {
+    if (!isAdtsHeader(data, size)) {
+        return 0;
+    }
+    const int frameLength = ((data[3] & 0x3) << 11) | (data[4] << 3) | (data[5] >> 5);
+    const int headerSize = (data[1] & 0x1) ? kAdtsHeaderSize : kAdtsHeaderSize + 2;
+    return frameLength > headerSize ? frameLength : 0;
+}
+
+int getAdtsHeaderSize(const uint8_t* data, size_t size) {
+    const int frameLength = getAdtsFrameSize(data, size);
+    const int rawDataBlocks = frameLength > 0 ? (data[6] & 0x3) + 1 : 0;
+    if (rawDataBlocks != 1 || static_cast<size_t>(frameLength) != size) {
+        return 0;
+    }
+    return (data[1] & 0x1) ? kAdtsHeaderSize : kAdtsHeaderSize + 2;
+}
+
+bool isOpusSampleRate(int sampleRate) {
+    switch (sampleRate) {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * @file CodecConfig.h
+ * @brief Codec setup data helpers for ShadPS4
+ *
+ * Games describe AT9 and Opus streams with small configuration blobs rather
+ * than container headers. These helpers validate them and turn them into the
+ * extradata FFmpeg's decoders expect, so the SCE front end and the AJM
+ * plugins derive the same decoder configuration from the same bytes.
+ *
+ * AAC streams are described by an AudioSpecificConfig or carry ADTS headers.
+ * Either is turned into an AudioSpecificConfig here, so the AAC decoder is
+ * configured before its first packet instead of probing the stream.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ShadPS4::Audio {
+
+constexpr int kAt9ConfigWordSize = 4;       // Raw AT9 config word (starts with 0xFE)
+constexpr int kAt9ExtradataSize = 12;       // Version + config word + reserved (WAVE extension layout)
+constexpr int kOpusDecodeSampleRate = 48000; // Opus always decodes at 48 kHz
+constexpr int kOpusHeadMinSize = 19;        // OpusHead without a channel mapping table
+constexpr int kAdtsHeaderSize = 7;          // ADTS fixed + variable header without CRC
+constexpr int kAacBuiltConfigSize = 5;      // Longest AudioSpecificConfig built here (explicit 24-bit rate)
+
+/**
+ * @brief Stream parameters carried by an AT9 configuration
+ */
+struct At9CodecInfo {
+    int sampleRate;                             // Output sample rate in Hz
+    int channels;                               // Output channel count
+    uint8_t extradata[kAt9ExtradataSize];       // Extradata for FFmpeg's atrac9 decoder
+};
+
+/**
+ * @brief Stream parameters carried by an AAC configuration
+ */
+struct AacCodecInfo {
+    int objectType;                             // Core audio object type (2: LC)
+    int extensionObjectType;                    // 5 (SBR) or 29 (PS) if signalled explicitly, else 0
+    int sampleRate;                             // Core sample rate in Hz
+    int extensionSampleRate;                    // SBR output rate in Hz, 0 if not signalled
+    int channels;                               // Channel count, 0 if a program config element sets it
+    bool adts;                                  // The configuration was an ADTS header
+    uint8_t builtConfig[kAacBuiltConfigSize];   // AudioSpecificConfig built by this module
+    int builtConfigSize;                        // Size of builtConfig, 0 if the input was an AudioSpecificConfig
+};
+
+/**
+ * @brief Parse an AT9 configuration
+ * @param data Either the 4-byte config word or the 12-byte AT9 WAVE extension
+ * @param size Size of data in bytes
+ * @param info Receives the stream parameters and the decoder extradata
+ * @return true if the configuration is valid, false otherwise
+ */
+bool parseAt9Config(const uint8_t* data, size_t size, At9CodecInfo& info);
+
+/**
+ * @brief Validate an OpusHead identification header
+ *
+ * Streams with more than two channels need one; mono and stereo streams
+ * decode without it.
+ *
+ * @param data Header bytes ("OpusHead" magic first)
+ * @param size Size of data in bytes
+ * @param channels Receives the channel count the header declares
+ * @return true if the header is valid, false otherwise
+ */
+bool parseOpusHead(const uint8_t* data, size_t size, int& channels);
+
+/**
+ * @brief Check whether a rate is one Opus can be configured for
+ *
+ * The decoder output is 48 kHz regardless; the rate only validates the
+ * caller's configuration.
+ */
+bool isOpusSampleRate(int sampleRate);
+
+/**
+ * @brief Parse an AAC configuration
+ *
+ * Accepts an AudioSpecificConfig or an ADTS header. For an ADTS header the
+ * equivalent AudioSpecificConfig is built into info.builtConfig.
+ *
+ * @param data AudioSpecificConfig or ADTS header bytes
+ * @param size Size of data in bytes
+ * @param info Receives the stream parameters
+ * @return true if the configuration is valid, false otherwise
+ */
+bool parseAacConfig(const uint8_t* data, size_t size, AacCodecInfo& info);
+
+/**
+ * @brief Build the AAC-LC AudioSpecificConfig for a stream without one
+ * @param sampleRate Stream sample rate in Hz
+ * @param channels Stream channel count (1-6 or 8)
+ * @param info Receives the stream parameters and the built configuration
+ * @return true if the parameters can be described, false otherwise
+ */
+bool buildAacConfig(int sampleRate, int channels, AacCodecInfo& info);
+
+/**
+ * @brief Check whether data starts with an ADTS sync word
+ */
+inline bool isAdtsHeader(const uint8_t* data, size_t size) {
+    // 12-bit sync word, then layer 0
+    return data && size >= kAdtsHeaderSize && data[0] == 0xFF && (data[1] & 0xF6) == 0xF0;
+}
+
+/**
+ * @brief Get the length of the ADTS frame starting at data, header included
+ * @return Frame length in bytes, 0 if data does not start with a valid ADTS header
+ */
+int getAdtsFrameSize(const uint8_t* data, size_t size);
+
+/**
+ * @brief Get the ADTS header size of a packet holding exactly one AAC frame
+ *
+ * Packets with several raw data blocks or several frames return 0 and are
+ * left to the codec.
+ *
+ * @return Header bytes to skip (7, or 9 with CRC), 0 if the packet is not a single ADTS frame
+ */
+int getAdtsHeaderSize(const uint8_t* data, size_t size);
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,181 @@
+/**
+ * @file DecodeTrace.cpp
+ * @brief Decode span tracing for ShadPS4, exported as Chrome trace JSON
+ *
+ * This file implements the per-thread span buffers and the JSON writer.
+ */
+
+#include "DecodeTrace.h"
+#include "common/logging/log.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Spans kept per thread and session (3 MiB); a 48 kHz stream of
+// 1024-sample packets records roughly 250 spans per second
+constexpr size_t kEventsPerThread = 1 << 16;
+
+// Buffers held at once, bounding tracing memory at 96 MiB
+constexpr size_t kMaxThreadBuffers = 32;
+
+} // namespace
+
+thread_local DecodeTrace::ThreadBufferOwner DecodeTrace::threadOwner;
+
+DecodeTrace::ThreadBufferOwner::~ThreadBufferOwner() {
+    if (buffer) {
+        DecodeTrace::getInstance().releaseThreadBuffer(buffer);
+    }
+}
+
+DecodeTrace& DecodeTrace::getInstance() {
+    static DecodeTrace instance;
+    return instance;
+}
+
+uint64_t DecodeTrace::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void DecodeTrace::start() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    enabled.store(false, std::memory_order_relaxed);
+    droppedEvents.store(0, std::memory_order_relaxed);
+    startNs.store(now(), std::memory_order_relaxed);
+    // Buffers reset themselves on their next record once they see the new generation
+    generation.fetch_add(1, std::memory_order_release);
+    enabled.store(true, std::memory_order_relaxed);
+    LOG_INFO("DecodeTrace", "Tracing started");
+}
+
+void DecodeTrace::stop() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+DecodeTrace::ThreadBuffer* DecodeTrace::getThreadBuffer() {
+    ThreadBufferOwner& owner = threadOwner;
+    if (owner.buffer) {
+        return owner.buffer;
+    }
+
+    // Once refused, only retry in a new session instead of locking on every span
+    const uint64_t currentGeneration = generation.load(std::memory_order_acquire);
+    if (owner.denied && owner.deniedGeneration == currentGeneration) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (!freeBuffers.empty()) {
+        owner.buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        return owner.buffer;
+    }
+    if (buffers.size() >= kMaxThreadBuffers) {
+        owner.denied = true;
+        owner.deniedGeneration = currentGeneration;
+        return nullptr;
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->events = std::make_unique<TraceEvent[]>(kEventsPerThread);
+    buffer->threadIndex = static_cast<uint32_t>(buffers.size()) + 1;
+    owner.buffer = buffer.get();
+    buffers.push_back(std::move(buffer));
+    return owner.buffer;
+}
+
+void DecodeTrace::releaseThreadBuffer(ThreadBuffer* buffer) {
+    // The spans stay in place for dump() until another thread takes the buffer
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    freeBuffers.push_back(buffer);
+}
+
+void DecodeTrace::record(const TraceEvent& event) {
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (!buffer) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // First span of a new session: forget the previous one before publishing anything
+    const uint64_t currentGeneration = generation.load(std::memory_order_acquire);
+    if (buffer->generation.load(std::memory_order_relaxed) != currentGeneration) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->generation.store(currentGeneration, std::memory_order_release);
+    }
+
+    const size_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= kEventsPerThread) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = event;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+bool DecodeTrace::dump(const std::string& path) {
+    std::lock_guard<std::mutex> controlLock(controlMutex);
+
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("DecodeTrace", "Error: Could not open trace file %s", path.c_str());
+        return false;
+    }
+
+    const uint64_t currentGeneration = generation.load(std::memory_order_acquire);
+    const uint64_t sessionStart = startNs.load(std::memory_order_relaxed);
+    size_t written = 0;
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    {
+        std::lock_guard<std::mutex> bufferLock(bufferMutex);
+        for (const auto& buffer : buffers) {
+            // Buffers still holding an earlier session have nothing to show
+            if (buffer->generation.load(std::memory_order_acquire) != currentGeneration) {
+                continue;
+            }
+            const size_t count = buffer->count.load(std::memory_order_acquire);
+            if (count == 0) {
+                continue;
+            }
+
+            std::fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                         "\"args\":{\"name\":\"Audio thread %u\"}}",
+                         written ? "," : "", buffer->threadIndex, buffer->threadIndex);
+            ++written;
+
+            for (size_t i = 0; i < count; ++i) {
+                const TraceEvent& event = buffer->events[i];
+                // Spans begun before start() belong to no session
+                if (event.beginNs < sessionStart) {
+                    continue;
+                }
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"audio\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                             "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"decoder\":%u,\"codec\":\"%s\","
+                             "\"size\":%d,\"result\":%d}}",
+                             event.name, buffer->threadIndex,
+                             static_cast<double>(event.beginNs - sessionStart) / 1000.0,
+                             static_cast<double>(event.durationNs) / 1000.0,
+                             event.decoderId, event.codec ? event.codec : "",
+                             event.size, event.result);
+            }
+        }
+    }
+    std::fprintf(file, "\n],\"otherData\":{\"droppedEvents\":%llu}}\n",
+                 static_cast<unsigned long long>(droppedEvents.load(std::memory_order_relaxed)));
+
+    const bool ok = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !ok) {
+        LOG_ERROR("DecodeTrace", "Error: Could not write trace file %s", path.c_str());
+        return false;
+    }
+    LOG_INFO("DecodeTrace", "Wrote trace of %zu threads to %s", written, path.c_str());
+    return true;
+}
+
+} // namespace ShadPS4::Audio
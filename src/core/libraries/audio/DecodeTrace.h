@@ -0,0 +1,181 @@
+#pragma once
+
+/**
+ * @file DecodeTrace.h
+ * @brief Decode span tracing for ShadPS4, exported as Chrome trace JSON
+ *
+ * The decoder counters say how long decoding takes on average; a trace
+ * shows where a single slow packet spent its time and which thread it ran
+ * on. While tracing is on, every sceAudioDecDecode and plugin decode call,
+ * every avcodec_send_packet / avcodec_receive_frame and every PCM
+ * conversion records one span: begin time, duration, decoder, codec,
+ * size and result.
+ *
+ * Spans go into per-thread append-only buffers: the recording thread is
+ * the only writer, so recording takes no lock and never allocates once the
+ * thread's buffer exists. A full buffer drops further spans and counts
+ * them. dump() writes everything recorded since start() in the Chrome
+ * trace event format, which chrome://tracing and ui.perfetto.dev open
+ * directly.
+ *
+ * When a thread exits, its buffer goes on a free list and the next new
+ * recording thread continues it, spans and all, so short-lived threads do
+ * not each leave a buffer behind. At most kMaxThreadBuffers exist; threads
+ * beyond that drop their spans.
+ *
+ * Tracing is off by default; a disabled span costs one relaxed load.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief One completed span
+ */
+struct TraceEvent {
+    const char* name;           // Static span name
+    const char* codec;          // Static codec name, or nullptr
+    uint64_t beginNs;           // Steady clock time the span began
+    uint64_t durationNs;        // Length of the span
+    uint32_t decoderId;         // OrbisAudioDecoder::getTraceId(), 0 if unknown
+    int32_t size;               // Packet bytes, or frame samples for conversions
+    int32_t result;             // Return code, or converted samples for conversions
+};
+
+/**
+ * @brief Process-wide span recorder
+ */
+class DecodeTrace {
+public:
+    static DecodeTrace& getInstance();
+
+    /**
+     * @brief Discard earlier spans and start recording
+     */
+    void start();
+
+    /**
+     * @brief Stop recording; recorded spans stay available to dump()
+     */
+    void stop();
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Record a completed span on the calling thread's buffer
+     */
+    void record(const TraceEvent& event);
+
+    /**
+     * @brief Write the spans recorded since start() as Chrome trace JSON
+     * @param path Output file
+     * @return true if the file was written, false otherwise
+     */
+    bool dump(const std::string& path);
+
+    /**
+     * @brief Get the number of spans dropped because a thread's buffer was full
+     */
+    uint64_t getDroppedEvents() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the steady clock time in nanoseconds
+     */
+    static uint64_t now();
+
+private:
+    DecodeTrace() = default;
+
+    // Disable copy constructor and assignment
+    DecodeTrace(const DecodeTrace&) = delete;
+    DecodeTrace& operator=(const DecodeTrace&) = delete;
+
+    /**
+     * @brief Spans of one thread; written only by the thread that holds it
+     */
+    struct ThreadBuffer {
+        std::unique_ptr<TraceEvent[]> events;
+        std::atomic<size_t> count{0};       // Published events of the current generation
+        std::atomic<uint64_t> generation{0}; // Trace session count belongs to
+        uint32_t threadIndex = 0;           // Chrome trace tid
+    };
+
+    /**
+     * @brief Calling thread's hold on a buffer; returns it to the free list on thread exit
+     */
+    struct ThreadBufferOwner {
+        ThreadBuffer* buffer = nullptr;
+        bool denied = false;                // No buffer was left for deniedGeneration
+        uint64_t deniedGeneration = 0;
+
+        ThreadBufferOwner() = default;
+        ~ThreadBufferOwner();
+
+        ThreadBufferOwner(const ThreadBufferOwner&) = delete;
+        ThreadBufferOwner& operator=(const ThreadBufferOwner&) = delete;
+    };
+
+    /**
+     * @brief Get the calling thread's buffer, taking a free or new one on its first span
+     * @return The buffer, or nullptr if kMaxThreadBuffers are held by other threads
+     */
+    ThreadBuffer* getThreadBuffer();
+
+    void releaseThreadBuffer(ThreadBuffer* buffer);
+
+    static thread_local ThreadBufferOwner threadOwner;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> generation{0};    // Bumped by start() to retire earlier spans
+    std::atomic<uint64_t> startNs{0};       // Steady clock time of start()
+    std::atomic<uint64_t> droppedEvents{0};
+
+    std::mutex controlMutex;                // Serializes start() and dump()
+    std::mutex bufferMutex;                 // Guards buffers
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // Never freed; exited threads' stay dumpable
+    std::vector<ThreadBuffer*> freeBuffers; // Buffers of exited threads, reused before allocating
+};
+
+/**
+ * @brief Scoped span; records on destruction if tracing was on when it began
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, uint32_t decoderId = 0, const char* codec = nullptr,
+                       int32_t size = 0)
+        : active(DecodeTrace::getInstance().isEnabled()) {
+        if (active) {
+            event = {name, codec, DecodeTrace::now(), 0, decoderId, size, 0};
+        }
+    }
+
+    ~TraceSpan() {
+        if (active) {
+            event.durationNs = DecodeTrace::now() - event.beginNs;
+            DecodeTrace::getInstance().record(event);
+        }
+    }
+
+    void setDecoder(uint32_t decoderId, const char* codec) {
+        event.decoderId = decoderId;
+        event.codec = codec;
+    }
+    void setSize(int32_t size) { event.size = size; }
+    void setResult(int32_t result) { event.result = result; }
+
+private:
+    bool active;
+    TraceEvent event{};
+
+    // Disable copy constructor and assignment
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+} // namespace ShadPS4::Audio
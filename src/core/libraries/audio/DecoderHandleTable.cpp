@@ -0,0 +1,166 @@
+/**
+ * @file DecoderHandleTable.cpp
+ * @brief Lock-free handle table for SCE audio decoder instances
+ * 
+ * This file implements handle allocation, lock-free lookup and deferred
+ * retirement of decoders used by the SCE audio decoder interface.
+ */
+
+#include "DecoderHandleTable.h"
+#include "DecoderPool.h"
+
+namespace ShadPS4::Audio {
+
+DecoderRef::~DecoderRef() {
+    release();
+}
+
+DecoderRef::DecoderRef(DecoderRef&& other) noexcept
+    : table(other.table)
+    , index(other.index)
+    , decoder(other.decoder) {
+    other.table = nullptr;
+    other.decoder = nullptr;
+}
+
+DecoderRef& DecoderRef::operator=(DecoderRef&& other) noexcept {
+    if (this != &other) {
+        release();
+        table = other.table;
+        index = other.index;
+        decoder = other.decoder;
+        other.table = nullptr;
+        other.decoder = nullptr;
+    }
+    return *this;
+}
+
+std::mutex& DecoderRef::instanceMutex() const {
+    return table->slots[index].instanceMutex;
+}
+
+void DecoderRef::release() {
+    if (table && decoder) {
+        table->releaseRef(index);
+    }
+    table = nullptr;
+    decoder = nullptr;
+}
+
+DecoderHandleTable::DecoderHandleTable()
+    : slots(std::make_unique<Slot[]>(kMaxSlots)) {
+}
+
+DecoderHandleTable::~DecoderHandleTable() {
+    // Remaining decoders are destroyed directly; no calls can be in flight here
+    for (uint32_t i = 0; i < usedSlots; ++i) {
+        delete slots[i].decoder;
+        slots[i].decoder = nullptr;
+    }
+}
+
+int DecoderHandleTable::insert(std::unique_ptr<OrbisAudioDecoder>& decoder) {
+    if (!decoder) {
+        return 0;
+    }
+
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(freeListMutex);
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else if (usedSlots < kMaxSlots) {
+            index = usedSlots++;
+        } else {
+            return 0;
+        }
+    }
+
+    Slot& slot = slots[index];
+    uint32_t generation = generationOf(slot.state.load(std::memory_order_relaxed));
+    slot.decoder = decoder.release();
+
+    // Publish: the decoder pointer becomes visible with the live bit
+    slot.state.store((static_cast<uint64_t>(generation) << 32) | kLiveBit,
+                     std::memory_order_release);
+
+    return static_cast<int>(((generation & kGenerationMask) << kIndexBits) | index);
+}
+
+DecoderRef DecoderHandleTable::acquire(int handle) {
+    if (handle <= 0) {
+        return {};
+    }
+
+    uint32_t index = static_cast<uint32_t>(handle) & (kMaxSlots - 1);
+    uint32_t generation = static_cast<uint32_t>(handle) >> kIndexBits;
+    Slot& slot = slots[index];
+
+    uint64_t state = slot.state.load(std::memory_order_acquire);
+    while (true) {
+        if ((generationOf(state) & kGenerationMask) != generation || !(state & kLiveBit)) {
+            return {};
+        }
+        if (slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            return DecoderRef(this, index, slot.decoder);
+        }
+    }
+}
+
+bool DecoderHandleTable::remove(int handle) {
+    if (handle <= 0) {
+        return false;
+    }
+
+    uint32_t index = static_cast<uint32_t>(handle) & (kMaxSlots - 1);
+    uint32_t generation = static_cast<uint32_t>(handle) >> kIndexBits;
+    Slot& slot = slots[index];
+
+    uint64_t state = slot.state.load(std::memory_order_acquire);
+    while (true) {
+        if ((generationOf(state) & kGenerationMask) != generation || !(state & kLiveBit)) {
+            return false;
+        }
+        if (slot.state.compare_exchange_weak(state, state & ~kLiveBit, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            break;
+        }
+    }
+
+    // No references outstanding: retire now, otherwise the last reference does it
+    if ((state & kRefMask) == 0) {
+        retire(index);
+    }
+    return true;
+}
+
+void DecoderHandleTable::releaseRef(uint32_t index) {
+    uint64_t previous = slots[index].state.fetch_sub(1, std::memory_order_acq_rel);
+    if ((previous & kRefMask) == 1 && !(previous & kLiveBit)) {
+        retire(index);
+    }
+}
+
+void DecoderHandleTable::retire(uint32_t index) {
+    Slot& slot = slots[index];
+    std::unique_ptr<OrbisAudioDecoder> decoder(slot.decoder);
+    slot.decoder = nullptr;
+
+    // Bump the generation so any handle to the old decoder stays invalid
+    uint32_t generation = generationOf(slot.state.load(std::memory_order_relaxed)) + 1;
+    if ((generation & kGenerationMask) == 0) {
+        ++generation; // Never hand out handle 0
+    }
+    slot.state.store(static_cast<uint64_t>(generation) << 32, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(freeListMutex);
+        freeSlots.push_back(index);
+    }
+
+    DecoderPool::getInstance().release(std::move(decoder));
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,130 @@
+#pragma once
+
+/**
+ * @file DecoderHandleTable.h
+ * @brief Lock-free handle table for SCE audio decoder instances
+ * 
+ * Decoders are stored in a fixed slot array. A handle encodes the slot index
+ * together with the slot's generation, so lookups are O(1) without a global
+ * mutex and stale handles to deleted decoders are rejected. Each slot carries
+ * a reference count: a deleted decoder is only retired once the last
+ * in-flight call using it has finished.
+ */
+
+#include "OrbisAudioDecoder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+class DecoderHandleTable;
+
+/**
+ * @brief Scoped reference to a live decoder
+ * 
+ * Keeps the decoder alive for as long as the reference exists. Use lock()
+ * to serialize operations on the same decoder across threads.
+ */
+class DecoderRef {
+public:
+    DecoderRef() = default;
+    ~DecoderRef();
+
+    DecoderRef(DecoderRef&& other) noexcept;
+    DecoderRef& operator=(DecoderRef&& other) noexcept;
+
+    explicit operator bool() const { return decoder != nullptr; }
+    OrbisAudioDecoder* operator->() const { return decoder; }
+    OrbisAudioDecoder& operator*() const { return *decoder; }
+    OrbisAudioDecoder* get() const { return decoder; }
+
+    /**
+     * @brief Get the per-instance mutex of the referenced decoder
+     */
+    std::mutex& instanceMutex() const;
+
+private:
+    friend class DecoderHandleTable;
+
+    DecoderRef(DecoderHandleTable* table, uint32_t index, OrbisAudioDecoder* decoder)
+        : table(table), index(index), decoder(decoder) {}
+
+    void release();
+
+    DecoderHandleTable* table = nullptr;
+    uint32_t index = 0;
+    OrbisAudioDecoder* decoder = nullptr;
+
+    // Disable copy constructor and assignment operator
+    DecoderRef(const DecoderRef&) = delete;
+    DecoderRef& operator=(const DecoderRef&) = delete;
+};
+
+/**
+ * @brief Slot array mapping generation-tagged handles to decoders
+ */
+class DecoderHandleTable {
+public:
+    static constexpr uint32_t kIndexBits = 12;
+    static constexpr uint32_t kMaxSlots = 1u << kIndexBits;          // 4096 live decoders
+    static constexpr uint32_t kGenerationMask = 0x7FFFF;             // Keeps handles positive
+
+    DecoderHandleTable();
+    ~DecoderHandleTable();
+
+    /**
+     * @brief Insert a decoder and return its handle
+     * @param decoder Initialized decoder; ownership moves to the table on success
+     * @return Positive handle on success, 0 if the table is full
+     */
+    int insert(std::unique_ptr<OrbisAudioDecoder>& decoder);
+
+    /**
+     * @brief Look up a decoder by handle
+     * @return Reference to the decoder, empty if the handle is stale or invalid
+     */
+    DecoderRef acquire(int handle);
+
+    /**
+     * @brief Remove a decoder
+     * 
+     * The handle becomes invalid immediately. The decoder itself is returned
+     * to the DecoderPool once no call holds a reference to it anymore.
+     * 
+     * @return true if the handle referred to a live decoder
+     */
+    bool remove(int handle);
+
+private:
+    friend class DecoderRef;
+
+    // Slot state layout: [63:32] generation, [31] live flag, [30:0] reference count
+    static constexpr uint64_t kLiveBit = 1ull << 31;
+    static constexpr uint64_t kRefMask = kLiveBit - 1;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> state{1ull << 32};
+        OrbisAudioDecoder* decoder = nullptr;
+        std::mutex instanceMutex;
+    };
+
+    static uint32_t generationOf(uint64_t state) { return static_cast<uint32_t>(state >> 32); }
+
+    void releaseRef(uint32_t index);
+    void retire(uint32_t index);
+
+    std::unique_ptr<Slot[]> slots;
+    std::vector<uint32_t> freeSlots;    // Only touched on insert and retire
+    uint32_t usedSlots = 0;
+    std::mutex freeListMutex;
+
+    // Disable copy constructor and assignment operator
+    DecoderHandleTable(const DecoderHandleTable&) = delete;
+    DecoderHandleTable& operator=(const DecoderHandleTable&) = delete;
+};
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,220 @@
+/**
+ * @file DecoderPool.cpp
+ * @brief Pool of pre-opened FFmpeg decoders for ShadPS4
+ * 
+ * This file implements the decoder pool used to hand out independent,
+ * already-initialized decoders to audio streams.
+ */
+
+#include "DecoderPool.h"
+#include "common/logging/log.h"
+#include <algorithm>
+#include <iterator>
+
+namespace ShadPS4::Audio {
+
+DecoderPool& DecoderPool::getInstance() {
+    static DecoderPool instance;
+    return instance;
+}
+
+DecoderPoolKey DecoderPool::makeKey(AVCodecID codecId, int sampleRate, int channels,
+                                   AVSampleFormat outputFormat, const uint8_t* codecConfig,
+                                   int codecConfigSize, int targetSampleRate,
+                                   ResamplePreset resamplePreset,
+                                   const ChannelMatrix& channelMatrix) {
+    DecoderPoolKey key{codecId, sampleRate, channels, outputFormat, {}, targetSampleRate,
+                       resamplePreset, channelMatrix};
+    if (codecConfig && codecConfigSize > 0) {
+        key.codecConfig.assign(codecConfig, codecConfig + codecConfigSize);
+    }
+    return key;
+}
+
+std::unique_ptr<OrbisAudioDecoder> DecoderPool::openDecoder(const DecoderPoolKey& key) {
+    auto decoder = std::make_unique<OrbisAudioDecoder>();
+    if (!decoder->initialize(key.codecId, key.sampleRate, key.channels, key.outputFormat,
+                             key.codecConfig.data(), static_cast<int>(key.codecConfig.size()),
+                             key.targetSampleRate, key.resamplePreset, key.channelMatrix)) {
+        LOG_ERROR("DecoderPool", "Error: Failed to open decoder for codec %d (%d Hz, %d ch, format %d)",
+            static_cast<int>(key.codecId), key.sampleRate, key.channels,
+            static_cast<int>(key.outputFormat));
+        return nullptr;
+    }
+    return decoder;
+}
+
+int DecoderPool::prewarm(AVCodecID codecId, int sampleRate, int channels, int count,
+                         AVSampleFormat outputFormat, const uint8_t* codecConfig,
+                         int codecConfigSize, int targetSampleRate,
+                         ResamplePreset resamplePreset, const ChannelMatrix& channelMatrix) {
+    DecoderPoolKey key = makeKey(codecId, sampleRate, channels, outputFormat, codecConfig,
+                                 codecConfigSize, targetSampleRate, resamplePreset, channelMatrix);
+
+    size_t existing = 0;
+    size_t limit = 0;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = idleDecoders.find(key);
+        existing = (it != idleDecoders.end()) ? it->second.decoders.size() : 0;
+        limit = std::min(maxIdlePerKey, maxIdleTotal);
+    }
+
+    size_t target = std::min(static_cast<size_t>(count > 0 ? count : 0), limit);
+    if (existing >= target) {
+        return 0;
+    }
+
+    // Open decoders outside the lock; this is the expensive part
+    std::vector<std::unique_ptr<OrbisAudioDecoder>> opened;
+    opened.reserve(target - existing);
+    for (size_t i = existing; i < target; ++i) {
+        auto decoder = openDecoder(key);
+        if (!decoder) {
+            break;
+        }
+        opened.push_back(std::move(decoder));
+    }
+
+    int added = 0;
+    std::vector<std::unique_ptr<OrbisAudioDecoder>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        IdleList& idle = idleDecoders[key];
+        idle.lastUsed = ++useClock;
+        for (auto& decoder : opened) {
+            if (idle.decoders.size() >= maxIdlePerKey) {
+                break;
+            }
+            idle.decoders.push_back(std::move(decoder));
+            ++idleCount;
+            ++added;
+        }
+        if (idle.decoders.empty()) {
+            idleDecoders.erase(key);
+        }
+        evictIdle(evicted);
+    }
+
+    LOG_INFO("DecoderPool", "Prewarmed %d decoders for codec %d (%d Hz, %d ch)",
+        added, static_cast<int>(codecId), sampleRate, channels);
+    return added;
+}
+
+std::unique_ptr<OrbisAudioDecoder> DecoderPool::acquire(AVCodecID codecId, int sampleRate, int channels,
+                                                     AVSampleFormat outputFormat,
+                                                     const uint8_t* codecConfig,
+                                                     int codecConfigSize, int targetSampleRate,
+                                                     ResamplePreset resamplePreset,
+                                                     const ChannelMatrix& channelMatrix) {
+    DecoderPoolKey key = makeKey(codecId, sampleRate, channels, outputFormat, codecConfig,
+                                 codecConfigSize, targetSampleRate, resamplePreset, channelMatrix);
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = idleDecoders.find(key);
+        if (it != idleDecoders.end()) {
+            std::unique_ptr<OrbisAudioDecoder> decoder = std::move(it->second.decoders.back());
+            it->second.decoders.pop_back();
+            --idleCount;
+            if (it->second.decoders.empty()) {
+                idleDecoders.erase(it);
+            } else {
+                it->second.lastUsed = ++useClock;
+            }
+            return decoder;
+        }
+    }
+
+    // Pool miss: open a fresh decoder
+    return openDecoder(key);
+}
+
+void DecoderPool::release(std::unique_ptr<OrbisAudioDecoder> decoder) {
+    if (!decoder || !decoder->isDecoderInitialized()) {
+        return;
+    }
+
+    // Flush codec state and counters so the next stream starts clean
+    if (!decoder->reset()) {
+        return;
+    }
+    decoder->getStats().reset();
+
+    DecoderPoolKey key{decoder->getCodecId(), decoder->getConfiguredSampleRate(),
+                       decoder->getConfiguredChannels(), decoder->getOutputSampleFormat(),
+                       decoder->getCodecConfig(), decoder->getTargetSampleRate(),
+                       decoder->getResamplePreset(), decoder->getChannelMatrix()};
+
+    // Declared before the lock: decoders dropped here are destroyed after it is released
+    std::vector<std::unique_ptr<OrbisAudioDecoder>> evicted;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (maxIdlePerKey == 0 || maxIdleTotal == 0) {
+        return;
+    }
+    IdleList& idle = idleDecoders[key];
+    idle.lastUsed = ++useClock;
+    if (idle.decoders.size() < maxIdlePerKey) {
+        idle.decoders.push_back(std::move(decoder));
+        ++idleCount;
+        evictIdle(evicted);
+    }
+    // Otherwise the decoder is destroyed when it goes out of scope
+}
+
+void DecoderPool::evictIdle(std::vector<std::unique_ptr<OrbisAudioDecoder>>& evicted) {
+    while (idleCount > maxIdleTotal) {
+        // Keys are few (at most maxIdleTotal hold decoders), so a scan beats keeping an LRU list
+        auto oldest = idleDecoders.begin();
+        for (auto it = idleDecoders.begin(); it != idleDecoders.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        evicted.push_back(std::move(oldest->second.decoders.back()));
+        oldest->second.decoders.pop_back();
+        --idleCount;
+        if (oldest->second.decoders.empty()) {
+            idleDecoders.erase(oldest);
+        }
+    }
+}
+
+void DecoderPool::setMaxIdlePerKey(size_t maxIdle) {
+    std::vector<std::unique_ptr<OrbisAudioDecoder>> evicted;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    maxIdlePerKey = maxIdle;
+    for (auto it = idleDecoders.begin(); it != idleDecoders.end();) {
+        auto& decoders = it->second.decoders;
+        while (decoders.size() > maxIdlePerKey) {
+            evicted.push_back(std::move(decoders.back()));
+            decoders.pop_back();
+            --idleCount;
+        }
+        it = decoders.empty() ? idleDecoders.erase(it) : std::next(it);
+    }
+}
+
+void DecoderPool::setMaxIdleTotal(size_t maxIdle) {
+    std::vector<std::unique_ptr<OrbisAudioDecoder>> evicted;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    maxIdleTotal = maxIdle;
+    evictIdle(evicted);
+}
+
+size_t DecoderPool::getIdleCount() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return idleCount;
+}
+
+void DecoderPool::clear() {
+    IdleMap released;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        released.swap(idleDecoders);
+        idleCount = 0;
+    }
+    // Decoders are destroyed here, outside the lock
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,188 @@
+#pragma once
+
+/**
+ * @file DecoderPool.h
+ * @brief Pool of pre-opened FFmpeg decoders for ShadPS4
+ * 
+ * Opening a decoder (avcodec_find_decoder + avcodec_open2 + swr_init) costs
+ * milliseconds. The pool keeps idle, already-initialized OrbisAudioDecoder
+ * instances keyed by their full configuration (codec, sample rate, channels,
+ * output format, codec config, output rate, channel matrix) so that creating
+ * a new audio stream is a pop from the pool instead of a full codec setup.
+ *
+ * Idle decoders are bounded per key and in total. Past the total limit the
+ * key used least recently gives up a decoder, so a process that streams many
+ * distinct configurations (e.g. a bulk decode of an asset dump) keeps only
+ * the recent ones open.
+ */
+
+#include "OrbisAudioDecoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Key identifying interchangeable decoder instances
+ */
+struct DecoderPoolKey {
+    AVCodecID codecId;          // FFmpeg codec ID
+    int sampleRate;             // Sample rate in Hz
+    int channels;               // Number of channels
+    AVSampleFormat outputFormat; // PCM format written by the decoder
+    std::vector<uint8_t> codecConfig; // Codec setup data (empty for most AAC streams)
+    int targetSampleRate;       // Output rate, or 0 for the stream's own rate
+    ResamplePreset resamplePreset; // Resampling quality when targetSampleRate is set
+    ChannelMatrix channelMatrix;   // Output remap/downmix
+
+    bool operator==(const DecoderPoolKey& other) const {
+        return codecId == other.codecId && sampleRate == other.sampleRate &&
+               channels == other.channels && outputFormat == other.outputFormat &&
+               codecConfig == other.codecConfig && targetSampleRate == other.targetSampleRate &&
+               resamplePreset == other.resamplePreset && channelMatrix == other.channelMatrix;
+    }
+};
+
+/**
+ * @brief Hash functor for DecoderPoolKey
+ */
+struct DecoderPoolKeyHash {
+    size_t operator()(const DecoderPoolKey& key) const {
+        uint64_t packed = (static_cast<uint64_t>(key.codecId) << 32) ^
+                          (static_cast<uint64_t>(key.sampleRate) << 8) ^
+                          static_cast<uint64_t>(key.channels) ^
+                          (static_cast<uint64_t>(key.outputFormat) << 56) ^
+                          (static_cast<uint64_t>(key.targetSampleRate) << 12) ^
+                          (static_cast<uint64_t>(key.resamplePreset) << 48);
+        for (uint8_t byte : key.codecConfig) {
+            packed = (packed ^ byte) * 0x100000001b3ULL;
+        }
+        packed ^= key.channelMatrix.getHash();
+        return std::hash<uint64_t>()(packed);
+    }
+};
+
+/**
+ * @brief Process-wide pool of initialized OrbisAudioDecoder instances
+ * 
+ * Decoders handed out by acquire() are owned exclusively by the caller.
+ * Returning them through release() flushes their codec state and makes
+ * them available to the next stream with the same configuration.
+ */
+class DecoderPool {
+public:
+    static DecoderPool& getInstance();
+
+    /**
+     * @brief Open decoders ahead of time for a configuration
+     * @param codecId FFmpeg codec ID
+     * @param sampleRate Sample rate in Hz
+     * @param channels Number of audio channels
+     * @param count Number of idle decoders the pool should hold for this key
+     * @param outputFormat PCM format the decoders write
+     * @param codecConfig Codec setup data (see OrbisAudioDecoder::initialize)
+     * @param codecConfigSize Size of codecConfig in bytes
+     * @param targetSampleRate Output sample rate, or 0 to keep the stream's rate
+     * @param resamplePreset Resampling quality used with targetSampleRate
+     * @param channelMatrix Output remap/downmix (see OrbisAudioDecoder::initialize)
+     * @return Number of decoders newly opened
+     */
+    int prewarm(AVCodecID codecId, int sampleRate, int channels, int count,
+                AVSampleFormat outputFormat = AV_SAMPLE_FMT_S16,
+                const uint8_t* codecConfig = nullptr, int codecConfigSize = 0,
+                int targetSampleRate = 0,
+                ResamplePreset resamplePreset = ResamplePreset::Balanced,
+                const ChannelMatrix& channelMatrix = ChannelMatrix());
+
+    /**
+     * @brief Take an initialized decoder from the pool
+     * 
+     * Falls back to opening a new decoder when no idle one is available.
+     * 
+     * @return Initialized decoder, or nullptr if initialization failed
+     */
+    std::unique_ptr<OrbisAudioDecoder> acquire(AVCodecID codecId, int sampleRate, int channels,
+                                               AVSampleFormat outputFormat = AV_SAMPLE_FMT_S16,
+                                               const uint8_t* codecConfig = nullptr,
+                                               int codecConfigSize = 0,
+                                               int targetSampleRate = 0,
+                                               ResamplePreset resamplePreset = ResamplePreset::Balanced,
+                                               const ChannelMatrix& channelMatrix = ChannelMatrix());
+
+    /**
+     * @brief Return a decoder to the pool
+     * 
+     * The decoder is reset before it becomes idle. Decoders beyond the
+     * per-key idle limit, or that fail to reset, are destroyed.
+     * 
+     * @param decoder Decoder previously obtained from acquire()
+     */
+    void release(std::unique_ptr<OrbisAudioDecoder> decoder);
+
+    /**
+     * @brief Set the maximum number of idle decoders kept per key
+     */
+    void setMaxIdlePerKey(size_t maxIdle);
+
+    /**
+     * @brief Set the maximum number of idle decoders kept across all keys
+     *
+     * Beyond it, idle decoders of the least recently used keys are destroyed.
+     */
+    void setMaxIdleTotal(size_t maxIdle);
+
+    /**
+     * @brief Get the number of idle decoders across all keys
+     */
+    size_t getIdleCount() const;
+
+    /**
+     * @brief Destroy all idle decoders
+     */
+    void clear();
+
+private:
+    DecoderPool() = default;
+    ~DecoderPool() = default;
+
+    // Disable copy constructor and assignment
+    DecoderPool(const DecoderPool&) = delete;
+    DecoderPool& operator=(const DecoderPool&) = delete;
+
+    /**
+     * @brief Idle decoders of one key
+     */
+    struct IdleList {
+        std::vector<std::unique_ptr<OrbisAudioDecoder>> decoders;
+        uint64_t lastUsed = 0;      // useClock value of the last acquire or release
+    };
+
+    using IdleMap = std::unordered_map<DecoderPoolKey, IdleList, DecoderPoolKeyHash>;
+
+    /**
+     * @brief Move idle decoders beyond maxIdleTotal out of the pool, least recently used key first
+     * @param evicted Receives the decoders, so they are destroyed after the lock is released
+     */
+    void evictIdle(std::vector<std::unique_ptr<OrbisAudioDecoder>>& evicted);
+
+    static std::unique_ptr<OrbisAudioDecoder> openDecoder(const DecoderPoolKey& key);
+    static DecoderPoolKey makeKey(AVCodecID codecId, int sampleRate, int channels,
+                                  AVSampleFormat outputFormat, const uint8_t* codecConfig,
+                                  int codecConfigSize, int targetSampleRate,
+                                  ResamplePreset resamplePreset,
+                                  const ChannelMatrix& channelMatrix);
+
+    IdleMap idleDecoders;           // Keys without idle decoders are erased
+    size_t idleCount = 0;           // Idle decoders across all keys
+    size_t maxIdlePerKey = 32;
+    size_t maxIdleTotal = 64;
+    uint64_t useClock = 0;          // Bumped on every acquire and release
+    mutable std::mutex poolMutex;
+};
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,81 @@
+/**
+ * @file DecoderStats.cpp
+ * @brief Per-decoder performance counters for ShadPS4
+ *
+ * This file implements the relaxed-atomic counters and decode-time histogram
+ * kept by every OrbisAudioDecoder.
+ */
+
+#include "DecoderStats.h"
+
+#include <bit>
+
+namespace ShadPS4::Audio {
+
+int DecoderStats::getHistogramBucket(uint64_t elapsedNs) {
+    if (elapsedNs == 0) {
+        return 0;
+    }
+    int bucket = static_cast<int>(std::bit_width(elapsedNs)) - 1;
+    return bucket < kDecodeTimeBuckets ? bucket : kDecodeTimeBuckets - 1;
+}
+
+void DecoderStats::recordPacket(uint64_t packetInputBytes, uint64_t packetOutputBytes,
+                                uint32_t packetFrames, uint64_t elapsedNs, bool starved) {
+    packets.fetch_add(1, std::memory_order_relaxed);
+    frames.fetch_add(packetFrames, std::memory_order_relaxed);
+    inputBytes.fetch_add(packetInputBytes, std::memory_order_relaxed);
+    outputBytes.fetch_add(packetOutputBytes, std::memory_order_relaxed);
+    if (starved) {
+        eagainCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    decodeTimeTotalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    decodeTimeHistogram[getHistogramBucket(elapsedNs)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t currentMax = decodeTimeMaxNs.load(std::memory_order_relaxed);
+    while (elapsedNs > currentMax &&
+           !decodeTimeMaxNs.compare_exchange_weak(currentMax, elapsedNs, std::memory_order_relaxed)) {
+    }
+}
+
+void DecoderStats::recordError(DecodeErrorKind kind) {
+    int index = static_cast<int>(kind);
+    if (index > 0 && index < kDecodeErrorKinds) {
+        errors[index].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DecoderStats::snapshot(DecoderStatsSnapshot& out) const {
+    out.packets = packets.load(std::memory_order_relaxed);
+    out.frames = frames.load(std::memory_order_relaxed);
+    out.inputBytes = inputBytes.load(std::memory_order_relaxed);
+    out.outputBytes = outputBytes.load(std::memory_order_relaxed);
+    out.eagainCount = eagainCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < kDecodeErrorKinds; ++i) {
+        out.errors[i] = errors[i].load(std::memory_order_relaxed);
+    }
+    out.decodeTimeTotalNs = decodeTimeTotalNs.load(std::memory_order_relaxed);
+    out.decodeTimeMaxNs = decodeTimeMaxNs.load(std::memory_order_relaxed);
+    for (int i = 0; i < kDecodeTimeBuckets; ++i) {
+        out.decodeTimeHistogram[i] = decodeTimeHistogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+void DecoderStats::reset() {
+    packets.store(0, std::memory_order_relaxed);
+    frames.store(0, std::memory_order_relaxed);
+    inputBytes.store(0, std::memory_order_relaxed);
+    outputBytes.store(0, std::memory_order_relaxed);
+    eagainCount.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t>& counter : errors) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    decodeTimeTotalNs.store(0, std::memory_order_relaxed);
+    decodeTimeMaxNs.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t>& counter : decodeTimeHistogram) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * @file DecoderStats.h
+ * @brief Per-decoder performance counters for ShadPS4
+ *
+ * Every OrbisAudioDecoder keeps packet, frame and byte counters, error counts
+ * by kind and a log2-bucketed histogram of decode times. All updates are
+ * relaxed atomics so the counters stay enabled in release builds; a snapshot
+ * is consistent per counter, not across counters.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Decode failure kinds (same values as -DecodeResult in the plugin interface)
+ */
+enum class DecodeErrorKind : int {
+    InvalidInput = 1,           // Invalid input data or parameters
+    InsufficientBuffer = 2,     // Output buffer too small
+    CodecFailure = 3,           // Codec-specific error
+    NotInitialized = 4,         // Decoder not initialized
+    EndOfStream = 5             // End of audio stream reached
+};
+
+constexpr int kDecodeErrorKinds = 6;    // Index 0 (success) is unused
+constexpr int kDecodeTimeBuckets = 32;  // Up to 2^32 ns (about 4 s)
+
+/**
+ * @brief Point-in-time copy of a decoder's counters
+ */
+struct DecoderStatsSnapshot {
+    uint64_t packets;                   // Packets handed to the codec
+    uint64_t frames;                    // Frames produced by the codec
+    uint64_t inputBytes;                // Compressed bytes consumed
+    uint64_t outputBytes;               // PCM bytes written
+    uint64_t eagainCount;               // Packets that produced no frame (codec wanted more input)
+    uint64_t errors[kDecodeErrorKinds]; // Failures indexed by DecodeErrorKind
+    uint64_t decodeTimeTotalNs;         // Sum of per-packet decode times
+    uint64_t decodeTimeMaxNs;           // Slowest single packet
+    uint64_t decodeTimeHistogram[kDecodeTimeBuckets]; // Bucket i: [2^i, 2^(i+1)) ns; bucket 0 also holds 0 ns
+};
+
+/**
+ * @brief Lock-free decoder counters
+ */
+class DecoderStats {
+public:
+    DecoderStats() { reset(); }
+
+    /**
+     * @brief Record one packet that reached the codec
+     * @param inputBytes Compressed packet size
+     * @param outputBytes PCM bytes written for the packet
+     * @param frames Frames the codec produced for the packet
+     * @param elapsedNs Time spent decoding the packet
+     * @param starved Codec returned EAGAIN before producing any frame
+     */
+    void recordPacket(uint64_t inputBytes, uint64_t outputBytes, uint32_t frames, uint64_t elapsedNs,
+                      bool starved);
+
+    /**
+     * @brief Record a failed decode call
+     */
+    void recordError(DecodeErrorKind kind);
+
+    /**
+     * @brief Copy all counters
+     */
+    void snapshot(DecoderStatsSnapshot& out) const;
+
+    /**
+     * @brief Zero all counters
+     */
+    void reset();
+
+    /**
+     * @brief Get the histogram bucket for a decode time
+     */
+    static int getHistogramBucket(uint64_t elapsedNs);
+
+private:
+    std::atomic<uint64_t> packets;
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> inputBytes;
+    std::atomic<uint64_t> outputBytes;
+    std::atomic<uint64_t> eagainCount;
+    std::atomic<uint64_t> errors[kDecodeErrorKinds];
+    std::atomic<uint64_t> decodeTimeTotalNs;
+    std::atomic<uint64_t> decodeTimeMaxNs;
+    std::atomic<uint64_t> decodeTimeHistogram[kDecodeTimeBuckets];
+
+    // Disable copy constructor and assignment
+    DecoderStats(const DecoderStats&) = delete;
+    DecoderStats& operator=(const DecoderStats&) = delete;
+};
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,123 @@
+/**
+ * @file FramePool.cpp
+ * @brief Pooled frame buffers for FFmpeg decoders in ShadPS4
+ *
+ * This file implements the get_buffer2 callback that carves a frame's
+ * planes out of one pooled block.
+ */
+
+extern "C" {
+    #include <libavutil/samplefmt.h>
+}
+
+#include "FramePool.h"
+#include "AllocCounter.h"
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Plane alignment FFmpeg's SIMD code may assume (AVX-512)
+constexpr size_t kPlaneAlignment = 64;
+
+// Decoded formats are at most 32 bits per sample before the stream's format is known
+constexpr int kMaxBytesPerSample = 4;
+
+size_t getPlaneSize(int samples, int bytesPerSample, int interleavedChannels) {
+    // FFmpeg's own allocator leaves slack after each plane; keep the same headroom
+    const size_t bytes = static_cast<size_t>(samples) * bytesPerSample * interleavedChannels + kPlaneAlignment;
+    return (bytes + kPlaneAlignment - 1) & ~(kPlaneAlignment - 1);
+}
+
+} // namespace
+
+FramePool::FramePool()
+    : pool(nullptr)
+    , blockSize(0) {
+}
+
+FramePool::~FramePool() {
+    reset();
+}
+
+bool FramePool::attach(AVCodecContext* context, int channels, int frameSamples) {
+    if (!context || !context->codec || !(context->codec->capabilities & AV_CODEC_CAP_DR1) ||
+        channels <= 0 || channels > AV_NUM_DATA_POINTERS || frameSamples <= 0) {
+        return false;
+    }
+
+    // Size the pool up front so the first frame does not have to grow it
+    if (!ensureBlockSize(getPlaneSize(frameSamples, kMaxBytesPerSample, 1) * channels)) {
+        return false;
+    }
+
+    context->opaque = this;
+    context->get_buffer2 = &FramePool::getBuffer;
+    return true;
+}
+
+int FramePool::getBuffer(AVCodecContext* context, AVFrame* frame, int flags) {
+    FramePool* self = static_cast<FramePool*>(context->opaque);
+    const int channels = frame->channels;
+    const AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+    const int bytesPerSample = av_get_bytes_per_sample(format);
+    if (!self || channels <= 0 || channels > AV_NUM_DATA_POINTERS || frame->nb_samples <= 0 ||
+        bytesPerSample <= 0) {
+        return avcodec_default_get_buffer2(context, frame, flags);
+    }
+
+    const bool planar = av_sample_fmt_is_planar(format);
+    const int planes = planar ? channels : 1;
+    const size_t planeSize = getPlaneSize(frame->nb_samples, bytesPerSample, planar ? 1 : channels);
+    if (!self->ensureBlockSize(planeSize * planes)) {
+        return AVERROR(ENOMEM);
+    }
+
+    frame->buf[0] = av_buffer_pool_get(self->pool);
+    if (!frame->buf[0]) {
+        return AVERROR(ENOMEM);
+    }
+
+    // One block covers every plane, so buf[0] is the frame's only reference
+    for (int plane = 0; plane < planes; ++plane) {
+        frame->data[plane] = frame->buf[0]->data + plane * planeSize;
+    }
+    frame->extended_data = frame->data;
+    frame->linesize[0] = static_cast<int>(planeSize);
+    return 0;
+}
+
+AVBufferRef* FramePool::allocBlock(void* /*opaque*/, size_t size) {
+    AllocCounter::record();
+    return av_buffer_alloc(size);
+}
+
+bool FramePool::ensureBlockSize(size_t required) {
+    if (pool && required <= blockSize) {
+        return true;
+    }
+
+    size_t newSize = blockSize ? blockSize : kPlaneAlignment;
+    while (newSize < required) {
+        newSize *= 2;
+    }
+
+    // Frames from the old pool stay valid until the caller releases them
+    reset();
+    pool = av_buffer_pool_init2(newSize, nullptr, &FramePool::allocBlock, nullptr);
+    if (!pool) {
+        return false;
+    }
+    blockSize = newSize;
+    return true;
+}
+
+void FramePool::reset() {
+    if (pool) {
+        av_buffer_pool_uninit(&pool);
+        pool = nullptr;
+    }
+    blockSize = 0;
+}
+
+} // namespace ShadPS4::Audio
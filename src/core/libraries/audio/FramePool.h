@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file FramePool.h
+ * @brief Pooled frame buffers for FFmpeg decoders in ShadPS4
+ *
+ * FFmpeg's default get_buffer2 keeps its own pools, but sizes and rebuilds
+ * them per codec context and allocates one buffer per plane. The frame pool
+ * hands the codec one block per frame from a per-decoder AVBufferPool sized
+ * from the stream configuration, with every plane of the frame carved out
+ * of that block, so once the first frames are decoded no frame data is
+ * allocated again.
+ */
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <cstddef>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Per-decoder pool of frame data blocks, installed as get_buffer2
+ */
+class FramePool {
+public:
+    FramePool();
+    ~FramePool();
+
+    /**
+     * @brief Install the pool as the context's frame allocator
+     *
+     * Must be called before avcodec_open2(). Codecs without
+     * AV_CODEC_CAP_DR1 keep FFmpeg's allocator.
+     *
+     * @param context Codec context; its opaque field is taken over
+     * @param channels Channel count of the stream
+     * @param frameSamples Largest frame the codec is expected to produce
+     * @return true if the pool was installed, false otherwise
+     */
+    bool attach(AVCodecContext* context, int channels, int frameSamples);
+
+    /**
+     * @brief Release the pool; outstanding frames stay valid until unreferenced
+     */
+    void reset();
+
+    /**
+     * @brief Get the current block size in bytes
+     */
+    size_t getBlockSize() const { return blockSize; }
+
+private:
+    static int getBuffer(AVCodecContext* context, AVFrame* frame, int flags);
+    static AVBufferRef* allocBlock(void* opaque, size_t size);
+
+    bool ensureBlockSize(size_t required);
+
+    AVBufferPool* pool;         // Pool of frame blocks
+    size_t blockSize;           // Size of each block
+
+    // Disable copy constructor and assignment operator
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+};
+
+} // namespace ShadPS4::Audio
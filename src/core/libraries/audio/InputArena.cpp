@@ -0,0 +1,98 @@
+/**
+ * @file InputArena.cpp
+ * @brief Padded input staging for FFmpeg packets in ShadPS4
+ * 
+ * This file implements the pooled copy path and the zero-copy wrapping path
+ * used to hand packets to the codec with the padding FFmpeg requires.
+ */
+
+#include "InputArena.h"
+#include "AllocCounter.h"
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Smallest pooled block; typical AAC access units are well below this
+constexpr size_t kMinBlockSize = 4096;
+
+// Caller-owned memory is never freed by FFmpeg
+void releaseCallerMemory(void* /*opaque*/, uint8_t* /*data*/) {
+}
+
+// Pool blocks are the only input memory allocated per stream; count them
+AVBufferRef* allocBlock(void* /*opaque*/, size_t size) {
+    AllocCounter::record();
+    return av_buffer_alloc(size);
+}
+
+} // namespace
+
+InputArena::InputArena()
+    : pool(nullptr)
+    , blockSize(0) {
+}
+
+InputArena::~InputArena() {
+    reset();
+}
+
+bool InputArena::ensureBlockSize(size_t required) {
+    if (pool && required <= blockSize) {
+        return true;
+    }
+
+    size_t newSize = blockSize ? blockSize : kMinBlockSize;
+    while (newSize < required) {
+        newSize *= 2;
+    }
+
+    // Buffers from the old pool stay valid until the codec releases them
+    reset();
+    pool = av_buffer_pool_init2(newSize, nullptr, allocBlock, nullptr);
+    if (!pool) {
+        return false;
+    }
+    blockSize = newSize;
+    return true;
+}
+
+int InputArena::stage(AVPacket* packet, const uint8_t* data, int size, InputMode mode) {
+    av_packet_unref(packet);
+
+    if (mode == InputMode::ZeroCopy) {
+        // The padding belongs to the caller's allocation, so it is part of the buffer
+        packet->buf = av_buffer_create(const_cast<uint8_t*>(data),
+                                       static_cast<size_t>(size) + AV_INPUT_BUFFER_PADDING_SIZE,
+                                       releaseCallerMemory, nullptr, AV_BUFFER_FLAG_READONLY);
+        if (!packet->buf) {
+            return AVERROR(ENOMEM);
+        }
+    } else {
+        if (!ensureBlockSize(static_cast<size_t>(size) + AV_INPUT_BUFFER_PADDING_SIZE)) {
+            return AVERROR(ENOMEM);
+        }
+
+        packet->buf = av_buffer_pool_get(pool);
+        if (!packet->buf) {
+            return AVERROR(ENOMEM);
+        }
+        std::memcpy(packet->buf->data, data, size);
+        std::memset(packet->buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    }
+
+    packet->data = packet->buf->data;
+    packet->size = size;
+    return 0;
+}
+
+void InputArena::reset() {
+    if (pool) {
+        av_buffer_pool_uninit(&pool);
+        pool = nullptr;
+    }
+    blockSize = 0;
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @file InputArena.h
+ * @brief Padded input staging for FFmpeg packets in ShadPS4
+ * 
+ * FFmpeg's bitstream readers may read up to AV_INPUT_BUFFER_PADDING_SIZE
+ * bytes past the end of a packet. The arena makes every packet handed to the
+ * codec padded and reference counted, either by copying it once into a pooled
+ * padded block or, when the caller guarantees the padding, by wrapping the
+ * caller's memory without copying.
+ */
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief How packet data is staged for the codec
+ */
+enum class InputMode {
+    Copy,       // Copy into a pooled, zero-padded block (safe for any caller memory)
+    ZeroCopy    // Wrap caller memory; caller guarantees AV_INPUT_BUFFER_PADDING_SIZE readable bytes after the packet
+};
+
+/**
+ * @brief Per-decoder pool of padded, reference-counted input buffers
+ */
+class InputArena {
+public:
+    InputArena();
+    ~InputArena();
+
+    /**
+     * @brief Attach packet data to an AVPacket as a padded, refcounted buffer
+     * @param packet Packet to fill; any previous reference is released
+     * @param data Compressed packet data
+     * @param size Size of the packet data in bytes
+     * @param mode Staging mode
+     * @return 0 on success, negative AVERROR code on failure
+     */
+    int stage(AVPacket* packet, const uint8_t* data, int size, InputMode mode);
+
+    /**
+     * @brief Release the pool; outstanding buffers stay valid until unreferenced
+     */
+    void reset();
+
+    /**
+     * @brief Get the current pooled block size in bytes (including padding)
+     */
+    size_t getBlockSize() const { return blockSize; }
+
+private:
+    bool ensureBlockSize(size_t required);
+
+    AVBufferPool* pool;         // Pool of padded blocks for copy mode
+    size_t blockSize;           // Size of each pooled block
+
+    // Disable copy constructor and assignment operator
+    InputArena(const InputArena&) = delete;
+    InputArena& operator=(const InputArena&) = delete;
+};
+
+} // namespace ShadPS4::Audio
@@ -14,58 +14,238 @@ extern "C" {
 }
 
 #include "OrbisAudioDecoder.h"
-#include <iostream>
+#include "CodecConfig.h"
+#include "DecodeTrace.h"
+#include "PcmCache.h"
+#include "PcmDiskCache.h"
+#include "PcmConvert.h"
+#include "common/logging/log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <cstring>
+#include <limits>
 
 namespace ShadPS4::Audio {
 
+namespace {
+
+// Upper bound on channels for planar output (matches swresample's limit)
+constexpr int kMaxOutputChannels = 64;
+
+// Buffered samples per channel kept before the oldest are dropped (about 1.4 s at 48 kHz)
+constexpr size_t kMaxBufferedSamples = 65536;
+
+// Samples per channel mixed at a time when the output is not planar float (8 x 1 KiB, stays in L1)
+constexpr int kMixBlockSamples = 256;
+
+// Source of trace IDs; pooled decoders keep theirs across reuse
+std::atomic<uint32_t> g_nextTraceId{1};
+
+/**
+ * @brief Write position in the caller's output buffer, in samples per channel
+ */
+struct OutputCursor {
+    uint8_t* buffer;
+    int planeStride;            // Bytes per plane (planar output only)
+    int sampleBytes;            // Bytes per sample per plane
+    bool planar;
+    int channels;
+    int capacity;               // Samples per channel that fit
+    int written;                // Samples per channel written so far
+
+    int getRoom() const { return capacity - written; }
+
+    void getPlanes(uint8_t** planes) const {
+        if (planar) {
+            for (int ch = 0; ch < channels; ++ch) {
+                planes[ch] = buffer + ch * planeStride + written * sampleBytes;
+            }
+        } else {
+            planes[0] = buffer + written * sampleBytes;
+        }
+    }
+};
+
+OutputCursor makeCursor(uint8_t* buffer, int bufferSize, bool planar, int planeStride,
+                        int channels, int sampleBytes) {
+    OutputCursor cursor;
+    cursor.buffer = buffer;
+    cursor.planeStride = planeStride;
+    cursor.sampleBytes = sampleBytes;
+    cursor.planar = planar;
+    cursor.channels = channels;
+    cursor.capacity = (planar ? planeStride : bufferSize) / sampleBytes;
+    cursor.written = 0;
+    return cursor;
+}
+
+/**
+ * @brief Largest frame a codec produces, for sizing the frame pool
+ */
+int getMaxFrameSamples(AVCodecID codecId) {
+    switch (codecId) {
+    case AV_CODEC_ID_OPUS: return 5760;     // 120 ms at 48 kHz
+    case AV_CODEC_ID_ATRAC9: return 1024;   // Four 256-sample frames per superframe
+    case AV_CODEC_ID_AAC:
+    default: return 2048;                   // HE-AAC doubles the 1024-sample core frame
+    }
+}
+
+/**
+ * @brief Map a decoder return code to its statistics bucket
+ */
+DecodeErrorKind classifyError(int status) {
+    switch (status) {
+    case -1: return DecodeErrorKind::InvalidInput;
+    case -2: return DecodeErrorKind::InsufficientBuffer;
+    case AVERROR_EOF: return DecodeErrorKind::EndOfStream;
+    default: return DecodeErrorKind::CodecFailure;
+    }
+}
+
+} // namespace
+
 OrbisAudioDecoder::OrbisAudioDecoder() 
     : codecContext(nullptr)
     , swrContext(nullptr)
     , codec(nullptr)
     , frame(nullptr)
     , packet(nullptr)
-    , isInitialized(false) {
+    , inputMode(InputMode::Copy)
+    , fifoChannels(0)
+    , conversionInputRate(0)
+    , conversionInputFormat(AV_SAMPLE_FMT_NONE)
+    , conversionChannels(0)
+    , outputSampleRate(0)
+    , mixStage(MixStage::None)
+    , decodedSamples(0)
+    , trimRemaining(0)
+    , cacheSeed(0)
+    , cacheChain(0)
+    , cacheChainValid(false)
+    , cacheServedPackets(0)
+    , aacConfigDerived(false)
+    , aacFramingProbe(false)
+    , aacFramingPending(false)
+    , adtsInput(false)
+    , isInitialized(false)
+    , traceId(g_nextTraceId.fetch_add(1, std::memory_order_relaxed))
+    , configuredCodecId(AV_CODEC_ID_NONE)
+    , configuredSampleRate(0)
+    , configuredChannels(0)
+    , outputSampleFormat(AV_SAMPLE_FMT_S16)
+    , targetSampleRate(0)
+    , resamplePreset(ResamplePreset::Balanced) {
 }
 
 OrbisAudioDecoder::~OrbisAudioDecoder() {
     cleanup();
 }
 
-bool OrbisAudioDecoder::initialize(AVCodecID codecId, int sampleRate, int channels) {
+bool OrbisAudioDecoder::isSupportedOutputFormat(AVSampleFormat format) {
+    switch (format) {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32P:
+    case AV_SAMPLE_FMT_FLTP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int OrbisAudioDecoder::getPlaneStride(int outputBufferSize) const {
+    const int outputChannels = getOutputChannels();
+    if (!av_sample_fmt_is_planar(outputSampleFormat) || outputChannels <= 0) {
+        return outputBufferSize;
+    }
+    int bytesPerSample = av_get_bytes_per_sample(outputSampleFormat);
+    return (outputBufferSize / outputChannels) / bytesPerSample * bytesPerSample;
+}
+
+bool OrbisAudioDecoder::initialize(AVCodecID codecId, int sampleRate, int channels,
+                                   AVSampleFormat outputFormat, const uint8_t* codecConfig,
+                                   int codecConfigSize, int targetRate, ResamplePreset preset,
+                                   const ChannelMatrix& matrix) {
     if (isInitialized) {
-        std::cout << "[OrbisAudioDecoder] Already initialized, cleaning up first" << std::endl;
+        LOG_INFO("OrbisAudioDecoder", "Already initialized, cleaning up first");
         cleanup();
     }
 
+    if (!isSupportedOutputFormat(outputFormat)) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Unsupported output sample format %d",
+            static_cast<int>(outputFormat));
+        return false;
+    }
+
+    if (codecConfigSize < 0 || (codecConfigSize > 0 && !codecConfig)) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Invalid codec configuration");
+        return false;
+    }
+
+    if (targetRate < 0) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Invalid target sample rate %d", targetRate);
+        return false;
+    }
+
+    if (matrix.isActive() && matrix.getInputChannels() != channels) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Channel matrix takes %d channels, stream has %d",
+            matrix.getInputChannels(), channels);
+        return false;
+    }
+
     // Find the decoder
     codec = avcodec_find_decoder(codecId);
     if (!codec) {
-        std::cerr << "[OrbisAudioDecoder] Error: Codec not found for ID " << codecId << std::endl;
+        LOG_ERROR("OrbisAudioDecoder", "Error: Codec not found for ID %d",
+            static_cast<int>(codecId));
         return false;
     }
 
-    std::cout << "[OrbisAudioDecoder] Found codec: " << codec->name << std::endl;
+    LOG_DEBUG("OrbisAudioDecoder", "Found codec: %s", codec->name);
 
-    // Allocate codec context
-    codecContext = avcodec_alloc_context3(codec);
-    if (!codecContext) {
-        std::cerr << "[OrbisAudioDecoder] Error: Could not allocate codec context" << std::endl;
-        return false;
+    // AAC is configured up front from an AudioSpecificConfig instead of probing the first packets
+    const uint8_t* extradata = codecConfig;
+    int extradataSize = codecConfigSize;
+    if (codecId == AV_CODEC_ID_AAC) {
+        AacCodecInfo aacInfo;
+        if (codecConfigSize > 0) {
+            if (!parseAacConfig(codecConfig, static_cast<size_t>(codecConfigSize), aacInfo)) {
+                LOG_ERROR("OrbisAudioDecoder", "Error: Invalid AAC configuration");
+                cleanup();
+                return false;
+            }
+            // An ADTS header stands for its AudioSpecificConfig: its per-frame fields (frame
+            // length, buffer fullness) must not reach configuredCodecConfig and the cache seed.
+            // Whether packets carry headers is then decided by the first packet, as for a config.
+            if (aacInfo.adts) {
+                aacConfig.assign(aacInfo.builtConfig, aacInfo.builtConfig + aacInfo.builtConfigSize);
+            } else {
+                aacConfig.assign(codecConfig, codecConfig + codecConfigSize);
+            }
+            codecConfig = aacConfig.data();
+            codecConfigSize = static_cast<int>(aacConfig.size());
+            aacFramingProbe = true;
+        } else if (buildAacConfig(sampleRate, channels, aacInfo)) {
+            // No config from the caller: assume AAC-LC until the first packet shows otherwise
+            aacConfig.assign(aacInfo.builtConfig, aacInfo.builtConfig + aacInfo.builtConfigSize);
+            aacConfigDerived = true;
+            aacFramingProbe = true;
+        } else {
+            LOG_DEBUG("OrbisAudioDecoder", "No AAC configuration for %d Hz, %d channels; the codec probes the stream",
+                sampleRate, channels);
+        }
+        aacFramingPending = aacFramingProbe;
+        extradata = aacConfig.data();
+        extradataSize = static_cast<int>(aacConfig.size());
     }
 
-    // Set codec parameters
-    codecContext->sample_rate = sampleRate;
-    codecContext->channels = channels;
-    codecContext->channel_layout = av_get_default_channel_layout(channels);
-
-    // Open codec
-    int ret = avcodec_open2(codecContext, codec, nullptr);
-    if (ret < 0) {
-        char errorStr[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorStr, sizeof(errorStr));
-        std::cerr << "[OrbisAudioDecoder] Error opening codec: " << errorStr << std::endl;
+    codecContext = openCodec(sampleRate, channels, extradata, extradataSize);
+    if (!codecContext) {
         cleanup();
         return false;
     }
@@ -74,7 +254,7 @@ bool OrbisAudioDecoder::initialize(AVCodecID codecId, int sampleRate, int channe
     frame = av_frame_alloc();
     packet = av_packet_alloc();
     if (!frame || !packet) {
-        std::cerr << "[OrbisAudioDecoder] Error: Could not allocate frame or packet" << std::endl;
+        LOG_ERROR("OrbisAudioDecoder", "Error: Could not allocate frame or packet");
         cleanup();
         return false;
     }
@@ -82,111 +262,715 @@ bool OrbisAudioDecoder::initialize(AVCodecID codecId, int sampleRate, int channe
     // Initialize software resampler for format conversion if needed
     swrContext = swr_alloc();
     if (!swrContext) {
-        std::cerr << "[OrbisAudioDecoder] Error: Could not allocate resampler context" << std::endl;
+        LOG_ERROR("OrbisAudioDecoder", "Error: Could not allocate resampler context");
         cleanup();
         return false;
     }
 
-    // Configure resampler (convert to standard PCM format)
-    av_opt_set_int(swrContext, "in_channel_layout", codecContext->channel_layout, 0);
-    av_opt_set_int(swrContext, "out_channel_layout", codecContext->channel_layout, 0);
-    av_opt_set_int(swrContext, "in_sample_rate", codecContext->sample_rate, 0);
-    av_opt_set_int(swrContext, "out_sample_rate", codecContext->sample_rate, 0);
-    av_opt_set_sample_fmt(swrContext, "in_sample_fmt", codecContext->sample_fmt, 0);
-    av_opt_set_sample_fmt(swrContext, "out_sample_fmt", AV_SAMPLE_FMT_S16, 0);
-
-    ret = swr_init(swrContext);
+    // Configure format (and, with a target rate, rate) conversion
+    outputSampleFormat = outputFormat;
+    targetSampleRate = targetRate;
+    resamplePreset = preset;
+    channelMatrix = matrix;
+    int ret = configureConversion(codecContext->sample_rate, codecContext->sample_fmt, codecContext->channels);
     if (ret < 0) {
-        char errorStr[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorStr, sizeof(errorStr));
-        std::cerr << "[OrbisAudioDecoder] Error initializing resampler: " << errorStr << std::endl;
         cleanup();
         return false;
     }
 
+    configuredCodecId = codecId;
+    configuredSampleRate = sampleRate;
+    configuredChannels = channels;
+    configuredCodecConfig.assign(codecConfig, codecConfig + codecConfigSize);
+    configureFifo(getOutputChannels());
+
+    // Seed of every PCM cache chain: outputs of different configurations never share keys
+    uint64_t configWords[] = {static_cast<uint64_t>(codecId), static_cast<uint64_t>(sampleRate),
+                              static_cast<uint64_t>(channels), static_cast<uint64_t>(outputFormat),
+                              static_cast<uint64_t>(targetRate), static_cast<uint64_t>(preset),
+                              static_cast<uint64_t>(channelMatrix.getHash())};
+    cacheSeed = PcmCache::hashBytes(reinterpret_cast<const uint8_t*>(configWords), sizeof(configWords), 0);
+    cacheSeed = PcmCache::hashBytes(configuredCodecConfig.data(), configuredCodecConfig.size(), cacheSeed);
+    cacheChain = cacheSeed;
+    cacheChainValid = true;
+    cacheServedPackets = 0;
+
     isInitialized = true;
-    std::cout << "[OrbisAudioDecoder] Successfully initialized decoder" << std::endl;
-    std::cout << "[OrbisAudioDecoder] Sample rate: " << sampleRate << " Hz, Channels: " << channels << std::endl;
+    LOG_INFO("OrbisAudioDecoder", "Successfully initialized decoder");
+    LOG_INFO("OrbisAudioDecoder", "Sample rate: %d Hz (decoded at %d Hz, output at %d Hz), Channels: %d, Output: %s",
+        sampleRate, codecContext->sample_rate, outputSampleRate, channels,
+        av_get_sample_fmt_name(outputFormat));
+    const char* conversion = "swresample";
+    if (resampler.isConfigured()) {
+        conversion = "polyphase";
+    } else if (outputSampleRate != codecContext->sample_rate) {
+        conversion = "swresample (resampling)";
+    } else if (codecContext->sample_fmt == outputFormat) {
+        conversion = "none";
+    } else if (codecContext->sample_fmt == AV_SAMPLE_FMT_FLTP && outputFormat == AV_SAMPLE_FMT_S16 &&
+               PcmConvert::getFltpToS16Kernel(channels)) {
+        conversion = PcmConvert::getSimdLevelName(PcmConvert::getActiveSimdLevel());
+    }
+    LOG_DEBUG("OrbisAudioDecoder", "PCM conversion: %s", conversion);
+    if (channelMatrix.isActive()) {
+        static const char* const stageNames[] = {"none", "plane remap", "matrix kernel", "swresample"};
+        LOG_DEBUG("OrbisAudioDecoder", "Channel matrix: %d -> %d channels (preset %d, %s)",
+            channels, channelMatrix.getOutputChannels(), static_cast<int>(channelMatrix.getPreset()),
+            stageNames[static_cast<int>(mixStage)]);
+    }
     
     return true;
 }
 
+AVCodecContext* OrbisAudioDecoder::openCodec(int sampleRate, int channels, const uint8_t* extradata,
+                                             int extradataSize) {
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    if (!context) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Could not allocate codec context");
+        return nullptr;
+    }
+
+    // Set codec parameters
+    context->sample_rate = sampleRate;
+    context->channels = channels;
+    context->channel_layout = av_get_default_channel_layout(channels);
+
+    // Codec setup data (FFmpeg owns the copy and frees it with the context)
+    if (extradataSize > 0) {
+        context->extradata = static_cast<uint8_t*>(
+            av_mallocz(static_cast<size_t>(extradataSize) + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!context->extradata) {
+            LOG_ERROR("OrbisAudioDecoder", "Error: Could not allocate codec configuration");
+            avcodec_free_context(&context);
+            return nullptr;
+        }
+        std::memcpy(context->extradata, extradata, static_cast<size_t>(extradataSize));
+        context->extradata_size = extradataSize;
+    }
+
+    // Frame data comes from the decoder's own pool, so steady-state decoding does not allocate
+    if (!framePool.attach(context, channels, getMaxFrameSamples(codec->id))) {
+        LOG_DEBUG("OrbisAudioDecoder", "Codec %s uses FFmpeg's frame allocator", codec->name);
+    }
+
+    // Open codec
+    int ret = avcodec_open2(context, codec, nullptr);
+    if (ret < 0) {
+        char errorStr[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorStr, sizeof(errorStr));
+        LOG_ERROR("OrbisAudioDecoder", "Error opening codec: %s", errorStr);
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+
+    // Codecs that read their layout from codecConfig must agree with the caller
+    if (context->channels != channels) {
+        LOG_ERROR("OrbisAudioDecoder", "Error: Codec configuration has %d channels, expected %d",
+            context->channels, channels);
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+    return context;
+}
+
+bool OrbisAudioDecoder::settleAacFraming(const uint8_t* packetData, int packetSize) {
+    aacFramingPending = false;
+    adtsInput = getAdtsHeaderSize(packetData, static_cast<size_t>(packetSize)) > 0;
+    if (!aacConfigDerived) {
+        // The caller's AudioSpecificConfig stands; only the headers are stripped
+        return true;
+    }
+
+    // Without a caller config, an ADTS header describes the stream better than the LC guess
+    AacCodecInfo aacInfo;
+    const bool described = adtsInput
+        ? parseAacConfig(packetData, static_cast<size_t>(packetSize), aacInfo)
+        : buildAacConfig(configuredSampleRate, configuredChannels, aacInfo);
+    if (!described || aacInfo.channels != configuredChannels) {
+        LOG_WARNING_RATELIMITED("OrbisAudioDecoder", "AAC stream does not match %d channels; the codec parses its headers",
+            configuredChannels);
+        adtsInput = false;
+        return true;
+    }
+    if (aacConfig.size() == static_cast<size_t>(aacInfo.builtConfigSize) &&
+        std::memcmp(aacConfig.data(), aacInfo.builtConfig, aacConfig.size()) == 0) {
+        return true;
+    }
+
+    // Nothing has been decoded since the reset, so swapping the context loses no state
+    AVCodecContext* context = openCodec(configuredSampleRate, configuredChannels, aacInfo.builtConfig,
+                                        aacInfo.builtConfigSize);
+    if (!context) {
+        return false;
+    }
+    avcodec_free_context(&codecContext);
+    codecContext = context;
+    aacConfig.assign(aacInfo.builtConfig, aacInfo.builtConfig + aacInfo.builtConfigSize);
+    LOG_DEBUG("OrbisAudioDecoder", "AAC configured from ADTS header: object type %d, %d Hz, %d channels",
+        aacInfo.objectType, aacInfo.sampleRate, aacInfo.channels);
+    return true;
+}
+
 int OrbisAudioDecoder::decodePacket(const uint8_t* packetData, int packetSize, 
                                    uint8_t* outputBuffer, int outputBufferSize, int* outputSize) {
     if (!isInitialized) {
-        std::cerr << "[OrbisAudioDecoder] Error: Decoder not initialized" << std::endl;
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Decoder not initialized");
+        stats.recordError(DecodeErrorKind::NotInitialized);
         return -1;
     }
 
     if (!packetData || packetSize <= 0 || !outputBuffer || outputBufferSize <= 0 || !outputSize) {
-        std::cerr << "[OrbisAudioDecoder] Error: Invalid input parameters" << std::endl;
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Invalid input parameters");
+        stats.recordError(DecodeErrorKind::InvalidInput);
+        return -1;
+    }
+
+    int ret = decodeCached(packetData, packetSize, outputBuffer, outputBufferSize, outputSize);
+    if (ret < 0) {
+        return ret;
+    }
+
+    LOG_TRACE("OrbisAudioDecoder", "Decoded packet: input_size=%d, output_size=%d",
+        packetSize, *outputSize);
+
+    return 0; // Success
+}
+
+int OrbisAudioDecoder::decodePackets(PacketDecodeRequest* requests, int count) {
+    if (!isInitialized) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Decoder not initialized");
+        stats.recordError(DecodeErrorKind::NotInitialized);
         return -1;
     }
 
+    if (!requests || count <= 0) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Invalid batch parameters");
+        return -1;
+    }
+
+    int decodedCount = 0;
+    int totalOutput = 0;
+
+    for (int i = 0; i < count; ++i) {
+        PacketDecodeRequest& request = requests[i];
+        request.outputSize = 0;
+
+        if (!request.packetData || request.packetSize <= 0 ||
+            !request.outputBuffer || request.outputBufferSize <= 0) {
+            request.result = -1;
+            stats.recordError(DecodeErrorKind::InvalidInput);
+            continue;
+        }
+
+        request.result = decodeCached(request.packetData, request.packetSize,
+                                      request.outputBuffer, request.outputBufferSize,
+                                      &request.outputSize);
+        if (request.result == 0) {
+            ++decodedCount;
+            totalOutput += request.outputSize;
+        }
+    }
+
+    // One summary line per batch instead of one per packet
+    if (decodedCount != count) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Batch decode: %d of %d packets failed",
+            (count - decodedCount), count);
+    }
+    LOG_TRACE("OrbisAudioDecoder", "Decoded batch: packets=%d, output_size=%d",
+        decodedCount, totalOutput);
+
+    return decodedCount;
+}
+
+int OrbisAudioDecoder::decodeCached(const uint8_t* packetData, int packetSize,
+                                    uint8_t* outputBuffer, int outputBufferSize, int* outputSize) {
+    // Only whole packets decoded straight into the caller's buffer are cacheable
+    PcmCache& cache = PcmCache::getInstance();
+    PcmDiskCache& diskCache = PcmDiskCache::getInstance();
+    bool cacheable = (cache.isEnabled() || diskCache.isOpen()) && cacheChainValid &&
+                     trimRemaining == 0 && pcmFifo.isEmpty();
+
+    const OutputCursor cursor = makeCursor(outputBuffer, outputBufferSize,
+                                           av_sample_fmt_is_planar(outputSampleFormat),
+                                           getPlaneStride(outputBufferSize), fifoChannels,
+                                           pcmFifo.getSampleBytes());
+    const int planeCount = cursor.planar ? cursor.channels : 1;
+    uint8_t* planes[kMaxOutputChannels];
+    cursor.getPlanes(planes);
+
+    uint64_t key = 0;
+    if (cacheable) {
+        key = PcmCache::hashBytes(packetData, static_cast<size_t>(packetSize), cacheChain);
+        int samples = 0;
+        const bool hit =
+            (cache.isEnabled() && cache.lookup(key, static_cast<uint32_t>(packetSize), planes, planeCount,
+                                               cursor.sampleBytes, cursor.capacity, &samples)) ||
+            (diskCache.isOpen() && diskCache.lookup(key, static_cast<uint32_t>(packetSize), planes, planeCount,
+                                                    cursor.sampleBytes, cursor.capacity, &samples));
+        if (hit) {
+            // The codec skips this packet; keep it to rebuild the codec's state on a later miss
+            cacheChain = key;
+            cacheRecentPackets[cacheServedPackets % kCachePrimingPackets].assign(packetData, packetData + packetSize);
+            ++cacheServedPackets;
+            *outputSize = samples * cursor.sampleBytes * planeCount;
+            return 0;
+        }
+    }
+
+    if (cacheServedPackets > 0) {
+        // The stream left the cached path: rebuild codec and resampler state from the packets served
+        restartCodec();
+        const int count = static_cast<int>(std::min<int64_t>(cacheServedPackets, kCachePrimingPackets));
+        PacketDecodeRequest priming[kCachePrimingPackets];
+        for (int i = 0; i < count; ++i) {
+            const std::vector<uint8_t>& packet =
+                cacheRecentPackets[(cacheServedPackets - count + i) % kCachePrimingPackets];
+            priming[i] = PacketDecodeRequest{packet.data(), static_cast<int>(packet.size()), nullptr, 0, 0, 0};
+        }
+        int64_t droppedSamples = 0;
+        primeCodec(priming, count, &droppedSamples);
+
+        // Replaying every packet since the reset restores the state exactly; a partial replay
+        // only comes close, so nothing decoded from here on may enter the cache
+        if (cacheServedPackets > kCachePrimingPackets) {
+            cacheChainValid = false;
+            cacheable = false;
+        }
+        cacheServedPackets = 0;
+    }
+
+    const int ret = sendAndDrain(packetData, packetSize, outputBuffer, outputBufferSize, outputSize);
+    if (!cacheable) {
+        return ret;
+    }
+
+    if (ret == 0 && pcmFifo.isEmpty() && planeCount == (cursor.planar ? fifoChannels : 1) &&
+        cursor.sampleBytes == pcmFifo.getSampleBytes()) {
+        const int samples = *outputSize / (cursor.sampleBytes * planeCount);
+        if (cache.isEnabled()) {
+            cache.insert(key, static_cast<uint32_t>(packetSize), planes, planeCount, cursor.sampleBytes, samples);
+        }
+        if (diskCache.isOpen()) {
+            diskCache.record(key, static_cast<uint32_t>(packetSize), planes, planeCount, cursor.sampleBytes, samples);
+        }
+        cacheChain = key;
+    } else {
+        // Later output depends on carried-over samples or a failure; resume after the next reset
+        cacheChainValid = false;
+    }
+    return ret;
+}
+
+int OrbisAudioDecoder::sendAndDrain(const uint8_t* packetData, int packetSize,
+                                    uint8_t* outputBuffer, int outputBufferSize, int* outputSize) {
     *outputSize = 0;
+    const auto startTime = std::chrono::steady_clock::now();
 
-    // Prepare packet
-    av_packet_unref(packet);
-    packet->data = const_cast<uint8_t*>(packetData);
-    packet->size = packetSize;
+    // AAC framing is settled once per reset; ADTS headers are then skipped without re-syncing
+    if (aacFramingPending && !settleAacFraming(packetData, packetSize)) {
+        stats.recordError(DecodeErrorKind::CodecFailure);
+        return -3;
+    }
+    const int headerSize = adtsInput ? getAdtsHeaderSize(packetData, static_cast<size_t>(packetSize)) : 0;
 
-    // Send packet to decoder
-    int ret = avcodec_send_packet(codecContext, packet);
+    // Stage packet into a padded, refcounted buffer
+    int ret = inputArena.stage(packet, packetData + headerSize, packetSize - headerSize, inputMode);
+    if (ret < 0) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Could not stage input packet");
+        stats.recordError(DecodeErrorKind::CodecFailure);
+        return ret;
+    }
+
+    // Send packet to decoder; the codec keeps its own reference
+    {
+        TraceSpan span("avcodec_send_packet", traceId, codec->name, packet->size);
+        ret = avcodec_send_packet(codecContext, packet);
+        span.setResult(ret);
+    }
+    av_packet_unref(packet);
     if (ret < 0) {
         char errorStr[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errorStr, sizeof(errorStr));
-        std::cerr << "[OrbisAudioDecoder] Error sending packet to decoder: " << errorStr << std::endl;
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error sending packet to decoder: %s", errorStr);
+        stats.recordError(classifyError(ret));
         return ret;
     }
 
-    // Receive decoded frame
-    ret = avcodec_receive_frame(codecContext, frame);
-    if (ret < 0) {
+    // Hand out PCM left over from earlier packets first
+    OutputCursor cursor = makeCursor(outputBuffer, outputBufferSize,
+                                     av_sample_fmt_is_planar(outputSampleFormat),
+                                     getPlaneStride(outputBufferSize), fifoChannels,
+                                     pcmFifo.getSampleBytes());
+    uint8_t* planes[kMaxOutputChannels];
+    cursor.getPlanes(planes);
+    cursor.written += static_cast<int>(pcmFifo.read(planes, cursor.getRoom()));
+
+    // Drain every frame the codec can produce for this packet
+    uint32_t frameCount = 0;
+    bool starved = false;
+    int status = 0;
+
+    while (true) {
+        {
+            TraceSpan span("avcodec_receive_frame", traceId, codec->name);
+            ret = avcodec_receive_frame(codecContext, frame);
+            span.setSize(ret >= 0 ? frame->nb_samples : 0);
+            span.setResult(ret);
+        }
         if (ret == AVERROR(EAGAIN)) {
             // Need more input data
-            return 0;
+            starved = frameCount == 0;
+            break;
         } else if (ret == AVERROR_EOF) {
-            std::cout << "[OrbisAudioDecoder] End of stream reached" << std::endl;
-            return ret;
-        } else {
+            LOG_DEBUG("OrbisAudioDecoder", "End of stream reached");
+            status = ret;
+            break;
+        } else if (ret < 0) {
             char errorStr[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errorStr, sizeof(errorStr));
-            std::cerr << "[OrbisAudioDecoder] Error receiving frame from decoder: " << errorStr << std::endl;
-            return ret;
+            LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error receiving frame from decoder: %s",
+                errorStr);
+            status = ret;
+            break;
+        }
+
+        ++frameCount;
+        decodedSamples += frame->nb_samples;
+        int channels = frame->channels;
+
+        if (channels <= 0 || channels > kMaxOutputChannels ||
+            (av_sample_fmt_is_planar(outputSampleFormat) && channels != configuredChannels) ||
+            (channelMatrix.isActive() && channels != channelMatrix.getInputChannels())) {
+            LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Unsupported channel count %d (configured %d)",
+                channels, configuredChannels);
+            av_frame_unref(frame);
+            status = -3;
+            break;
+        }
+
+        const int outputChannels = channelMatrix.isActive() ? channelMatrix.getOutputChannels() : channels;
+        if (outputChannels != fifoChannels) {
+            // Layout changed mid-stream: samples of the old layout cannot share a buffer with the new one
+            if (!pcmFifo.isEmpty()) {
+                LOG_WARNING_RATELIMITED("OrbisAudioDecoder", "Channel count changed from %d to %d, dropping %zu buffered samples",
+                    fifoChannels, outputChannels, pcmFifo.getSize());
+            }
+            configureFifo(outputChannels);
+            if (cursor.written > 0) {
+                cursor.capacity = cursor.written; // Rest goes to the FIFO for the next call
+            } else {
+                cursor = makeCursor(outputBuffer, outputBufferSize,
+                                    av_sample_fmt_is_planar(outputSampleFormat),
+                                    getPlaneStride(outputBufferSize), fifoChannels,
+                                    pcmFifo.getSampleBytes());
+            }
+        }
+
+        // HE-AAC switches to the SBR rate on its first frame; follow the frame
+        int convertedSamples = 0;
+        const AVSampleFormat frameFormat = static_cast<AVSampleFormat>(frame->format);
+        if ((frame->sample_rate > 0 && frame->sample_rate != conversionInputRate) ||
+            frameFormat != conversionInputFormat || channels != conversionChannels) {
+            convertedSamples = configureConversion(frame->sample_rate > 0 ? frame->sample_rate : conversionInputRate,
+                                                   frameFormat, channels);
+        }
+
+        TraceSpan convertSpan("convertFrame", traceId, codec->name, frame->nb_samples);
+        const int expectedSamples = getConvertedSamples();
+        if (convertedSamples < 0) {
+            // Conversion could not be set up; reported below
+        } else if (pcmFifo.isEmpty() && trimRemaining == 0 && expectedSamples <= cursor.getRoom()) {
+            // Whole frame fits: convert straight into the caller's buffer
+            cursor.getPlanes(planes);
+            convertedSamples = convertFrame(planes, cursor.getRoom());
+            if (convertedSamples > 0) {
+                cursor.written += convertedSamples;
+            }
+        } else {
+            // Convert into the FIFO and hand out as much as fits
+            pcmFifo.reserve(static_cast<size_t>(expectedSamples), planes);
+            convertedSamples = convertFrame(planes, expectedSamples);
+            if (convertedSamples > 0) {
+                pcmFifo.commit(convertedSamples);
+                if (trimRemaining > 0) {
+                    // Still inside a seek's pre-roll; nothing precedes these samples in the FIFO
+                    trimRemaining -= static_cast<int64_t>(pcmFifo.discard(
+                        static_cast<size_t>(std::min<int64_t>(trimRemaining, convertedSamples))));
+                }
+                cursor.getPlanes(planes);
+                cursor.written += static_cast<int>(pcmFifo.read(planes, cursor.getRoom()));
+            }
         }
+        convertSpan.setResult(convertedSamples);
+        av_frame_unref(frame);
+
+        if (convertedSamples < 0) {
+            char errorStr[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(convertedSamples, errorStr, sizeof(errorStr));
+            LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error converting audio format: %s",
+                errorStr);
+            status = convertedSamples;
+            break;
+        }
+    }
+
+    if (pcmFifo.getSize() > kMaxBufferedSamples) {
+        size_t dropped = pcmFifo.discard(pcmFifo.getSize() - kMaxBufferedSamples);
+        LOG_WARNING_RATELIMITED("OrbisAudioDecoder", "PCM FIFO overflow, dropped %zu samples; output buffers are not being drained",
+            dropped);
     }
 
-    // Calculate required output buffer size
-    int samplesPerChannel = frame->nb_samples;
-    int channels = frame->channels;
-    int bytesPerSample = 2; // 16-bit PCM
-    int requiredSize = samplesPerChannel * channels * bytesPerSample;
+    if (status == 0 && cursor.capacity == 0 && !pcmFifo.isEmpty()) {
+        // Not even one sample fits; the audio stays buffered for a larger read
+        status = -2;
+    }
 
-    if (requiredSize > outputBufferSize) {
-        std::cerr << "[OrbisAudioDecoder] Error: Output buffer too small. Required: " 
-                  << requiredSize << ", Available: " << outputBufferSize << std::endl;
-        return -2;
+    if (status < 0 && status != AVERROR_EOF && inputMode == InputMode::ZeroCopy) {
+        // The codec may still reference the caller's packet; drop it before returning
+        avcodec_flush_buffers(codecContext);
+    }
+
+    *outputSize = cursor.written * cursor.sampleBytes * (cursor.planar ? cursor.channels : 1);
+
+    const uint64_t elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count());
+    stats.recordPacket(static_cast<uint64_t>(packetSize), static_cast<uint64_t>(*outputSize),
+                       frameCount, elapsedNs, starved);
+    if (status < 0) {
+        stats.recordError(classifyError(status));
+    }
+
+    return status;
+}
+
+void OrbisAudioDecoder::configureFifo(int channels) {
+    const int bytesPerSample = av_get_bytes_per_sample(outputSampleFormat);
+    if (av_sample_fmt_is_planar(outputSampleFormat)) {
+        pcmFifo.configure(channels, bytesPerSample);
+    } else {
+        pcmFifo.configure(1, channels * bytesPerSample);
+    }
+    fifoChannels = channels;
+}
+
+int OrbisAudioDecoder::configureConversion(int inputRate, AVSampleFormat inputFormat, int channels) {
+    const int outputRate = targetSampleRate > 0 ? targetSampleRate : inputRate;
+    const int outputChannels = channelMatrix.isActive() ? channelMatrix.getOutputChannels() : channels;
+
+    // Apply the channel matrix where it costs least
+    const MixStage previousStage = mixStage;
+    mixStage = MixStage::None;
+    if (channelMatrix.isActive()) {
+        if (channelMatrix.isChannelMap() && av_sample_fmt_is_planar(inputFormat)) {
+            mixStage = MixStage::RemapPlanes;
+        } else if (inputFormat == AV_SAMPLE_FMT_FLTP) {
+            mixStage = MixStage::Kernel;
+        } else {
+            mixStage = MixStage::Swresample;
+        }
+    }
+
+    // Planar float at a ratio with a shared filter bank: mix, resample and convert in one pass
+    resampler.release();
+    if (outputRate != inputRate && inputFormat == AV_SAMPLE_FMT_FLTP) {
+        resampler.configure(PolyphaseFilter::get(inputRate, outputRate, resamplePreset),
+                            outputChannels, outputSampleFormat);
+    }
+    if (mixStage == MixStage::Kernel && outputRate != inputRate && !resampler.isConfigured()) {
+        mixStage = MixStage::Swresample;    // swresample resamples, so it mixes as well
+    }
+
+    // A custom swresample matrix survives swr_init(); start from a fresh context to drop it
+    if (previousStage == MixStage::Swresample && mixStage != MixStage::Swresample) {
+        swr_free(&swrContext);
+        swrContext = swr_alloc();
+        if (!swrContext) {
+            LOG_ERROR("OrbisAudioDecoder", "Error: Could not allocate resampler context");
+            conversionInputRate = 0;
+            return AVERROR(ENOMEM);
+        }
     }
 
-    // Convert audio format using swresample
-    uint8_t* outputPtr = outputBuffer;
-    int convertedSamples = swr_convert(swrContext, &outputPtr, samplesPerChannel,
-                                     const_cast<const uint8_t**>(frame->data), samplesPerChannel);
+    // swresample handles format conversion, and rate conversion the resampler does not cover
+    const int swrInputChannels = mixStage == MixStage::Swresample ? channels : outputChannels;
+    const int swrOutputRate = resampler.isConfigured() ? inputRate : outputRate;
+    av_opt_set_int(swrContext, "in_channel_layout", av_get_default_channel_layout(swrInputChannels), 0);
+    av_opt_set_int(swrContext, "out_channel_layout", av_get_default_channel_layout(outputChannels), 0);
+    av_opt_set_int(swrContext, "in_sample_rate", inputRate, 0);
+    av_opt_set_int(swrContext, "out_sample_rate", swrOutputRate, 0);
+    av_opt_set_sample_fmt(swrContext, "in_sample_fmt", inputFormat, 0);
+    av_opt_set_sample_fmt(swrContext, "out_sample_fmt", outputSampleFormat, 0);
+    if (swrOutputRate != inputRate) {
+        static const int filterSizes[] = {8, 16, 32};    // Indexed by ResamplePreset
+        static const double cutoffs[] = {0.80, 0.90, 0.95};
+        const int preset = static_cast<int>(resamplePreset);
+        av_opt_set_int(swrContext, "filter_size", filterSizes[preset], 0);
+        av_opt_set_double(swrContext, "cutoff", cutoffs[preset], 0);
+    }
+    if (mixStage == MixStage::Swresample) {
+        double matrix[ChannelMatrix::kMaxChannels * ChannelMatrix::kMaxChannels];
+        for (int i = 0; i < channels * outputChannels; ++i) {
+            matrix[i] = channelMatrix.getGains()[i];
+        }
+        swr_set_matrix(swrContext, matrix, channels);
+    }
 
-    if (convertedSamples < 0) {
+    int ret = swr_init(swrContext);
+    if (ret < 0) {
         char errorStr[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(convertedSamples, errorStr, sizeof(errorStr));
-        std::cerr << "[OrbisAudioDecoder] Error converting audio format: " << errorStr << std::endl;
-        return convertedSamples;
+        av_strerror(ret, errorStr, sizeof(errorStr));
+        LOG_ERROR("OrbisAudioDecoder", "Error initializing resampler: %s", errorStr);
+        conversionInputRate = 0;
+        return ret;
     }
 
-    *outputSize = convertedSamples * channels * bytesPerSample;
+    if (conversionInputRate != 0 && conversionInputRate != inputRate) {
+        LOG_DEBUG("OrbisAudioDecoder", "Stream rate changed from %d to %d Hz", conversionInputRate,
+            inputRate);
+    }
+    conversionInputRate = inputRate;
+    conversionInputFormat = inputFormat;
+    conversionChannels = channels;
+    outputSampleRate = outputRate;
+    return 0;
+}
+
+int OrbisAudioDecoder::getConvertedSamples() const {
+    if (resampler.isConfigured()) {
+        return resampler.getOutputSamples(frame->nb_samples);
+    }
+    if (outputSampleRate != conversionInputRate) {
+        return swr_get_out_samples(swrContext, frame->nb_samples);
+    }
+    return frame->nb_samples;
+}
 
-    std::cout << "[OrbisAudioDecoder] Decoded frame: sample_rate=" << frame->sample_rate 
-              << ", channels=" << frame->channels << ", samples=" << convertedSamples 
-              << ", output_size=" << *outputSize << std::endl;
+int OrbisAudioDecoder::mixFrame(const float* const* input, int samples, uint8_t** planes) {
+    const int inputChannels = channelMatrix.getInputChannels();
+    const int outputChannels = channelMatrix.getOutputChannels();
+    const bool planar = av_sample_fmt_is_planar(outputSampleFormat);
+    const int sampleBytes = av_get_bytes_per_sample(outputSampleFormat);
+    const PcmConvert::FltpToS16Func s16Kernel = outputSampleFormat == AV_SAMPLE_FMT_S16
+        ? PcmConvert::getFltpToS16Kernel(outputChannels) : nullptr;
 
-    return 0; // Success
+    // Planar float output is mixed in place; other formats are mixed a block at a time
+    // and converted while the block is still in cache
+    alignas(32) float block[ChannelMatrix::kMaxChannels][kMixBlockSamples];
+    for (int offset = 0; offset < samples; offset += kMixBlockSamples) {
+        const int count = std::min(kMixBlockSamples, samples - offset);
+
+        const float* sources[ChannelMatrix::kMaxChannels];
+        for (int ch = 0; ch < inputChannels; ++ch) {
+            sources[ch] = input[ch] + offset;
+        }
+        float* mixed[ChannelMatrix::kMaxChannels];
+        for (int ch = 0; ch < outputChannels; ++ch) {
+            mixed[ch] = outputSampleFormat == AV_SAMPLE_FMT_FLTP
+                ? reinterpret_cast<float*>(planes[ch]) + offset : block[ch];
+        }
+        channelMatrix.mix(sources, mixed, static_cast<size_t>(count));
+
+        if (outputSampleFormat == AV_SAMPLE_FMT_FLTP) {
+            continue;
+        }
+        if (s16Kernel) {
+            s16Kernel(mixed, reinterpret_cast<int16_t*>(planes[0]) + offset * outputChannels,
+                      static_cast<size_t>(count));
+            continue;
+        }
+
+        uint8_t* destination[ChannelMatrix::kMaxChannels];
+        for (int plane = 0; plane < (planar ? outputChannels : 1); ++plane) {
+            destination[plane] = planes[plane] + offset * sampleBytes * (planar ? 1 : outputChannels);
+        }
+        int ret = swr_convert(swrContext, destination, count,
+                              const_cast<const uint8_t**>(reinterpret_cast<uint8_t**>(mixed)), count);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return samples;
+}
+
+int OrbisAudioDecoder::convertFrame(uint8_t** planes, int capacity) {
+    const int samplesPerChannel = frame->nb_samples;
+    const int channels = mixStage == MixStage::None || mixStage == MixStage::Swresample
+        ? frame->channels : channelMatrix.getOutputChannels();
+
+    // A channel map on planar input only reorders the planes
+    const uint8_t** input = const_cast<const uint8_t**>(frame->extended_data);
+    const uint8_t* remapped[ChannelMatrix::kMaxChannels];
+    if (mixStage == MixStage::RemapPlanes) {
+        for (int ch = 0; ch < channels; ++ch) {
+            remapped[ch] = frame->extended_data[channelMatrix.getSourceChannel(ch)];
+        }
+        input = remapped;
+    }
+    const float* const* floatInput = reinterpret_cast<const float* const*>(input);
+
+    if (resampler.isConfigured()) {
+        // Mix, filter, convert and store in one pass
+        return resampler.process(floatInput, samplesPerChannel, planes, capacity,
+                                 mixStage == MixStage::Kernel ? &channelMatrix : nullptr);
+    }
+
+    if (outputSampleRate != conversionInputRate) {
+        return swr_convert(swrContext, planes, capacity, input, samplesPerChannel);
+    }
+
+    if (mixStage == MixStage::Kernel) {
+        return mixFrame(floatInput, samplesPerChannel, planes);
+    }
+
+    if (frame->format == outputSampleFormat && mixStage != MixStage::Swresample) {
+        // Codec already produces the requested format; copy without converting
+        const bool planar = av_sample_fmt_is_planar(outputSampleFormat);
+        const size_t planeBytes = static_cast<size_t>(samplesPerChannel) * pcmFifo.getSampleBytes();
+        for (int plane = 0; plane < (planar ? channels : 1); ++plane) {
+            std::memcpy(planes[plane], input[plane], planeBytes);
+        }
+        return samplesPerChannel;
+    }
+
+    if (frame->format == AV_SAMPLE_FMT_FLTP && outputSampleFormat == AV_SAMPLE_FMT_S16 &&
+        mixStage != MixStage::Swresample) {
+        // Planar float to S16 through a dedicated SIMD kernel
+        if (PcmConvert::FltpToS16Func kernel = PcmConvert::getFltpToS16Kernel(channels)) {
+            kernel(floatInput, reinterpret_cast<int16_t*>(planes[0]), samplesPerChannel);
+            return samplesPerChannel;
+        }
+    }
+
+    return swr_convert(swrContext, planes, samplesPerChannel, input, samplesPerChannel);
+}
+
+int OrbisAudioDecoder::readBuffered(uint8_t* outputBuffer, int outputBufferSize, int* outputSize) {
+    if (!isInitialized) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Decoder not initialized");
+        stats.recordError(DecodeErrorKind::NotInitialized);
+        return -1;
+    }
+
+    if (!outputBuffer || outputBufferSize <= 0 || !outputSize) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Invalid output parameters");
+        stats.recordError(DecodeErrorKind::InvalidInput);
+        return -1;
+    }
+
+    OutputCursor cursor = makeCursor(outputBuffer, outputBufferSize,
+                                     av_sample_fmt_is_planar(outputSampleFormat),
+                                     getPlaneStride(outputBufferSize), fifoChannels,
+                                     pcmFifo.getSampleBytes());
+    uint8_t* planes[kMaxOutputChannels];
+    cursor.getPlanes(planes);
+    cursor.written = static_cast<int>(pcmFifo.read(planes, cursor.getRoom()));
+
+    *outputSize = cursor.written * cursor.sampleBytes * (cursor.planar ? cursor.channels : 1);
+    if (cursor.capacity == 0 && !pcmFifo.isEmpty()) {
+        stats.recordError(DecodeErrorKind::InsufficientBuffer);
+        return -2;
+    }
+    return 0;
 }
 
 bool OrbisAudioDecoder::reset() {
@@ -194,13 +978,93 @@ bool OrbisAudioDecoder::reset() {
         return false;
     }
 
-    // Flush the decoder
-    avcodec_flush_buffers(codecContext);
+    restartCodec();
+    decodedSamples = 0;
+    trimRemaining = 0;
+    aacFramingPending = aacFramingProbe;
+
+    // A fresh chain: a clip replayed from here hits the PCM cache packet by packet
+    cacheChain = cacheSeed;
+    cacheChainValid = true;
+    cacheServedPackets = 0;
     
-    std::cout << "[OrbisAudioDecoder] Decoder reset successfully" << std::endl;
+    LOG_DEBUG("OrbisAudioDecoder", "Decoder reset successfully");
     return true;
 }
 
+void OrbisAudioDecoder::restartCodec() {
+    // Flush the decoder, resampler history and any PCM not yet handed out
+    avcodec_flush_buffers(codecContext);
+    resampler.reset();
+    if (outputSampleRate != conversionInputRate) {
+        swr_init(swrContext);
+    }
+    pcmFifo.clear();
+}
+
+int OrbisAudioDecoder::primeCodec(PacketDecodeRequest* packets, int count, int64_t* droppedSamples) {
+    // Decode with nowhere to write: everything the packets produce is dropped on the way into
+    // the FIFO, but the codec and resampler state they leave behind is kept
+    constexpr int64_t kDropAll = std::numeric_limits<int64_t>::max();
+    trimRemaining = kDropAll;
+    int primedCount = 0;
+    for (int i = 0; i < count; ++i) {
+        PacketDecodeRequest& request = packets[i];
+        request.outputSize = 0;
+        if (!request.packetData || request.packetSize <= 0) {
+            request.result = -1;
+            stats.recordError(DecodeErrorKind::InvalidInput);
+            continue;
+        }
+
+        request.result = sendAndDrain(request.packetData, request.packetSize, nullptr, 0,
+                                      &request.outputSize);
+        if (request.result == 0) {
+            ++primedCount;
+        }
+    }
+    *droppedSamples = kDropAll - trimRemaining;
+    trimRemaining = 0;
+    return primedCount;
+}
+
+int OrbisAudioDecoder::seek(PacketDecodeRequest* primingPackets, int primingCount, int trimSamples) {
+    if (!isInitialized) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Decoder not initialized");
+        stats.recordError(DecodeErrorKind::NotInitialized);
+        return -1;
+    }
+
+    if (primingCount < 0 || (primingCount > 0 && !primingPackets) || trimSamples < 0) {
+        LOG_ERROR_RATELIMITED("OrbisAudioDecoder", "Error: Invalid seek parameters");
+        return -1;
+    }
+
+    reset();
+    if (primingCount > 0 || trimSamples > 0) {
+        // Output no longer follows from the packets since the reset; cache again after the next one
+        cacheChainValid = false;
+    }
+
+    int64_t primedOutput = 0;
+    const int primedCount = primeCodec(primingPackets, primingCount, &primedOutput);
+
+    // Output sample n lines up with codec sample n * inputRate / outputRate counted from the
+    // first priming sample, so the target is the first output at or after codec sample P + T
+    const int64_t targetInput = decodedSamples + trimSamples;
+    int64_t targetOutput = targetInput;
+    if (conversionInputRate > 0 && outputSampleRate != conversionInputRate) {
+        targetOutput = (targetInput * outputSampleRate + conversionInputRate - 1) / conversionInputRate;
+    }
+    trimRemaining = std::max<int64_t>(0, targetOutput - primedOutput);
+
+    LOG_DEBUG("OrbisAudioDecoder", "Seek: primed with %d of %d packets (%lld samples), trimming %lld output samples",
+        primedCount, primingCount, static_cast<long long>(decodedSamples),
+        static_cast<long long>(trimRemaining));
+
+    return primedCount;
+}
+
 void OrbisAudioDecoder::cleanup() {
     if (swrContext) {
         swr_free(&swrContext);
@@ -222,10 +1086,34 @@ void OrbisAudioDecoder::cleanup() {
         codecContext = nullptr;
     }
 
+    inputArena.reset();
+    framePool.reset();
+    pcmFifo.configure(0, 0);
+    fifoChannels = 0;
+    resampler.release();
+    conversionInputRate = 0;
+    conversionInputFormat = AV_SAMPLE_FMT_NONE;
+    conversionChannels = 0;
+    outputSampleRate = 0;
+    mixStage = MixStage::None;
+
     codec = nullptr;
     isInitialized = false;
+    configuredCodecId = AV_CODEC_ID_NONE;
+    configuredSampleRate = 0;
+    configuredChannels = 0;
+    configuredCodecConfig.clear();
+    aacConfig.clear();
+    aacConfigDerived = false;
+    aacFramingProbe = false;
+    aacFramingPending = false;
+    adtsInput = false;
+    outputSampleFormat = AV_SAMPLE_FMT_S16;
+    targetSampleRate = 0;
+    resamplePreset = ResamplePreset::Balanced;
+    channelMatrix.clear();
 
-    std::cout << "[OrbisAudioDecoder] Cleanup completed" << std::endl;
+    LOG_DEBUG("OrbisAudioDecoder", "Cleanup completed");
 }
 
 bool OrbisAudioDecoder::getDecoderInfo(DecoderInfo& info) const {
@@ -233,11 +1121,16 @@ bool OrbisAudioDecoder::getDecoderInfo(DecoderInfo& info) const {
         return false;
     }
 
+    // Rate, layout and format all describe the PCM handed out, not the codec's frames
     info.codecName = codec ? codec->name : "Unknown";
-    info.sampleRate = codecContext->sample_rate;
+    info.sampleRate = outputSampleRate;
     info.channels = codecContext->channels;
-    info.sampleFormat = codecContext->sample_fmt;
+    info.sampleFormat = outputSampleFormat;
     info.channelLayout = codecContext->channel_layout;
+    if (channelMatrix.isActive()) {
+        info.channels = channelMatrix.getOutputChannels();
+        info.channelLayout = av_get_default_channel_layout(info.channels);
+    }
 
     return true;
 }
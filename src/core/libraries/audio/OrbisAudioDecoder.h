@@ -13,7 +13,16 @@ extern "C" {
     #include <libswresample/swresample.h>
 }
 
+#include "ChannelMatrix.h"
+#include "DecoderStats.h"
+#include "FramePool.h"
+#include "InputArena.h"
+#include "PcmFifo.h"
+#include "Resampler.h"
+
+#include <array>
 #include <string>
+#include <vector>
 
 namespace ShadPS4::Audio {
 
@@ -24,10 +33,25 @@ struct DecoderInfo {
     std::string codecName;      // Name of the codec
     int sampleRate;            // Sample rate in Hz
     int channels;              // Number of channels
-    AVSampleFormat sampleFormat; // Sample format
+    AVSampleFormat sampleFormat; // Sample format written to the caller
     uint64_t channelLayout;    // Channel layout
 };
 
+/**
+ * @brief Per-packet descriptor for batched decoding
+ *
+ * Used by OrbisAudioDecoder::decodePackets() to decode several packets in a
+ * single call. The decoder fills in outputSize and result for every entry.
+ */
+struct PacketDecodeRequest {
+    const uint8_t* packetData; // Pointer to compressed audio data
+    int packetSize;            // Size of input packet in bytes
+    uint8_t* outputBuffer;     // Pointer to output PCM buffer
+    int outputBufferSize;      // Size of output buffer in bytes
+    int outputSize;            // Actual output size (filled by decoder)
+    int result;                // 0 on success, negative error code on failure (filled by decoder)
+};
+
 /**
  * @brief FFmpeg-based audio decoder class
  * 
@@ -52,30 +76,123 @@ public:
      * @param codecId FFmpeg codec ID (e.g., AV_CODEC_ID_AAC for M4AAC)
      * @param sampleRate Sample rate in Hz
      * @param channels Number of audio channels
+     * @param outputFormat PCM format written by decodePacket(); one of
+     *        AV_SAMPLE_FMT_S16, S32, FLT or their planar variants
+     * @param codecConfig Codec setup data passed to FFmpeg as extradata
+     *        (e.g. the 12-byte ATRAC9 header or an OpusHead), or nullptr.
+     *        AAC takes an AudioSpecificConfig or an ADTS header, which is
+     *        reduced to its AudioSpecificConfig; without either, an AAC-LC
+     *        config is built from sampleRate and channels and replaced by
+     *        the first packet's ADTS header, if it has one
+     * @param codecConfigSize Size of codecConfig in bytes
+     * @param targetSampleRate Rate of the PCM written by decodePacket(), e.g.
+     *        the host mixer rate; 0 keeps the codec's rate
+     * @param resamplePreset Filter quality used when resampling
+     * @param channelMatrix Remap or downmix applied during conversion; an
+     *        active matrix must take exactly channels inputs
      * @return true if initialization successful, false otherwise
      */
-    bool initialize(AVCodecID codecId, int sampleRate, int channels);
+    bool initialize(AVCodecID codecId, int sampleRate, int channels,
+                    AVSampleFormat outputFormat = AV_SAMPLE_FMT_S16,
+                    const uint8_t* codecConfig = nullptr, int codecConfigSize = 0,
+                    int targetSampleRate = 0,
+                    ResamplePreset resamplePreset = ResamplePreset::Balanced,
+                    const ChannelMatrix& channelMatrix = ChannelMatrix());
 
     /**
      * @brief Decode an audio packet
+     *
+     * Every frame the codec produces for this packet is drained. PCM buffered
+     * from earlier packets is written first, then the new frames, until the
+     * output buffer is full; samples that do not fit stay in an internal FIFO
+     * for the next call (see readBuffered()). Interleaved formats fill the
+     * buffer front to back.
+     * Planar formats split it into one plane per channel, each
+     * getPlaneStride(outputBufferSize) bytes long; outputSize is the total
+     * across all planes, as for interleaved output.
+     *
      * @param packetData Pointer to compressed audio data
      * @param packetSize Size of input packet in bytes
      * @param outputBuffer Pointer to output PCM buffer
      * @param outputBufferSize Size of output buffer in bytes
      * @param outputSize Pointer to store actual output size
-     * @return 0 on success, negative error code on failure
+     * @return 0 on success, -2 if the buffer cannot hold a single sample,
+     *         other negative error code on failure
      */
     int decodePacket(const uint8_t* packetData, int packetSize,
                     uint8_t* outputBuffer, int outputBufferSize, int* outputSize);
 
     /**
-     * @brief Reset the decoder state
+     * @brief Decode several audio packets in one call
+     *
+     * Packets are decoded in order, each into its own output buffer. A failing
+     * packet records its error in its result field and does not stop the batch.
+     *
+     * @param requests Array of packet descriptors
+     * @param count Number of entries in the array
+     * @return Number of packets decoded successfully, negative error code if the
+     *         decoder is not initialized or the arguments are invalid
+     */
+    int decodePackets(PacketDecodeRequest* requests, int count);
+
+    /**
+     * @brief Copy PCM buffered by earlier decode calls without decoding
+     * 
+     * Lets callers with output buffers smaller than a codec frame read the
+     * rest of a frame in arbitrary chunks.
+     * 
+     * @param outputBuffer Pointer to output PCM buffer
+     * @param outputBufferSize Size of output buffer in bytes
+     * @param outputSize Pointer to store actual output size (0 if nothing is buffered)
+     * @return 0 on success, -2 if the buffer cannot hold a single sample,
+     *         -1 if the decoder is not initialized or the arguments are invalid
+     */
+    int readBuffered(uint8_t* outputBuffer, int outputBufferSize, int* outputSize);
+
+    /**
+     * @brief Get the number of buffered samples per channel not yet handed out
+     */
+    int getBufferedSamples() const { return static_cast<int>(pcmFifo.getSize()); }
+
+    /**
+     * @brief Reset the decoder state, discarding buffered PCM
      * @return true if reset successful, false otherwise
      */
     bool reset();
 
+    /**
+     * @brief Restart decoding at a new stream position without reinitializing
+     *
+     * Resets the decoder, then decodes the priming packets (typically the one
+     * or two packets before the target, so the codec's overlap and the
+     * resampler history hold real audio) and drops their output. The first
+     * trimSamples samples the following decode calls produce are dropped as
+     * well, so output starts exactly at the target sample. A loop restart
+     * thus costs a flush and a few packets instead of a new decoder.
+     *
+     * Only packetData and packetSize of the priming packets are read; result
+     * is filled in for each. trimSamples is counted at the codec's rate and
+     * converted to the output rate when resampling.
+     *
+     * @param primingPackets Packets preceding the target, in stream order
+     * @param primingCount Number of priming packets (may be 0)
+     * @param trimSamples Samples per channel to drop after the priming packets
+     * @return Number of priming packets decoded successfully, -1 if the
+     *         decoder is not initialized or the arguments are invalid
+     */
+    int seek(PacketDecodeRequest* primingPackets, int primingCount, int trimSamples);
+
+    /**
+     * @brief Get the number of output samples per channel still to be dropped after a seek
+     */
+    int64_t getPendingTrim() const { return trimRemaining; }
+
     /**
      * @brief Get decoder information
+     *
+     * Sample rate, channels and sample format describe the PCM that
+     * decodePacket() writes: after resampling, mixing and format conversion.
+     *
      * @param info Reference to DecoderInfo structure to fill
      * @return true if info retrieved successfully, false otherwise
      */
@@ -87,12 +204,202 @@ public:
      */
     bool isDecoderInitialized() const { return isInitialized; }
 
+    /**
+     * @brief Select how packet data is staged for the codec
+     * 
+     * InputMode::Copy (default) copies each packet once into a pooled padded
+     * block. InputMode::ZeroCopy wraps the caller's buffer directly; the caller
+     * must guarantee AV_INPUT_BUFFER_PADDING_SIZE readable bytes after every
+     * packet and keep the packet alive until the decode call returns.
+     */
+    void setInputMode(InputMode mode) { inputMode = mode; }
+
+    /**
+     * @brief Get the current input staging mode
+     */
+    InputMode getInputMode() const { return inputMode; }
+
+    /**
+     * @brief Get the decoder's performance counters
+     */
+    DecoderStats& getStats() { return stats; }
+    const DecoderStats& getStats() const { return stats; }
+
+    /**
+     * @brief Get the PCM format written by decodePacket()
+     */
+    AVSampleFormat getOutputSampleFormat() const { return outputSampleFormat; }
+
+    /**
+     * @brief Get the per-channel plane size used for planar output
+     * @param outputBufferSize Size of the caller's output buffer in bytes
+     * @return Plane stride in bytes (a whole number of samples), or
+     *         outputBufferSize for interleaved formats
+     */
+    int getPlaneStride(int outputBufferSize) const;
+
+    /**
+     * @brief Check whether a format can be requested from initialize()
+     */
+    static bool isSupportedOutputFormat(AVSampleFormat format);
+
+    /**
+     * @brief Get the codec ID the decoder was initialized with
+     */
+    AVCodecID getCodecId() const { return configuredCodecId; }
+
+    /**
+     * @brief Get FFmpeg's name of the open codec, or nullptr before initialization
+     */
+    const char* getCodecName() const { return codec ? codec->name : nullptr; }
+
+    /**
+     * @brief Get the process-unique number that tags this decoder's trace spans
+     */
+    uint32_t getTraceId() const { return traceId; }
+
+    /**
+     * @brief Get the sample rate requested at initialization
+     */
+    int getConfiguredSampleRate() const { return configuredSampleRate; }
+
+    /**
+     * @brief Get the channel count requested at initialization
+     */
+    int getConfiguredChannels() const { return configuredChannels; }
+
+    /**
+     * @brief Get the codec setup data passed to initialize()
+     */
+    const std::vector<uint8_t>& getCodecConfig() const { return configuredCodecConfig; }
+
+    /**
+     * @brief Get the target sample rate passed to initialize() (0 = codec rate)
+     */
+    int getTargetSampleRate() const { return targetSampleRate; }
+
+    /**
+     * @brief Get the resampling preset passed to initialize()
+     */
+    ResamplePreset getResamplePreset() const { return resamplePreset; }
+
+    /**
+     * @brief Get the sample rate of the PCM written by decodePacket()
+     * 
+     * The target rate if one was set. Otherwise the codec's rate, which
+     * differs from the configured rate for codecs with a fixed output rate
+     * (Opus always decodes at 48 kHz) or a rate taken from codecConfig (ATRAC9).
+     */
+    int getOutputSampleRate() const { return outputSampleRate; }
+
+    /**
+     * @brief Get the channel matrix passed to initialize()
+     */
+    const ChannelMatrix& getChannelMatrix() const { return channelMatrix; }
+
+    /**
+     * @brief Get the channel count of the PCM written by decodePacket()
+     */
+    int getOutputChannels() const {
+        return channelMatrix.isActive() ? channelMatrix.getOutputChannels() : configuredChannels;
+    }
+
 private:
+    // Packets kept to rebuild codec state after cache hits: AAC overlap needs one,
+    // SBR envelopes and the resampler history a few more
+    static constexpr int kCachePrimingPackets = 4;
+
+    /**
+     * @brief Where the channel matrix is applied for the current conversion
+     */
+    enum class MixStage : uint8_t {
+        None,                       // No matrix
+        RemapPlanes,                // Channel map on planar input: plane pointers are reordered
+        Kernel,                     // SIMD matrix kernel on FLTP input (in the resampler if resampling)
+        Swresample                  // swresample's rematrixing, for everything else
+    };
+
     /**
      * @brief Clean up all allocated resources
      */
     void cleanup();
 
+    /**
+     * @brief Allocate and open a codec context for the current codec
+     * @return The opened context, nullptr on failure
+     */
+    AVCodecContext* openCodec(int sampleRate, int channels, const uint8_t* extradata, int extradataSize);
+
+    /**
+     * @brief Decide from the first AAC packet after a reset whether ADTS headers are stripped
+     *
+     * Without a caller config, an ADTS header also replaces the built
+     * AudioSpecificConfig, reopening the codec if they differ.
+     *
+     * @return false if the codec could not be reopened
+     */
+    bool settleAacFraming(const uint8_t* packetData, int packetSize);
+
+    /**
+     * @brief Set the FIFO layout for frames with the given channel count
+     */
+    void configureFifo(int channels);
+
+    /**
+     * @brief Set up rate and format conversion for frames of this shape
+     * 
+     * Uses the shared polyphase resampler for planar float input when the
+     * rates differ, and swresample for everything else.
+     * 
+     * @return 0 on success, negative error code on failure
+     */
+    int configureConversion(int inputRate, AVSampleFormat inputFormat, int channels);
+
+    /**
+     * @brief Get the samples per channel convertFrame() writes for the current frame
+     */
+    int getConvertedSamples() const;
+
+    /**
+     * @brief Mix planar float input and convert it to the output format block by block
+     * @return Samples per channel written, negative error code on failure
+     */
+    int mixFrame(const float* const* input, int samples, uint8_t** planes);
+
+    /**
+     * @brief Convert the current frame into the output format and rate
+     * @param planes Destination plane pointers (one for interleaved output)
+     * @param capacity Samples per channel that fit in planes
+     * @return Samples per channel written, negative error code on failure
+     */
+    int convertFrame(uint8_t** planes, int capacity);
+
+    /**
+     * @brief Flush the codec, resampler and FIFO, keeping the seek and cache state
+     */
+    void restartCodec();
+
+    /**
+     * @brief Decode packets for their codec and resampler state only, dropping the output
+     * @param droppedSamples Receives the output samples per channel dropped
+     * @return Number of packets decoded successfully
+     */
+    int primeCodec(PacketDecodeRequest* packets, int count, int64_t* droppedSamples);
+
+    /**
+     * @brief Serve a packet from the PCM caches, or decode it and offer the result to them
+     * @return Same as sendAndDrain()
+     */
+    int decodeCached(const uint8_t* packetData, int packetSize,
+                     uint8_t* outputBuffer, int outputBufferSize, int* outputSize);
+
+    /**
+     * @brief Send one packet and drain every decoded frame into the output
+     * @return 0 on success, negative error code on failure
+     */
+    int sendAndDrain(const uint8_t* packetData, int packetSize,
+                     uint8_t* outputBuffer, int outputBufferSize, int* outputSize);
+
     // FFmpeg contexts and structures
     AVCodecContext* codecContext;   // Codec context
     SwrContext* swrContext;         // Software resampler context
@@ -100,8 +407,55 @@ private:
     AVFrame* frame;                 // Frame for decoded data
     AVPacket* packet;               // Packet for input data
 
+    // Input staging
+    InputArena inputArena;          // Padded, pooled packet buffers
+    FramePool framePool;            // Pooled frame buffers (the codec's get_buffer2)
+    InputMode inputMode;            // Copy or zero-copy staging
+
+    // Output staging
+    PcmFifo pcmFifo;                // Converted samples not yet handed out
+    int fifoChannels;               // Channel count of the samples in pcmFifo
+
+    // Rate conversion
+    PolyphaseResampler resampler;   // Shares its filter bank; configured only when resampling FLTP
+    int conversionInputRate;        // Input rate the conversion is set up for
+    AVSampleFormat conversionInputFormat; // Input format the conversion is set up for
+    int conversionChannels;         // Channel count the conversion is set up for
+    int outputSampleRate;           // Rate of the PCM handed out
+    MixStage mixStage;              // Where channelMatrix is applied
+
+    // Seeking
+    int64_t decodedSamples;         // Codec-rate samples per channel decoded since the last reset
+    int64_t trimRemaining;          // Output samples per channel still to drop after a seek
+
+    // PCM caches (see PcmCache.h and PcmDiskCache.h)
+    uint64_t cacheSeed;             // Chain key after a reset, derived from the configuration
+    uint64_t cacheChain;            // Chain key of the last packet handed out
+    bool cacheChainValid;           // Output still follows from the packets since the reset
+    int64_t cacheServedPackets;     // Packets since the reset served from the cache, not the codec
+    std::array<std::vector<uint8_t>, kCachePrimingPackets> cacheRecentPackets; // Ring of the last ones served
+
+    // AAC configuration (see CodecConfig.h)
+    std::vector<uint8_t> aacConfig; // AudioSpecificConfig the codec was opened with
+    bool aacConfigDerived;          // aacConfig was built here, not given by the caller
+    bool aacFramingProbe;           // Framing is decided by the first packet after each reset
+    bool aacFramingPending;         // No packet has decided the framing since the last reset
+    bool adtsInput;                 // Packets carry ADTS headers, skipped before the codec
+
     // State tracking
     bool isInitialized;             // Initialization state
+    DecoderStats stats;             // Performance counters
+    uint32_t traceId;               // Decoder ID in trace spans (see DecodeTrace.h)
+
+    // Requested configuration (used as the decoder pool key)
+    AVCodecID configuredCodecId;    // Codec ID passed to initialize()
+    int configuredSampleRate;       // Sample rate passed to initialize()
+    int configuredChannels;         // Channel count passed to initialize()
+    std::vector<uint8_t> configuredCodecConfig; // Extradata passed to initialize()
+    AVSampleFormat outputSampleFormat; // PCM format written to the caller
+    int targetSampleRate;           // Requested output rate (0 = codec rate)
+    ResamplePreset resamplePreset;  // Filter quality when resampling
+    ChannelMatrix channelMatrix;    // Output remap/downmix (inactive = codec order)
 
     // Disable copy constructor and assignment operator
     OrbisAudioDecoder(const OrbisAudioDecoder&) = delete;
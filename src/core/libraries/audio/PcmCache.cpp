@@ -0,0 +1,165 @@
+/**
+ * @file PcmCache.cpp
+ * @brief Decoded PCM cache for retriggered clips in ShadPS4
+ *
+ * This file implements the chain hash and the budgeted LRU store.
+ */
+
+#include "PcmCache.h"
+#include "common/logging/log.h"
+
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Bookkeeping per entry on top of its PCM: list node, index slot, vector header
+constexpr size_t kEntryOverhead = 96;
+
+uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+} // namespace
+
+PcmCache& PcmCache::getInstance() {
+    static PcmCache instance;
+    return instance;
+}
+
+uint64_t PcmCache::hashBytes(const uint8_t* data, size_t size, uint64_t seed) {
+    // Eight bytes per step; packets are a few hundred bytes, so this stays far below decode cost
+    constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = seed ^ (static_cast<uint64_t>(size) * kMultiplier);
+
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash = (hash ^ word) * kMultiplier;
+        hash ^= hash >> 29;
+    }
+    if (offset < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + offset, size - offset);
+        hash = (hash ^ word) * kMultiplier;
+    }
+    return mix64(hash);
+}
+
+size_t PcmCache::getCost(const Entry& entry) {
+    return entry.data.size() + kEntryOverhead;
+}
+
+void PcmCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    budgetBytes.store(bytes, std::memory_order_relaxed);
+    evictLocked(0);
+    LOG_INFO("PcmCache", "PCM cache budget set to %zu bytes", bytes);
+}
+
+size_t PcmCache::getBudget() const {
+    return budgetBytes.load(std::memory_order_relaxed);
+}
+
+bool PcmCache::lookup(uint64_t key, uint32_t packetSize, uint8_t* const* planes, int planeCount,
+                      int sampleBytes, int capacity, int* samples) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        ++counters.misses;
+        return false;
+    }
+
+    const Entry& entry = *it->second;
+    if (entry.packetSize != packetSize || entry.planeCount != planeCount ||
+        entry.sampleBytes != sampleBytes || entry.samples > capacity) {
+        ++counters.misses;
+        return false;
+    }
+
+    const size_t planeBytes = static_cast<size_t>(entry.samples) * entry.sampleBytes;
+    for (int plane = 0; plane < planeCount; ++plane) {
+        std::memcpy(planes[plane], entry.data.data() + plane * planeBytes, planeBytes);
+    }
+    *samples = entry.samples;
+
+    lru.splice(lru.begin(), lru, it->second);
+    ++counters.hits;
+    return true;
+}
+
+void PcmCache::insert(uint64_t key, uint32_t packetSize, const uint8_t* const* planes, int planeCount,
+                      int sampleBytes, int samples) {
+    const size_t planeBytes = static_cast<size_t>(samples) * sampleBytes;
+    const size_t cost = planeBytes * planeCount + kEntryOverhead;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const size_t budget = budgetBytes.load(std::memory_order_relaxed);
+    if (budget == 0) {
+        return;
+    }
+    if (cost > budget / 4) {
+        ++counters.rejected;
+        return;
+    }
+
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        // Another instance decoded the same chain first
+        bytesUsed -= getCost(*existing->second);
+        lru.erase(existing->second);
+        index.erase(existing);
+    }
+
+    evictLocked(cost);
+
+    lru.push_front(Entry{key, packetSize, planeCount, sampleBytes, samples, {}});
+    Entry& entry = lru.front();
+    entry.data.resize(planeBytes * planeCount);
+    for (int plane = 0; plane < planeCount; ++plane) {
+        std::memcpy(entry.data.data() + plane * planeBytes, planes[plane], planeBytes);
+    }
+    index[key] = lru.begin();
+    bytesUsed += cost;
+    ++counters.insertions;
+}
+
+void PcmCache::evictLocked(size_t bytesNeeded) {
+    const size_t budget = budgetBytes.load(std::memory_order_relaxed);
+    while (!lru.empty() && bytesUsed + bytesNeeded > budget) {
+        const Entry& victim = lru.back();
+        bytesUsed -= getCost(victim);
+        index.erase(victim.key);
+        lru.pop_back();
+        ++counters.evictions;
+    }
+}
+
+void PcmCache::getStats(PcmCacheStats& stats) const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    stats = counters;
+    stats.bytesUsed = bytesUsed;
+    stats.entries = lru.size();
+    stats.budgetBytes = budgetBytes.load(std::memory_order_relaxed);
+}
+
+void PcmCache::resetStats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    counters = PcmCacheStats{};
+}
+
+void PcmCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    lru.clear();
+    index.clear();
+    bytesUsed = 0;
+}
+
+} // namespace ShadPS4::Audio
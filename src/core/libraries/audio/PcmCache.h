@@ -0,0 +1,148 @@
+#pragma once
+
+/**
+ * @file PcmCache.h
+ * @brief Decoded PCM cache for retriggered clips in ShadPS4
+ *
+ * Games restart the same short clips (footsteps, UI clicks, gunfire) over
+ * and over, and every restart runs the codec and the format conversion
+ * again. The cache keeps the converted PCM of recently decoded packets
+ * under a fixed memory budget so a replay is a copy instead of a decode.
+ *
+ * Codecs with overlapping frames produce output that depends on every
+ * packet since the last reset, so entries are keyed by a chain hash: the
+ * decoder configuration seeds it on reset, and each packet's bytes are
+ * folded into the previous key. A clip replayed from a reset therefore hits
+ * packet by packet, while the same bytes in a different context do not.
+ * Hits never reach the codec; if a stream then leaves the cached path, the
+ * decoder re-primes the codec with the last few packets it served from the
+ * cache. When those are all the packets since the reset, the codec state is
+ * exact and caching continues. Otherwise the output only approximates an
+ * uncached decode, so the stream stops using the cache until its next reset.
+ *
+ * The cache is process-wide and disabled (budget 0) by default.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Cache counters, for tuning the budget per title
+ */
+struct PcmCacheStats {
+    uint64_t hits;              // Packets served from the cache
+    uint64_t misses;            // Lookups that had to decode
+    uint64_t insertions;        // Entries added
+    uint64_t evictions;         // Entries dropped to stay within the budget
+    uint64_t rejected;          // Outputs too large to cache
+    uint64_t bytesUsed;         // Current size including per-entry overhead
+    uint64_t entries;           // Current number of entries
+    uint64_t budgetBytes;       // Configured budget (0 = disabled)
+};
+
+/**
+ * @brief Process-wide LRU cache of converted PCM per packet chain
+ */
+class PcmCache {
+public:
+    static PcmCache& getInstance();
+
+    /**
+     * @brief Hash packet bytes into a chain key
+     * @param data Bytes to hash
+     * @param size Number of bytes
+     * @param seed Previous chain key (or the configuration hash after a reset)
+     * @return New chain key
+     */
+    static uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t seed);
+
+    /**
+     * @brief Set the memory budget; 0 disables the cache and frees every entry
+     */
+    void setBudget(size_t bytes);
+
+    size_t getBudget() const;
+
+    /**
+     * @brief Cheap check decoders make before hashing anything
+     */
+    bool isEnabled() const { return budgetBytes.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief Copy a cached output
+     * @param key Chain key of the packet
+     * @param packetSize Size of the packet, checked against the entry
+     * @param planes Destination plane pointers (one for interleaved output)
+     * @param planeCount Number of planes
+     * @param sampleBytes Bytes one sample occupies in one plane
+     * @param capacity Samples per channel that fit in planes
+     * @param samples Receives the samples per channel copied
+     * @return true on a hit, false if the entry is missing or does not fit
+     */
+    bool lookup(uint64_t key, uint32_t packetSize, uint8_t* const* planes, int planeCount,
+                int sampleBytes, int capacity, int* samples);
+
+    /**
+     * @brief Store a packet's output
+     *
+     * Evicts the least recently used entries to make room. Outputs larger
+     * than a quarter of the budget are not cached, so one long stream cannot
+     * flush every short clip.
+     *
+     * @param planes Source plane pointers (one for interleaved output)
+     * @param samples Samples per channel in planes
+     */
+    void insert(uint64_t key, uint32_t packetSize, const uint8_t* const* planes, int planeCount,
+                int sampleBytes, int samples);
+
+    /**
+     * @brief Copy the counters
+     */
+    void getStats(PcmCacheStats& stats) const;
+
+    /**
+     * @brief Zero the hit, miss, insertion, eviction and rejection counters
+     */
+    void resetStats();
+
+    /**
+     * @brief Drop every entry
+     */
+    void clear();
+
+private:
+    PcmCache() = default;
+    ~PcmCache() = default;
+
+    // Disable copy constructor and assignment
+    PcmCache(const PcmCache&) = delete;
+    PcmCache& operator=(const PcmCache&) = delete;
+
+    struct Entry {
+        uint64_t key;
+        uint32_t packetSize;
+        int planeCount;
+        int sampleBytes;
+        int samples;
+        std::vector<uint8_t> data;  // Planes back to back
+    };
+
+    static size_t getCost(const Entry& entry);
+    void evictLocked(size_t bytesNeeded);
+
+    std::atomic<size_t> budgetBytes{0};
+    mutable std::mutex cacheMutex;
+    std::list<Entry> lru;           // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t bytesUsed = 0;
+    PcmCacheStats counters{};       // bytesUsed, entries and budgetBytes are filled on read
+};
+
+} // namespace ShadPS4::Audio
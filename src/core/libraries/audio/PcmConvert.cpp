@@ -0,0 +1,497 @@
+/**
+ * @file PcmConvert.cpp
+ * @brief Planar-float to interleaved PCM conversion kernels for ShadPS4
+ * 
+ * This file implements the scalar and x86 SIMD conversion and channel matrix
+ * kernels together with CPUID-based runtime dispatch.
+ */
+
+#include "PcmConvert.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SHADPS4_PCM_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#if defined(SHADPS4_PCM_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define SHADPS4_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SHADPS4_TARGET(isa)
+#endif
+
+namespace ShadPS4::Audio::PcmConvert {
+
+namespace {
+
+// Same scale and saturation bounds as swresample's FLT->S16 path
+constexpr float kScale = 32768.0f;
+constexpr float kMin = -32768.0f;
+constexpr float kMax = 32767.0f;
+
+// Clamp first so NaN and out-of-range input saturate identically in every variant
+inline int16_t convertSample(float sample) {
+    float scaled = sample * kScale;
+    scaled = scaled > kMin ? scaled : kMin;
+    scaled = scaled < kMax ? scaled : kMax;
+    return static_cast<int16_t>(std::lrintf(scaled));
+}
+
+template <int Channels>
+void convertScalarRange(const float* const* planes, int16_t* output, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        int16_t* frame = output + i * Channels;
+        for (int c = 0; c < Channels; ++c) {
+            frame[c] = convertSample(planes[c][i]);
+        }
+    }
+}
+
+template <int Channels>
+void convertScalar(const float* const* planes, int16_t* output, size_t samples) {
+    convertScalarRange<Channels>(planes, output, 0, samples);
+}
+
+// Most matrix rows are sparse (a downmix row reads 3 of 6 inputs); only the
+// non-zero gains of a row are visited
+constexpr int kMaxMixInputs = 8;
+
+struct MixRow {
+    const float* sources[kMaxMixInputs];
+    float gains[kMaxMixInputs];
+    int count;
+};
+
+inline MixRow makeMixRow(const float* const* input, int inputChannels, const float* gains) {
+    MixRow row;
+    row.count = 0;
+    for (int c = 0; c < inputChannels && c < kMaxMixInputs; ++c) {
+        if (gains[c] != 0.0f) {
+            row.sources[row.count] = input[c];
+            row.gains[row.count] = gains[c];
+            ++row.count;
+        }
+    }
+    return row;
+}
+
+inline void mixScalarRange(const MixRow& row, float* output, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < row.count; ++k) {
+            sum += row.gains[k] * row.sources[k][i];
+        }
+        output[i] = sum;
+    }
+}
+
+void mixScalar(const float* const* input, int inputChannels, float* const* output,
+               int outputChannels, const float* matrix, size_t samples) {
+    for (int o = 0; o < outputChannels; ++o) {
+        const MixRow row = makeMixRow(input, inputChannels, matrix + o * inputChannels);
+        mixScalarRange(row, output[o], 0, samples);
+    }
+}
+
+#ifdef SHADPS4_PCM_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 (8 samples per channel per iteration)
+// ---------------------------------------------------------------------------
+
+inline __m128i convert8Sse2(const float* source) {
+    const __m128 scale = _mm_set1_ps(kScale);
+    const __m128 lo = _mm_set1_ps(kMin);
+    const __m128 hi = _mm_set1_ps(kMax);
+    __m128 a = _mm_mul_ps(_mm_loadu_ps(source), scale);
+    __m128 b = _mm_mul_ps(_mm_loadu_ps(source + 4), scale);
+    a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+    b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+    return _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+}
+
+// Transpose 8 channel rows of 8 samples into 8 sample frames of 8 channels
+inline void transpose8x8(const __m128i rows[8], __m128i frames[8]) {
+    __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]);
+    __m128i a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+    __m128i a2 = _mm_unpacklo_epi16(rows[2], rows[3]);
+    __m128i a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+    __m128i a4 = _mm_unpacklo_epi16(rows[4], rows[5]);
+    __m128i a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+    __m128i a6 = _mm_unpacklo_epi16(rows[6], rows[7]);
+    __m128i a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    frames[0] = _mm_unpacklo_epi64(b0, b4);
+    frames[1] = _mm_unpackhi_epi64(b0, b4);
+    frames[2] = _mm_unpacklo_epi64(b1, b5);
+    frames[3] = _mm_unpackhi_epi64(b1, b5);
+    frames[4] = _mm_unpacklo_epi64(b2, b6);
+    frames[5] = _mm_unpackhi_epi64(b2, b6);
+    frames[6] = _mm_unpacklo_epi64(b3, b7);
+    frames[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// Store 8 interleaved frames for a block of 8 samples
+template <int Channels>
+inline void storeFrames(const __m128i rows[8], int16_t* output) {
+    if constexpr (Channels == 1) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), rows[0]);
+    } else if constexpr (Channels == 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(rows[0], rows[1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 8), _mm_unpackhi_epi16(rows[0], rows[1]));
+    } else {
+        __m128i frames[8];
+        transpose8x8(rows, frames);
+        if constexpr (Channels == 8) {
+            for (int i = 0; i < 8; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 8), frames[i]);
+            }
+        } else {
+            // 6 channels: each 16-byte store spills 4 bytes that the next frame overwrites;
+            // the last frame is stored exactly so nothing is written past the block
+            for (int i = 0; i < 7; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 6), frames[i]);
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 42), frames[7]);
+            int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(frames[7], 8));
+            std::memcpy(output + 46, &tail, sizeof(tail));
+        }
+    }
+}
+
+template <int Channels>
+SHADPS4_TARGET("sse2")
+void convertSse2(const float* const* planes, int16_t* output, size_t samples) {
+    size_t i = 0;
+    __m128i rows[8] = {};
+    for (; i + 8 <= samples; i += 8) {
+        for (int c = 0; c < Channels; ++c) {
+            rows[c] = convert8Sse2(planes[c] + i);
+        }
+        storeFrames<Channels>(rows, output + i * Channels);
+    }
+    convertScalarRange<Channels>(planes, output, i, samples);
+}
+
+SHADPS4_TARGET("sse2")
+void mixSse2(const float* const* input, int inputChannels, float* const* output,
+             int outputChannels, const float* matrix, size_t samples) {
+    for (int o = 0; o < outputChannels; ++o) {
+        const MixRow row = makeMixRow(input, inputChannels, matrix + o * inputChannels);
+        __m128 gains[kMaxMixInputs];
+        for (int k = 0; k < row.count; ++k) {
+            gains[k] = _mm_set1_ps(row.gains[k]);
+        }
+        float* out = output[o];
+        size_t i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < row.count; ++k) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(gains[k], _mm_loadu_ps(row.sources[k] + i)));
+            }
+            _mm_storeu_ps(out + i, sum);
+        }
+        mixScalarRange(row, out, i, samples);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 (16 samples per channel per iteration)
+// ---------------------------------------------------------------------------
+
+SHADPS4_TARGET("avx2")
+inline __m256i convert16Avx2(const float* source) {
+    const __m256 scale = _mm256_set1_ps(kScale);
+    const __m256 lo = _mm256_set1_ps(kMin);
+    const __m256 hi = _mm256_set1_ps(kMax);
+    __m256 a = _mm256_mul_ps(_mm256_loadu_ps(source), scale);
+    __m256 b = _mm256_mul_ps(_mm256_loadu_ps(source + 8), scale);
+    a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+    b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+    // packs works per 128-bit lane; restore sample order afterwards
+    __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+// Store 16 interleaved frames from 16-sample channel rows
+template <int Channels>
+SHADPS4_TARGET("avx2")
+inline void storeFrames16(const __m256i rows[8], int16_t* output) {
+    if constexpr (Channels == 1) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), rows[0]);
+    } else if constexpr (Channels == 2) {
+        __m256i lo = _mm256_unpacklo_epi16(rows[0], rows[1]); // frames 0-3 | 8-11
+        __m256i hi = _mm256_unpackhi_epi16(rows[0], rows[1]); // frames 4-7 | 12-15
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    } else {
+        __m128i low[8] = {};
+        __m128i high[8] = {};
+        for (int c = 0; c < Channels; ++c) {
+            low[c] = _mm256_castsi256_si128(rows[c]);
+            high[c] = _mm256_extracti128_si256(rows[c], 1);
+        }
+        storeFrames<Channels>(low, output);
+        storeFrames<Channels>(high, output + 8 * Channels);
+    }
+}
+
+template <int Channels>
+SHADPS4_TARGET("avx2")
+void convertAvx2(const float* const* planes, int16_t* output, size_t samples) {
+    size_t i = 0;
+    __m256i rows[8] = {};
+    for (; i + 16 <= samples; i += 16) {
+        for (int c = 0; c < Channels; ++c) {
+            rows[c] = convert16Avx2(planes[c] + i);
+        }
+        storeFrames16<Channels>(rows, output + i * Channels);
+    }
+    convertScalarRange<Channels>(planes, output, i, samples);
+}
+
+// Separate multiply and add (no FMA) keeps results identical to the other levels
+SHADPS4_TARGET("avx2")
+void mixAvx2(const float* const* input, int inputChannels, float* const* output,
+             int outputChannels, const float* matrix, size_t samples) {
+    for (int o = 0; o < outputChannels; ++o) {
+        const MixRow row = makeMixRow(input, inputChannels, matrix + o * inputChannels);
+        __m256 gains[kMaxMixInputs];
+        for (int k = 0; k < row.count; ++k) {
+            gains[k] = _mm256_set1_ps(row.gains[k]);
+        }
+        float* out = output[o];
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m256 sum = _mm256_setzero_ps();
+            for (int k = 0; k < row.count; ++k) {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(gains[k], _mm256_loadu_ps(row.sources[k] + i)));
+            }
+            _mm256_storeu_ps(out + i, sum);
+        }
+        mixScalarRange(row, out, i, samples);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512 (16 samples per channel per iteration, saturating narrow)
+// ---------------------------------------------------------------------------
+
+// GCC flags the intentionally undefined pass-through operands inside the
+// AVX-512 intrinsic headers as maybe-uninitialized
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+SHADPS4_TARGET("avx512f,avx2")
+inline __m256i convert16Avx512(const float* source) {
+    const __m512 scale = _mm512_set1_ps(kScale);
+    const __m512 lo = _mm512_set1_ps(kMin);
+    const __m512 hi = _mm512_set1_ps(kMax);
+    __m512 v = _mm512_mul_ps(_mm512_loadu_ps(source), scale);
+    v = _mm512_min_ps(_mm512_max_ps(v, lo), hi);
+    return _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(v));
+}
+
+template <int Channels>
+SHADPS4_TARGET("avx512f,avx2")
+void convertAvx512(const float* const* planes, int16_t* output, size_t samples) {
+    size_t i = 0;
+    __m256i rows[8] = {};
+    for (; i + 16 <= samples; i += 16) {
+        for (int c = 0; c < Channels; ++c) {
+            rows[c] = convert16Avx512(planes[c] + i);
+        }
+        storeFrames16<Channels>(rows, output + i * Channels);
+    }
+    convertScalarRange<Channels>(planes, output, i, samples);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+// ---------------------------------------------------------------------------
+// CPU feature detection
+// ---------------------------------------------------------------------------
+
+void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(info[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t readXcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+SimdLevel detectX86() {
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    bool sse2 = (regs[3] >> 26) & 1;
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool avx = (regs[2] >> 28) & 1;
+    if (!sse2) {
+        return SimdLevel::Scalar;
+    }
+    if (!osxsave || !avx || maxLeaf < 7) {
+        return SimdLevel::SSE2;
+    }
+
+    // The OS must save YMM (and ZMM/opmask) state across context switches
+    uint64_t xcr0 = readXcr0();
+    bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0, regs);
+    bool avx2 = (regs[1] >> 5) & 1;
+    bool avx512f = (regs[1] >> 16) & 1;
+
+    if (avx512f && avx2 && zmmEnabled) {
+        return SimdLevel::AVX512;
+    }
+    if (avx2 && ymmEnabled) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::SSE2;
+}
+
+#endif // SHADPS4_PCM_X86
+
+template <int Channels>
+FltpToS16Func selectKernel(SimdLevel level) {
+    switch (level) {
+#ifdef SHADPS4_PCM_X86
+        case SimdLevel::AVX512:
+            return convertAvx512<Channels>;
+        case SimdLevel::AVX2:
+            return convertAvx2<Channels>;
+        case SimdLevel::SSE2:
+            return convertSse2<Channels>;
+#endif
+        case SimdLevel::Scalar:
+            return convertScalar<Channels>;
+        default:
+            return nullptr;
+    }
+}
+
+std::atomic<int> g_maxSimdLevel{static_cast<int>(SimdLevel::AVX512)};
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#ifdef SHADPS4_PCM_X86
+    static const SimdLevel detected = detectX86();
+    return detected;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel getActiveSimdLevel() {
+    int detected = static_cast<int>(detectSimdLevel());
+    int limit = g_maxSimdLevel.load(std::memory_order_relaxed);
+    return static_cast<SimdLevel>(detected < limit ? detected : limit);
+}
+
+void setMaxSimdLevel(SimdLevel level) {
+    g_maxSimdLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+MixFunc getMixKernel() {
+    return getMixKernel(getActiveSimdLevel());
+}
+
+MixFunc getMixKernel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detectSimdLevel())) {
+        return nullptr;
+    }
+
+    switch (level) {
+#ifdef SHADPS4_PCM_X86
+        case SimdLevel::AVX512:     // Rows are short; 16-wide gains nothing over AVX2
+        case SimdLevel::AVX2:
+            return mixAvx2;
+        case SimdLevel::SSE2:
+            return mixSse2;
+#endif
+        case SimdLevel::Scalar:
+            return mixScalar;
+        default:
+            return nullptr;
+    }
+}
+
+FltpToS16Func getFltpToS16Kernel(int channels) {
+    return getFltpToS16Kernel(channels, getActiveSimdLevel());
+}
+
+FltpToS16Func getFltpToS16Kernel(int channels, SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detectSimdLevel())) {
+        return nullptr;
+    }
+
+    switch (channels) {
+        case 1:
+            return selectKernel<1>(level);
+        case 2:
+            return selectKernel<2>(level);
+        case 6:
+            return selectKernel<6>(level);
+        case 8:
+            return selectKernel<8>(level);
+        default:
+            return nullptr;
+    }
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return "scalar";
+        case SimdLevel::SSE2:
+            return "sse2";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+        default:
+            return "unknown";
+    }
+}
+
+} // namespace ShadPS4::Audio::PcmConvert
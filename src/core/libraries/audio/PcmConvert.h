@@ -0,0 +1,105 @@
+#pragma once
+
+/**
+ * @file PcmConvert.h
+ * @brief Planar-float to interleaved PCM conversion kernels for ShadPS4
+ * 
+ * The native AAC decoder outputs planar float (AV_SAMPLE_FMT_FLTP). These
+ * kernels interleave and saturate that output to signed 16-bit PCM without
+ * going through swresample. Dedicated kernels exist for mono, stereo, 5.1 and
+ * 7.1 in scalar, SSE2, AVX2 and AVX-512 variants; the best variant supported
+ * by the host CPU is selected at runtime via CPUID.
+ * 
+ * Results are bit-exact with swresample's FLT->S16 conversion
+ * (av_clip_int16(lrintf(sample * 32768.0f))) under the default rounding mode.
+ * 
+ * The channel matrix kernel (remap/downmix of planar float) is selected the
+ * same way; every variant accumulates in the same order, so all levels
+ * produce identical results.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ShadPS4::Audio::PcmConvert {
+
+/**
+ * @brief SIMD instruction set levels, in increasing order of capability
+ */
+enum class SimdLevel : int {
+    Scalar = 0,                 // Portable C++ implementation
+    SSE2 = 1,                   // 8 samples per channel per iteration
+    AVX2 = 2,                   // 16 samples per channel per iteration
+    AVX512 = 3                  // 16 samples per channel per iteration, saturating narrow
+};
+
+/**
+ * @brief Planar float to interleaved S16 kernel
+ * @param planes Array of per-channel sample pointers
+ * @param output Interleaved output buffer (samples * channels values)
+ * @param samples Number of samples per channel
+ */
+using FltpToS16Func = void (*)(const float* const* planes, int16_t* output, size_t samples);
+
+/**
+ * @brief Planar float channel matrix kernel
+ * 
+ * output[o][i] = sum of matrix[o * inputChannels + c] * input[c][i] over c.
+ * Output planes must not alias input planes.
+ * 
+ * @param input Array of inputChannels sample pointers
+ * @param inputChannels Number of input channels (at most 8)
+ * @param output Array of outputChannels sample pointers
+ * @param outputChannels Number of output channels
+ * @param matrix Row-major outputChannels x inputChannels gains
+ * @param samples Number of samples per channel
+ */
+using MixFunc = void (*)(const float* const* input, int inputChannels, float* const* output,
+                         int outputChannels, const float* matrix, size_t samples);
+
+/**
+ * @brief Detect the highest SIMD level supported by the CPU and OS
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Get the SIMD level used by getFltpToS16Kernel(int)
+ */
+SimdLevel getActiveSimdLevel();
+
+/**
+ * @brief Limit the SIMD level used for kernel selection (e.g. for testing)
+ * @param level Maximum level; levels the CPU does not support are never used
+ */
+void setMaxSimdLevel(SimdLevel level);
+
+/**
+ * @brief Get a dedicated FLTP->S16 kernel for the active SIMD level
+ * @param channels Channel count (1, 2, 6 or 8)
+ * @return Kernel, or nullptr if no dedicated kernel exists for this layout
+ */
+FltpToS16Func getFltpToS16Kernel(int channels);
+
+/**
+ * @brief Get a dedicated FLTP->S16 kernel for a specific SIMD level
+ * @return Kernel, or nullptr if the layout or level is not available
+ */
+FltpToS16Func getFltpToS16Kernel(int channels, SimdLevel level);
+
+/**
+ * @brief Get the channel matrix kernel for the active SIMD level
+ */
+MixFunc getMixKernel();
+
+/**
+ * @brief Get the channel matrix kernel for a specific SIMD level
+ * @return Kernel, or nullptr if the level is not available
+ */
+MixFunc getMixKernel(SimdLevel level);
+
+/**
+ * @brief Get a printable name for a SIMD level
+ */
+const char* getSimdLevelName(SimdLevel level);
+
+} // namespace ShadPS4::Audio::PcmConvert
@@ -0,0 +1,456 @@
+/**
+ * @file PcmDiskCache.cpp
+ * @brief Persistent decoded PCM cache for ShadPS4
+ *
+ * This file implements mapping and validating the cache file, lookups in the
+ * mapped index, and the atomic rewrite on flush.
+ */
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include "PcmDiskCache.h"
+#include "PcmCache.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'P', 'S', '4', 'P', 'C', 'M', '\0'};
+constexpr uint32_t kByteOrderTag = 0x01020304;
+constexpr size_t kDataAlignment = 16;
+constexpr int kMaxPlanes = 8;
+constexpr int kMaxSampleBytes = 32;     // 8 interleaved channels of 32-bit samples
+
+size_t alignData(size_t size) {
+    return (size + kDataAlignment - 1) & ~(kDataAlignment - 1);
+}
+
+/**
+ * @brief An entry to write: index record plus where its planes come from
+ */
+struct WriteEntry {
+    PcmDiskCacheEntry entry;
+    const uint8_t* data;
+    size_t size;
+};
+
+/**
+ * @brief Flush a stdio stream through to the disk
+ */
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * @brief Make a rename inside a directory durable
+ *
+ * POSIX only persists the new directory entry once the directory itself is
+ * synced. On Windows the rename goes through the NTFS journal and a
+ * directory cannot be opened for syncing, so there is nothing to do.
+ */
+bool syncDirectory(const std::filesystem::path& directory) {
+#ifdef _WIN32
+    (void)directory;
+    return true;
+#else
+    const int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+} // namespace
+
+PcmDiskCache& PcmDiskCache::getInstance() {
+    static PcmDiskCache instance;
+    return instance;
+}
+
+PcmDiskCache::~PcmDiskCache() {
+    // Pending outputs are only written by an explicit close() or flush()
+    std::unique_lock<std::shared_mutex> lock(mapMutex);
+    unmapFile();
+}
+
+bool PcmDiskCache::open(const std::string& path, size_t maxBytes) {
+    if (path.empty() || maxBytes < sizeof(PcmDiskCacheHeader)) {
+        LOG_ERROR("PcmDiskCache", "Error: Invalid PCM cache file or size limit");
+        return false;
+    }
+
+    close();
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mapMutex);
+        filePath = path;
+        maxFileBytes = maxBytes;
+        if (mapFile()) {
+            LOG_INFO("PcmDiskCache", "Mapped PCM cache %s: %zu entries, %zu bytes",
+                path.c_str(), mappedEntryCount, mappedSize);
+        } else {
+            LOG_INFO("PcmDiskCache", "Starting new PCM cache %s", path.c_str());
+        }
+    }
+
+    opened.store(true, std::memory_order_release);
+    return true;
+}
+
+void PcmDiskCache::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    flush();
+    opened.store(false, std::memory_order_release);
+
+    std::unique_lock<std::shared_mutex> lock(mapMutex);
+    unmapFile();
+
+    std::lock_guard<std::mutex> pendingLock(pendingMutex);
+    pending.clear();
+    pendingKeys.clear();
+    pendingBytes = 0;
+}
+
+bool PcmDiskCache::mapFile() {
+    unmapFile();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(PcmDiskCacheHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+    // The view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return false;
+    }
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(PcmDiskCacheHeader))) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    // Lookups jump between clips; readahead would mostly load unused PCM
+    madvise(view, static_cast<size_t>(info.st_size), MADV_RANDOM);
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!validateMapping()) {
+        LOG_WARNING("PcmDiskCache", "Warning: Ignoring invalid or outdated PCM cache %s", filePath.c_str());
+        unmapFile();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const PcmDiskCacheHeader*>(mappedData);
+    mappedIndex = reinterpret_cast<const PcmDiskCacheEntry*>(mappedData + header->headerSize);
+    mappedEntryCount = static_cast<size_t>(header->entryCount);
+    return true;
+}
+
+void PcmDiskCache::unmapFile() {
+    if (mappedData) {
+#ifdef _WIN32
+        UnmapViewOfFile(mappedData);
+#else
+        munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+#endif
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappedIndex = nullptr;
+    mappedEntryCount = 0;
+}
+
+bool PcmDiskCache::validateMapping() const {
+    const auto* header = reinterpret_cast<const PcmDiskCacheHeader*>(mappedData);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kFormatVersion ||
+        header->byteOrderTag != kByteOrderTag || header->codecVersion != avcodec_version() ||
+        header->conversionVersion != kConversionVersion ||
+        header->headerSize != sizeof(PcmDiskCacheHeader)) {
+        return false;
+    }
+
+    // Every offset must stay inside the file, whatever a torn or foreign file contains
+    const uint64_t maxEntries = (mappedSize - sizeof(PcmDiskCacheHeader)) / sizeof(PcmDiskCacheEntry);
+    if (header->entryCount > maxEntries ||
+        header->dataOffset < sizeof(PcmDiskCacheHeader) + header->entryCount * sizeof(PcmDiskCacheEntry) ||
+        header->dataOffset > mappedSize || header->dataSize > mappedSize - header->dataOffset) {
+        return false;
+    }
+
+    const auto* index = reinterpret_cast<const PcmDiskCacheEntry*>(mappedData + header->headerSize);
+    const size_t indexBytes = static_cast<size_t>(header->entryCount) * sizeof(PcmDiskCacheEntry);
+    if (PcmCache::hashBytes(reinterpret_cast<const uint8_t*>(index), indexBytes, 0) != header->indexChecksum) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < header->entryCount; ++i) {
+        const PcmDiskCacheEntry& entry = index[i];
+        if ((i > 0 && entry.key <= index[i - 1].key) || entry.samples < 0 ||
+            entry.planeCount == 0 || entry.planeCount > kMaxPlanes ||
+            entry.sampleBytes == 0 || entry.sampleBytes > kMaxSampleBytes) {
+            return false;
+        }
+        const uint64_t size = static_cast<uint64_t>(entry.samples) * entry.sampleBytes * entry.planeCount;
+        if (entry.dataOffset > header->dataSize || size > header->dataSize - entry.dataOffset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const PcmDiskCacheEntry* PcmDiskCache::findMapped(uint64_t key) const {
+    const PcmDiskCacheEntry* end = mappedIndex + mappedEntryCount;
+    const PcmDiskCacheEntry* it = std::lower_bound(mappedIndex, end, key,
+        [](const PcmDiskCacheEntry& entry, uint64_t value) { return entry.key < value; });
+    return (it != end && it->key == key) ? it : nullptr;
+}
+
+bool PcmDiskCache::lookup(uint64_t key, uint32_t packetSize, uint8_t* const* planes, int planeCount,
+                          int sampleBytes, int capacity, int* samples) {
+    std::shared_lock<std::shared_mutex> lock(mapMutex);
+    const PcmDiskCacheEntry* entry = mappedData ? findMapped(key) : nullptr;
+    if (!entry || entry->packetSize != packetSize || entry->planeCount != planeCount ||
+        entry->sampleBytes != sampleBytes || entry->samples > capacity) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const PcmDiskCacheHeader*>(mappedData);
+    const uint8_t* data = mappedData + header->dataOffset + entry->dataOffset;
+    const size_t planeBytes = static_cast<size_t>(entry->samples) * entry->sampleBytes;
+    for (int plane = 0; plane < planeCount; ++plane) {
+        std::memcpy(planes[plane], data + plane * planeBytes, planeBytes);
+    }
+    *samples = entry->samples;
+
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PcmDiskCache::record(uint64_t key, uint32_t packetSize, const uint8_t* const* planes,
+                          int planeCount, int sampleBytes, int samples) {
+    const size_t planeBytes = static_cast<size_t>(samples) * sampleBytes;
+    const size_t cost = alignData(planeBytes * planeCount) + sizeof(PcmDiskCacheEntry);
+
+    size_t fileBytes;
+    {
+        std::shared_lock<std::shared_mutex> lock(mapMutex);
+        if (mappedData && findMapped(key)) {
+            return;
+        }
+        fileBytes = mappedData ? mappedSize : sizeof(PcmDiskCacheHeader);
+    }
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    if (pendingKeys.count(key)) {
+        return;
+    }
+    if (fileBytes + pendingBytes + cost > maxFileBytes) {
+        droppedOverLimit.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    PendingEntry pendingEntry;
+    pendingEntry.entry = PcmDiskCacheEntry{key, 0, packetSize, samples, static_cast<uint16_t>(planeCount),
+                                           static_cast<uint16_t>(sampleBytes), 0};
+    pendingEntry.data.resize(planeBytes * planeCount);
+    for (int plane = 0; plane < planeCount; ++plane) {
+        std::memcpy(pendingEntry.data.data() + plane * planeBytes, planes[plane], planeBytes);
+    }
+    pending.push_back(std::move(pendingEntry));
+    pendingKeys.insert(key);
+    pendingBytes += cost;
+    recorded.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool PcmDiskCache::flush() {
+    if (!isOpen()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> flushLock(flushMutex);
+    std::vector<PendingEntry> entries;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.empty()) {
+            return true;
+        }
+        entries.swap(pending);
+        pendingKeys.clear();
+        pendingBytes = 0;
+    }
+
+    // Build the new file beside the old one; lookups keep using the old mapping meanwhile
+    const std::string tempPath = filePath + ".tmp";
+    bool written;
+    {
+        std::shared_lock<std::shared_mutex> lock(mapMutex);
+        written = writeFile(tempPath, entries);
+    }
+
+    std::error_code error;
+    if (!written) {
+        LOG_WARNING("PcmDiskCache", "Warning: Failed writing PCM cache %s", tempPath.c_str());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    // Unmap before replacing: Windows cannot rename over a mapped file
+    std::unique_lock<std::shared_mutex> lock(mapMutex);
+    unmapFile();
+    std::filesystem::rename(tempPath, filePath, error);
+    const bool replaced = !error;
+    if (!replaced) {
+        LOG_WARNING("PcmDiskCache", "Warning: Cannot replace PCM cache %s: %s",
+            filePath.c_str(), error.message().c_str());
+        std::filesystem::remove(tempPath, error);
+    } else if (!syncDirectory(std::filesystem::path(filePath).parent_path())) {
+        LOG_WARNING("PcmDiskCache", "Warning: Cannot sync directory of PCM cache %s", filePath.c_str());
+    }
+    const bool mapped = mapFile();
+    LOG_DEBUG("PcmDiskCache", "Flushed %zu entries, cache holds %zu entries (%zu bytes)",
+        entries.size(), mappedEntryCount, mappedSize);
+    return mapped && replaced;
+}
+
+bool PcmDiskCache::writeFile(const std::string& tempPath,
+                             const std::vector<PendingEntry>& pendingEntries) const {
+    // Entries already in the file come first, so a full file keeps what earlier runs stored
+    std::vector<WriteEntry> entries;
+    entries.reserve(mappedEntryCount + pendingEntries.size());
+    size_t totalBytes = sizeof(PcmDiskCacheHeader);
+    if (mappedData) {
+        const auto* header = reinterpret_cast<const PcmDiskCacheHeader*>(mappedData);
+        for (size_t i = 0; i < mappedEntryCount; ++i) {
+            const PcmDiskCacheEntry& entry = mappedIndex[i];
+            const size_t size = static_cast<size_t>(entry.samples) * entry.sampleBytes * entry.planeCount;
+            entries.push_back(WriteEntry{entry, mappedData + header->dataOffset + entry.dataOffset, size});
+            totalBytes += alignData(size) + sizeof(PcmDiskCacheEntry);
+        }
+    }
+    for (const PendingEntry& pendingEntry : pendingEntries) {
+        const size_t cost = alignData(pendingEntry.data.size()) + sizeof(PcmDiskCacheEntry);
+        if (totalBytes + cost > maxFileBytes || (mappedData && findMapped(pendingEntry.entry.key))) {
+            continue;
+        }
+        entries.push_back(WriteEntry{pendingEntry.entry, pendingEntry.data.data(), pendingEntry.data.size()});
+        totalBytes += cost;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const WriteEntry& a, const WriteEntry& b) { return a.entry.key < b.entry.key; });
+
+    std::vector<PcmDiskCacheEntry> index(entries.size());
+    uint64_t dataSize = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        index[i] = entries[i].entry;
+        index[i].dataOffset = dataSize;
+        index[i].reserved = 0;
+        dataSize += alignData(entries[i].size);
+    }
+
+    PcmDiskCacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.byteOrderTag = kByteOrderTag;
+    header.codecVersion = avcodec_version();
+    header.conversionVersion = kConversionVersion;
+    header.headerSize = sizeof(PcmDiskCacheHeader);
+    header.entryCount = index.size();
+    header.dataOffset = alignData(sizeof(PcmDiskCacheHeader) + index.size() * sizeof(PcmDiskCacheEntry));
+    header.dataSize = dataSize;
+    header.indexChecksum = PcmCache::hashBytes(reinterpret_cast<const uint8_t*>(index.data()),
+                                               index.size() * sizeof(PcmDiskCacheEntry), 0);
+
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    static const uint8_t padding[kDataAlignment] = {};
+    const size_t indexEnd = sizeof(PcmDiskCacheHeader) + index.size() * sizeof(PcmDiskCacheEntry);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (index.empty() || std::fwrite(index.data(), sizeof(PcmDiskCacheEntry), index.size(), file) == index.size()) &&
+              std::fwrite(padding, 1, header.dataOffset - indexEnd, file) == header.dataOffset - indexEnd;
+    for (size_t i = 0; ok && i < entries.size(); ++i) {
+        const size_t paddingSize = alignData(entries[i].size) - entries[i].size;
+        ok = (entries[i].size == 0 || std::fwrite(entries[i].data, 1, entries[i].size, file) == entries[i].size) &&
+             std::fwrite(padding, 1, paddingSize, file) == paddingSize;
+    }
+    ok = ok && syncFile(file);
+    return std::fclose(file) == 0 && ok;
+}
+
+void PcmDiskCache::getStats(PcmDiskCacheStats& stats) const {
+    stats = {};
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.recorded = recorded.load(std::memory_order_relaxed);
+    stats.droppedOverLimit = droppedOverLimit.load(std::memory_order_relaxed);
+    {
+        std::shared_lock<std::shared_mutex> lock(mapMutex);
+        stats.mappedEntries = mappedEntryCount;
+        stats.mappedBytes = mappedSize;
+        stats.maxBytes = maxFileBytes;
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    stats.pendingBytes = pendingBytes;
+}
+
+} // namespace ShadPS4::Audio
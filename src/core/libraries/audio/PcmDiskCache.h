@@ -0,0 +1,189 @@
+#pragma once
+
+/**
+ * @file PcmDiskCache.h
+ * @brief Persistent decoded PCM cache for ShadPS4
+ *
+ * Extends the in-memory PcmCache across emulator runs. A title's clips and
+ * streams are stored as decoded, converted PCM under the same chain keys
+ * (configuration hash + every packet since the reset), so a later run
+ * serves a whole asset packet by packet from the file instead of decoding
+ * it. The file is memory-mapped read-only: lookups are a binary search over
+ * the mapped index and a copy from the page cache, with no per-entry heap
+ * state.
+ *
+ * File layout (native byte order, checked through a tag in the header):
+ * a PcmDiskCacheHeader, an index of PcmDiskCacheEntry sorted by key, then
+ * the entries' planes, 16-byte aligned. The whole file is ignored after a
+ * format version bump, with another FFmpeg build, after a change to the
+ * host's own conversion code (kConversionVersion), or if the index checksum
+ * or any entry's range is wrong.
+ *
+ * New outputs are collected in memory and written by flush(): a complete
+ * new file is written next to the old one, synced, and renamed over it, so
+ * a crash at any point leaves either the old or the new file, never a torn
+ * one. On POSIX the directory is synced after the rename as well, so the
+ * rename itself survives a crash.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Header at the start of a cache file
+ */
+struct PcmDiskCacheHeader {
+    char magic[8];              // "SPS4PCM"
+    uint32_t version;           // PcmDiskCache::kFormatVersion
+    uint32_t byteOrderTag;      // 0x01020304 as written by the producer
+    uint32_t codecVersion;      // avcodec_version() of the producer
+    uint32_t conversionVersion; // PcmDiskCache::kConversionVersion of the producer
+    uint32_t reserved;          // Zero
+    uint32_t headerSize;        // sizeof(PcmDiskCacheHeader)
+    uint64_t entryCount;        // Entries in the index
+    uint64_t dataOffset;        // File offset of the first entry's data
+    uint64_t dataSize;          // Bytes of entry data
+    uint64_t indexChecksum;     // PcmCache::hashBytes() of the index
+};
+
+/**
+ * @brief Index record of one cached packet output
+ */
+struct PcmDiskCacheEntry {
+    uint64_t key;               // Chain key (see PcmCache.h)
+    uint64_t dataOffset;        // Offset from the header's dataOffset
+    uint32_t packetSize;        // Compressed packet size, checked on lookup
+    int32_t samples;            // Samples per channel
+    uint16_t planeCount;        // 1 for interleaved output
+    uint16_t sampleBytes;       // Bytes one sample occupies in one plane
+    uint32_t reserved;
+};
+
+/**
+ * @brief Disk cache counters
+ */
+struct PcmDiskCacheStats {
+    uint64_t hits;              // Packets served from the file
+    uint64_t misses;            // Lookups that had to decode
+    uint64_t recorded;          // Outputs collected for the next flush
+    uint64_t droppedOverLimit;  // Outputs not collected because the file would exceed its limit
+    uint64_t mappedEntries;     // Entries in the mapped file
+    uint64_t mappedBytes;       // Size of the mapped file
+    uint64_t pendingBytes;      // Entry data waiting for flush()
+    uint64_t maxBytes;          // File size limit
+};
+
+/**
+ * @brief Process-wide memory-mapped PCM cache file
+ */
+class PcmDiskCache {
+public:
+    static constexpr uint32_t kFormatVersion = 2;
+
+    /**
+     * Version of the host code between the codec and the cached samples:
+     * PcmConvert kernels, the resampler and ChannelMatrix. Bump it whenever
+     * a change there alters output samples, so files written by the older
+     * code are not served.
+     */
+    static constexpr uint32_t kConversionVersion = 1;
+
+    static PcmDiskCache& getInstance();
+
+    /**
+     * @brief Open (or start) a cache file
+     *
+     * An existing valid file is mapped; an invalid or outdated one is
+     * replaced on the next flush().
+     *
+     * @param path Cache file path
+     * @param maxBytes Largest file flush() writes
+     * @return true if the cache is usable, false if the arguments are invalid
+     */
+    bool open(const std::string& path, size_t maxBytes);
+
+    /**
+     * @brief Flush pending outputs and unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return opened.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy a cached output from the mapped file
+     * @return true on a hit, false if the entry is missing or does not fit
+     * @see PcmCache::lookup
+     */
+    bool lookup(uint64_t key, uint32_t packetSize, uint8_t* const* planes, int planeCount,
+                int sampleBytes, int capacity, int* samples);
+
+    /**
+     * @brief Collect a packet output for the next flush()
+     * @see PcmCache::insert
+     */
+    void record(uint64_t key, uint32_t packetSize, const uint8_t* const* planes, int planeCount,
+                int sampleBytes, int samples);
+
+    /**
+     * @brief Write the mapped and pending entries to a new file and map it
+     * @return true if nothing was pending or the file was replaced, false on I/O failure
+     */
+    bool flush();
+
+    /**
+     * @brief Copy the counters
+     */
+    void getStats(PcmDiskCacheStats& stats) const;
+
+private:
+    PcmDiskCache() = default;
+    ~PcmDiskCache();
+
+    // Disable copy constructor and assignment
+    PcmDiskCache(const PcmDiskCache&) = delete;
+    PcmDiskCache& operator=(const PcmDiskCache&) = delete;
+
+    struct PendingEntry {
+        PcmDiskCacheEntry entry;    // dataOffset unused until written
+        std::vector<uint8_t> data;  // Planes back to back
+    };
+
+    bool mapFile();
+    void unmapFile();
+    bool validateMapping() const;
+    const PcmDiskCacheEntry* findMapped(uint64_t key) const;
+    bool writeFile(const std::string& tempPath, const std::vector<PendingEntry>& pendingEntries) const;
+
+    std::atomic<bool> opened{false};
+    std::string filePath;
+    size_t maxFileBytes = 0;
+
+    // Mapped file; readers take mapMutex shared, remapping takes it exclusively
+    mutable std::shared_mutex mapMutex;
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+    const PcmDiskCacheEntry* mappedIndex = nullptr;
+    size_t mappedEntryCount = 0;
+
+    // Outputs waiting for flush()
+    std::mutex flushMutex;          // Serializes flush(); held while the new file is written
+    mutable std::mutex pendingMutex;
+    std::vector<PendingEntry> pending;
+    std::unordered_set<uint64_t> pendingKeys;
+    size_t pendingBytes = 0;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> recorded{0};
+    std::atomic<uint64_t> droppedOverLimit{0};
+};
+
+} // namespace ShadPS4::Audio
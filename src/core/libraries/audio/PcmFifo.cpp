@@ -0,0 +1,81 @@
+/**
+ * @file PcmFifo.cpp
+ * @brief Decoded PCM FIFO for ShadPS4
+ *
+ * This file implements the per-plane linear buffers with lazy compaction
+ * used to carry decoded samples across decode calls.
+ */
+
+#include "PcmFifo.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ShadPS4::Audio {
+
+void PcmFifo::configure(int planeCount, int bytes) {
+    planes.resize(static_cast<size_t>(planeCount > 0 ? planeCount : 0));
+    sampleBytes = bytes;
+    clear();
+}
+
+void PcmFifo::clear() {
+    readPos = 0;
+    writePos = 0;
+}
+
+void PcmFifo::reserve(size_t samples, uint8_t** planePointers) {
+    const size_t needed = (writePos + samples) * sampleBytes;
+
+    if (!planes.empty() && needed > planes[0].size()) {
+        // Move the unread tail to the front before growing
+        if (readPos > 0) {
+            const size_t size = getSize();
+            for (std::vector<uint8_t>& plane : planes) {
+                std::memmove(plane.data(), plane.data() + readPos * sampleBytes, size * sampleBytes);
+            }
+            readPos = 0;
+            writePos = size;
+        }
+
+        const size_t required = (writePos + samples) * sampleBytes;
+        if (required > planes[0].size()) {
+            const size_t capacity = std::max(required, planes[0].size() * 2);
+            for (std::vector<uint8_t>& plane : planes) {
+                plane.resize(capacity);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < planes.size(); ++i) {
+        planePointers[i] = planes[i].data() + writePos * sampleBytes;
+    }
+}
+
+void PcmFifo::commit(size_t samples) {
+    writePos += samples;
+}
+
+size_t PcmFifo::read(uint8_t* const* planePointers, size_t samples) {
+    const size_t count = std::min(samples, getSize());
+    if (count == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < planes.size(); ++i) {
+        std::memcpy(planePointers[i], planes[i].data() + readPos * sampleBytes, count * sampleBytes);
+    }
+    discard(count);
+    return count;
+}
+
+size_t PcmFifo::discard(size_t samples) {
+    const size_t count = std::min(samples, getSize());
+    readPos += count;
+    if (readPos == writePos) {
+        clear();
+    }
+    return count;
+}
+
+} // namespace ShadPS4::Audio
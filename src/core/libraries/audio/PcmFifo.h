@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ * @file PcmFifo.h
+ * @brief Decoded PCM FIFO for ShadPS4
+ *
+ * Holds converted samples that did not fit into the caller's output buffer
+ * so they can be handed out by later calls instead of being dropped. Storage
+ * is one linear buffer per plane (one for interleaved formats, one per
+ * channel for planar formats). Reads advance a cursor; the unread tail is
+ * moved to the front only when a write would otherwise have to grow the
+ * buffer, so steady-state operation does not allocate.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+class PcmFifo {
+public:
+    /**
+     * @brief Set the sample layout and drop any buffered samples
+     * @param planeCount Number of planes (1 for interleaved output)
+     * @param sampleBytes Bytes one sample occupies in one plane
+     *        (channels * bytes per sample for interleaved output)
+     */
+    void configure(int planeCount, int sampleBytes);
+
+    /**
+     * @brief Drop all buffered samples, keeping the layout and storage
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of buffered samples (per channel)
+     */
+    size_t getSize() const { return writePos - readPos; }
+
+    bool isEmpty() const { return writePos == readPos; }
+
+    int getPlaneCount() const { return static_cast<int>(planes.size()); }
+
+    int getSampleBytes() const { return sampleBytes; }
+
+    /**
+     * @brief Make room for samples at the tail
+     * @param samples Number of samples the caller is about to write
+     * @param planePointers Receives one write pointer per plane
+     */
+    void reserve(size_t samples, uint8_t** planePointers);
+
+    /**
+     * @brief Publish samples written after reserve()
+     */
+    void commit(size_t samples);
+
+    /**
+     * @brief Copy samples out of the FIFO
+     * @param planePointers One destination pointer per plane
+     * @param samples Maximum number of samples to copy
+     * @return Number of samples copied
+     */
+    size_t read(uint8_t* const* planePointers, size_t samples);
+
+    /**
+     * @brief Drop the oldest samples
+     * @return Number of samples dropped
+     */
+    size_t discard(size_t samples);
+
+private:
+    std::vector<std::vector<uint8_t>> planes;
+    int sampleBytes = 0;
+    size_t readPos = 0;     // In samples
+    size_t writePos = 0;    // In samples
+};
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,329 @@
+/**
+ * @file Resampler.cpp
+ * @brief Polyphase sample rate conversion for ShadPS4
+ *
+ * This file implements the shared filter bank cache and the per-stream
+ * resampler that filters and converts to the output PCM format in one pass.
+ */
+
+#include "Resampler.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+namespace ShadPS4::Audio {
+
+namespace {
+
+// Largest L a shared table may use; rarer ratios fall back to swresample
+constexpr int kMaxPhases = 1024;
+
+constexpr double kPi = 3.14159265358979323846;
+
+/**
+ * @brief Filter design parameters of a preset
+ */
+struct PresetDesign {
+    int taps;                   // Coefficients per phase
+    double kaiserBeta;          // Window shape; larger trades transition width for stopband depth
+    double cutoff;              // Cutoff as a fraction of the lower of the two Nyquist rates
+};
+
+PresetDesign getDesign(ResamplePreset preset) {
+    switch (preset) {
+    case ResamplePreset::Fast: return {8, 5.0, 0.80};
+    case ResamplePreset::High: return {32, 9.0, 0.95};
+    case ResamplePreset::Balanced:
+    default: return {16, 7.0, 0.90};
+    }
+}
+
+/**
+ * @brief Zeroth-order modified Bessel function of the first kind
+ */
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = x / 2.0;
+    for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+    }
+    return sum;
+}
+
+struct FilterKey {
+    int upFactor;
+    int downFactor;
+    ResamplePreset preset;
+
+    bool operator<(const FilterKey& other) const {
+        if (upFactor != other.upFactor) return upFactor < other.upFactor;
+        if (downFactor != other.downFactor) return downFactor < other.downFactor;
+        return preset < other.preset;
+    }
+};
+
+std::mutex g_filterMutex;
+std::map<FilterKey, std::weak_ptr<const PolyphaseFilter>> g_filters;
+
+/**
+ * @brief Output sample writers for the fused conversion
+ *
+ * S16 matches swresample and PcmConvert (lrintf of sample * 32768, clipped).
+ */
+struct StoreS16 {
+    static constexpr bool kPlanar = false;
+    static void store(uint8_t* plane, size_t index, float sample) {
+        long value = lrintf(sample * 32768.0f);
+        reinterpret_cast<int16_t*>(plane)[index] =
+            static_cast<int16_t>(std::clamp<long>(value, INT16_MIN, INT16_MAX));
+    }
+};
+
+struct StoreS32 {
+    static constexpr bool kPlanar = false;
+    static void store(uint8_t* plane, size_t index, float sample) {
+        long long value = llrint(static_cast<double>(sample) * 2147483648.0);
+        reinterpret_cast<int32_t*>(plane)[index] =
+            static_cast<int32_t>(std::clamp<long long>(value, INT32_MIN, INT32_MAX));
+    }
+};
+
+struct StoreF32 {
+    static constexpr bool kPlanar = false;
+    static void store(uint8_t* plane, size_t index, float sample) {
+        reinterpret_cast<float*>(plane)[index] = sample;
+    }
+};
+
+template <typename Base>
+struct Planar : Base {
+    static constexpr bool kPlanar = true;
+};
+
+} // namespace
+
+PolyphaseFilter::PolyphaseFilter(int upFactor, int downFactor, ResamplePreset preset)
+    : upFactor(upFactor), downFactor(downFactor), taps(0), preset(preset) {
+    const PresetDesign design = getDesign(preset);
+    taps = design.taps;
+
+    // Prototype low-pass at L times the input rate, cut at the lower Nyquist rate. Centering it
+    // on tap taps/2 of phase 0 delays the output by exactly taps/2 input samples.
+    const int length = taps * upFactor;
+    const double cutoff = design.cutoff * std::min(1.0, static_cast<double>(upFactor) / downFactor);
+    const double center = length / 2.0;
+    const double windowNorm = besselI0(design.kaiserBeta);
+
+    std::vector<double> prototype(static_cast<size_t>(length));
+    for (int n = 0; n < length; ++n) {
+        const double t = (n - center) / upFactor;   // Distance in input samples
+        const double sinc = (t == 0.0) ? 1.0 : std::sin(kPi * cutoff * t) / (kPi * cutoff * t);
+        const double ratio = (n - center) / (center > 0 ? center : 1.0);
+        const double window = besselI0(design.kaiserBeta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / windowNorm;
+        prototype[n] = cutoff * sinc * window;
+    }
+
+    // Split into phases; phase p tap j weights input sample (newest - j), stored oldest first.
+    // Every phase is normalized to unity DC gain so no phase adds ripple to a constant signal.
+    coefficients.resize(static_cast<size_t>(length));
+    for (int p = 0; p < upFactor; ++p) {
+        double sum = 0.0;
+        for (int j = 0; j < taps; ++j) {
+            sum += prototype[static_cast<size_t>(j) * upFactor + p];
+        }
+        float* phaseTaps = coefficients.data() + static_cast<size_t>(p) * taps;
+        for (int j = 0; j < taps; ++j) {
+            const double value = prototype[static_cast<size_t>(j) * upFactor + p];
+            phaseTaps[taps - 1 - j] = static_cast<float>(sum != 0.0 ? value / sum : 0.0);
+        }
+    }
+}
+
+std::shared_ptr<const PolyphaseFilter> PolyphaseFilter::get(int inputRate, int outputRate,
+                                                            ResamplePreset preset) {
+    if (inputRate <= 0 || outputRate <= 0) {
+        return nullptr;
+    }
+
+    const int divisor = std::gcd(inputRate, outputRate);
+    const FilterKey key{outputRate / divisor, inputRate / divisor, preset};
+    if (key.upFactor > kMaxPhases) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(g_filterMutex);
+    std::weak_ptr<const PolyphaseFilter>& slot = g_filters[key];
+    if (std::shared_ptr<const PolyphaseFilter> existing = slot.lock()) {
+        return existing;
+    }
+
+    auto filter = std::make_shared<const PolyphaseFilter>(key.upFactor, key.downFactor, preset);
+    slot = filter;
+    LOG_DEBUG("Resampler", "Built %d-phase filter bank for %d -> %d Hz (%d taps)",
+        key.upFactor, inputRate, outputRate, filter->getTaps());
+
+    // Drop entries whose banks are gone so odd ratios do not accumulate
+    for (auto it = g_filters.begin(); it != g_filters.end();) {
+        it = it->second.expired() ? g_filters.erase(it) : std::next(it);
+    }
+    return filter;
+}
+
+size_t PolyphaseFilter::getCachedCount() {
+    std::lock_guard<std::mutex> lock(g_filterMutex);
+    size_t count = 0;
+    for (const auto& entry : g_filters) {
+        count += entry.second.expired() ? 0 : 1;
+    }
+    return count;
+}
+
+PolyphaseResampler::PolyphaseResampler()
+    : outputFormat(AV_SAMPLE_FMT_NONE), channels(0), phase(0), pending(0) {}
+
+bool PolyphaseResampler::configure(std::shared_ptr<const PolyphaseFilter> newFilter, int newChannels,
+                                   AVSampleFormat newOutputFormat) {
+    switch (newOutputFormat) {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32P:
+    case AV_SAMPLE_FMT_FLTP:
+        break;
+    default:
+        return false;
+    }
+    if (!newFilter || newChannels <= 0) {
+        return false;
+    }
+
+    filter = std::move(newFilter);
+    channels = newChannels;
+    outputFormat = newOutputFormat;
+    history.resize(static_cast<size_t>(channels));
+    reset();
+    return true;
+}
+
+void PolyphaseResampler::release() {
+    filter.reset();
+    history.clear();
+    channels = 0;
+    pending = 0;
+    phase = 0;
+}
+
+void PolyphaseResampler::reset() {
+    // Prime with silence so output sample 0 lines up with input sample 0 (the filter delay is
+    // taps/2 samples counted from the sample before the newest one in the window)
+    phase = 0;
+    pending = filter ? static_cast<size_t>(filter->getTaps() / 2 - 1) : 0;
+    for (std::vector<float>& channelHistory : history) {
+        if (channelHistory.size() < pending) {
+            channelHistory.resize(pending);
+        }
+        std::fill(channelHistory.begin(), channelHistory.begin() + pending, 0.0f);
+    }
+}
+
+int PolyphaseResampler::getOutputSamples(int inputSamples) const {
+    if (!filter) {
+        return 0;
+    }
+    // Output n is produced while its window, starting at (phase + n * M) / L, fits in the input
+    const int64_t available = static_cast<int64_t>(pending) + inputSamples;
+    const int taps = filter->getTaps();
+    if (available < taps) {
+        return 0;
+    }
+    return static_cast<int>(((available - taps + 1) * filter->getUpFactor() - 1 - phase) /
+                            filter->getDownFactor() + 1);
+}
+
+template <typename Store>
+int PolyphaseResampler::run(uint8_t** planes, int capacity) {
+    const int taps = filter->getTaps();
+    const int upFactor = filter->getUpFactor();
+    const int downFactor = filter->getDownFactor();
+
+    size_t position = 0;
+    int produced = 0;
+    while (produced < capacity && position + taps <= pending) {
+        const float* coefficients = filter->getPhase(phase);
+        for (int ch = 0; ch < channels; ++ch) {
+            const float* window = history[ch].data() + position;
+            float sum = 0.0f;
+            for (int j = 0; j < taps; ++j) {
+                sum += coefficients[j] * window[j];
+            }
+            if constexpr (Store::kPlanar) {
+                Store::store(planes[ch], static_cast<size_t>(produced), sum);
+            } else {
+                Store::store(planes[0], static_cast<size_t>(produced) * channels + ch, sum);
+            }
+        }
+        ++produced;
+
+        phase += downFactor;
+        position += static_cast<size_t>(phase / upFactor);
+        phase %= upFactor;
+    }
+
+    // Keep the unconsumed tail for the next call
+    if (position > 0) {
+        for (std::vector<float>& channelHistory : history) {
+            std::memmove(channelHistory.data(), channelHistory.data() + position,
+                         (pending - position) * sizeof(float));
+        }
+        pending -= position;
+    }
+    return produced;
+}
+
+int PolyphaseResampler::process(const float* const* input, int inputSamples, uint8_t** planes,
+                                int capacity, const ChannelMatrix* matrix) {
+    if (!filter || inputSamples < 0 || capacity < 0 ||
+        (matrix && matrix->getOutputChannels() != channels)) {
+        return 0;
+    }
+
+    // History only grows to the largest frame seen, so steady-state decoding does not allocate
+    float* tails[ChannelMatrix::kMaxChannels];
+    for (int ch = 0; ch < channels; ++ch) {
+        std::vector<float>& channelHistory = history[ch];
+        if (channelHistory.size() < pending + inputSamples) {
+            channelHistory.resize(pending + inputSamples);
+        }
+        if (matrix) {
+            tails[ch] = channelHistory.data() + pending;
+        } else {
+            std::memcpy(channelHistory.data() + pending, input[ch],
+                        static_cast<size_t>(inputSamples) * sizeof(float));
+        }
+    }
+    if (matrix) {
+        // Mix on the way into the history; only the output channels are filtered
+        matrix->mix(input, tails, static_cast<size_t>(inputSamples));
+    }
+    pending += static_cast<size_t>(inputSamples);
+
+    switch (outputFormat) {
+    case AV_SAMPLE_FMT_S16:  return run<StoreS16>(planes, capacity);
+    case AV_SAMPLE_FMT_S32:  return run<StoreS32>(planes, capacity);
+    case AV_SAMPLE_FMT_FLT:  return run<StoreF32>(planes, capacity);
+    case AV_SAMPLE_FMT_S16P: return run<Planar<StoreS16>>(planes, capacity);
+    case AV_SAMPLE_FMT_S32P: return run<Planar<StoreS32>>(planes, capacity);
+    case AV_SAMPLE_FMT_FLTP: return run<Planar<StoreF32>>(planes, capacity);
+    default: return 0;
+    }
+}
+
+} // namespace ShadPS4::Audio
@@ -0,0 +1,144 @@
+#pragma once
+
+/**
+ * @file Resampler.h
+ * @brief Polyphase sample rate conversion for ShadPS4
+ *
+ * Converts decoded planar float PCM to the host mixer rate inside the
+ * decoder, in the same pass that converts it to the caller's PCM format, so
+ * no separate resampling pass over each voice is needed.
+ *
+ * Filters are windowed-sinc (Kaiser) polyphase banks for a rational ratio
+ * L/M. A bank depends only on the reduced ratio and the quality preset, so
+ * it is built once and shared by every decoder converting at that ratio
+ * (all 44.1 -> 48 kHz streams use the same 160-phase table). Each decoder
+ * only keeps its own history and phase.
+ */
+
+extern "C" {
+    #include <libavutil/samplefmt.h>
+}
+
+#include "ChannelMatrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief Resampling quality presets
+ */
+enum class ResamplePreset : int {
+    Fast = 0,                   // 8 taps per phase, wide transition band
+    Balanced = 1,               // 16 taps per phase (default)
+    High = 2                    // 32 taps per phase, cutoff close to Nyquist
+};
+
+/**
+ * @brief Shared, immutable polyphase filter bank for one ratio and preset
+ */
+class PolyphaseFilter {
+public:
+    /**
+     * @brief Get the shared filter bank for a conversion
+     *
+     * Banks are cached while any decoder uses them.
+     *
+     * @return Filter bank, or nullptr if the reduced ratio needs more
+     *         phases than a shared table is allowed to hold
+     */
+    static std::shared_ptr<const PolyphaseFilter> get(int inputRate, int outputRate,
+                                                      ResamplePreset preset);
+
+    /**
+     * @brief Get the number of filter banks currently alive
+     */
+    static size_t getCachedCount();
+
+    int getUpFactor() const { return upFactor; }
+    int getDownFactor() const { return downFactor; }
+    int getTaps() const { return taps; }
+    ResamplePreset getPreset() const { return preset; }
+
+    /**
+     * @brief Coefficients of one phase, in input order (oldest sample first)
+     */
+    const float* getPhase(int phase) const { return coefficients.data() + static_cast<size_t>(phase) * taps; }
+
+    PolyphaseFilter(int upFactor, int downFactor, ResamplePreset preset);
+
+private:
+    int upFactor;               // L: interpolation factor
+    int downFactor;             // M: decimation factor
+    int taps;                   // Coefficients per phase
+    ResamplePreset preset;
+    std::vector<float> coefficients; // upFactor phases of taps coefficients
+};
+
+/**
+ * @brief Per-stream polyphase resampler with fused output conversion
+ */
+class PolyphaseResampler {
+public:
+    PolyphaseResampler();
+
+    /**
+     * @brief Prepare for a stream
+     * @param filter Shared filter bank from PolyphaseFilter::get()
+     * @param channels Channel count after the channel matrix (if any)
+     * @param outputFormat Format written by process(); S16, S32, FLT or planar variants
+     * @return true if the configuration is supported, false otherwise
+     */
+    bool configure(std::shared_ptr<const PolyphaseFilter> filter, int channels,
+                   AVSampleFormat outputFormat);
+
+    /**
+     * @brief Drop the filter bank and history
+     */
+    void release();
+
+    /**
+     * @brief Discard history, e.g. after a seek
+     */
+    void reset();
+
+    bool isConfigured() const { return filter != nullptr; }
+
+    /**
+     * @brief Exact number of samples per channel process() produces for an input
+     */
+    int getOutputSamples(int inputSamples) const;
+
+    /**
+     * @brief Resample planar float input and write it in the output format
+     *
+     * The last taps/2 input samples are held back until more input arrives.
+     *
+     * @param input One float plane per channel
+     * @param inputSamples Samples per channel in input
+     * @param planes Destination plane pointers (one for interleaved output)
+     * @param capacity Samples per channel that fit in planes; input beyond
+     *        what fits stays buffered for the next call
+     * @param matrix Channel matrix applied while the input is copied into
+     *        the history, or nullptr; its output count must match channels
+     * @return Samples per channel written
+     */
+    int process(const float* const* input, int inputSamples, uint8_t** planes, int capacity,
+                const ChannelMatrix* matrix = nullptr);
+
+private:
+    template <typename Store>
+    int run(uint8_t** planes, int capacity);
+
+    std::shared_ptr<const PolyphaseFilter> filter;
+    AVSampleFormat outputFormat;
+    int channels;
+    int phase;                  // Current phase in [0, upFactor)
+    size_t pending;             // Samples per channel in history
+    std::vector<std::vector<float>> history; // Unconsumed input per channel
+};
+
+} // namespace ShadPS4::Audio
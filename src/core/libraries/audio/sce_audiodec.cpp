@@ -6,11 +6,17 @@
  * the emulator's audio system with the FFmpeg-based decoder.
  */
 
+#include "sce_audiodec.h"
 #include "OrbisAudioDecoder.h"
-#include <iostream>
+#include "DecoderHandleTable.h"
+#include "DecoderPool.h"
+#include "CodecConfig.h"
+#include "DecodeTrace.h"
+#include "common/logging/log.h"
+#include <atomic>
 #include <memory>
-#include <unordered_map>
 #include <mutex>
+#include <vector>
 
 extern "C" {
     #include <libavcodec/avcodec.h>
@@ -18,50 +24,31 @@ extern "C" {
 
 namespace ShadPS4::Audio {
 
-// Global decoder instance management
-static std::unordered_map<int, std::unique_ptr<OrbisAudioDecoder>> g_decoders;
-static std::mutex g_decoderMutex;
-static int g_nextDecoderId = 1;
+// Global decoder instance management (lock-free lookup by generation-tagged handle)
+static DecoderHandleTable g_decoders;
 
-/**
- * @brief SCE Audio Decoder error codes
- */
-enum SceAudioDecError {
-    SCE_AUDIODEC_OK = 0,
-    SCE_AUDIODEC_ERROR_INVALID_PARAM = -1,
-    SCE_AUDIODEC_ERROR_INVALID_STATE = -2,
-    SCE_AUDIODEC_ERROR_INSUFFICIENT_BUFFER = -3,
-    SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED = -4,
-    SCE_AUDIODEC_ERROR_DECODE_FAILED = -5
-};
+// Output rate and resampling quality of decoders created from now on (0: stream's own rate)
+static std::atomic<uint32_t> g_outputSampleRate{0};
+static std::atomic<uint32_t> g_resampleQuality{SCE_AUDIODEC_RESAMPLE_BALANCED};
 
-/**
- * @brief Audio codec types supported by SCE
- */
-enum SceAudioCodecType {
-    SCE_AUDIODEC_TYPE_M4AAC = 0x2001,
-    SCE_AUDIODEC_TYPE_AT9 = 0x2002,
-    SCE_AUDIODEC_TYPE_OPUS = 0x2003
-};
-
-/**
- * @brief Audio decoder configuration structure
- */
-struct SceAudioDecConfig {
-    uint32_t codecType;        // Codec type (SceAudioCodecType)
-    uint32_t sampleRate;       // Sample rate in Hz
-    uint16_t channels;         // Number of channels
-    uint16_t reserved;         // Reserved for alignment
-};
+static ResamplePreset toResamplePreset(uint32_t quality) {
+    switch (quality) {
+    case SCE_AUDIODEC_RESAMPLE_FAST: return ResamplePreset::Fast;
+    case SCE_AUDIODEC_RESAMPLE_HIGH: return ResamplePreset::High;
+    default: return ResamplePreset::Balanced;
+    }
+}
 
-/**
- * @brief Audio decoder instance structure
- */
-struct SceAudioDecInstance {
-    int decoderId;             // Internal decoder ID
-    SceAudioDecConfig config;  // Decoder configuration
-    bool isInitialized;        // Initialization state
-};
+static bool toChannelMixPreset(uint16_t channelMix, ChannelMixPreset& preset) {
+    switch (channelMix) {
+    case SCE_AUDIODEC_CHANNEL_MIX_NONE: preset = ChannelMixPreset::None; return true;
+    case SCE_AUDIODEC_CHANNEL_MIX_PS4_ORDER_71: preset = ChannelMixPreset::Ps4Order71; return true;
+    case SCE_AUDIODEC_CHANNEL_MIX_51_TO_20: preset = ChannelMixPreset::Downmix51To20; return true;
+    case SCE_AUDIODEC_CHANNEL_MIX_71_TO_20: preset = ChannelMixPreset::Downmix71To20; return true;
+    case SCE_AUDIODEC_CHANNEL_MIX_71_TO_51: preset = ChannelMixPreset::Downmix71To51; return true;
+    default: return false;
+    }
+}
 
 } // namespace ShadPS4::Audio
 
@@ -77,53 +64,113 @@ extern "C" {
  */
 int sceAudioDecCreateDecoder(const SceAudioDecConfig* config, SceAudioDecInstance** instance) {
     if (!config || !instance) {
-        std::cerr << "[sceAudioDec] Error: Invalid parameters for CreateDecoder" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for CreateDecoder");
         return SCE_AUDIODEC_ERROR_INVALID_PARAM;
     }
 
-    std::cout << "[sceAudioDec] Creating decoder - Type: 0x" << std::hex << config->codecType 
-              << ", Sample Rate: " << std::dec << config->sampleRate 
-              << ", Channels: " << config->channels << std::endl;
+    LOG_INFO("sceAudioDec", "Creating decoder - Type: 0x%x, Sample Rate: %u, Channels: %u",
+        config->codecType, config->sampleRate, config->channels);
+
+    if (config->codecConfigSize > 0 && !config->codecConfig) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid decoder configuration");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
 
-    // Validate codec type
+    // Validate codec type and derive the decoder configuration
     AVCodecID codecId;
+    int sampleRate = config->sampleRate;
+    int channels = config->channels;
+    const uint8_t* codecConfig = static_cast<const uint8_t*>(config->codecConfig);
+    int codecConfigSize = static_cast<int>(config->codecConfigSize);
+    At9CodecInfo at9Config;
+    AacCodecInfo aacConfig;
     switch (config->codecType) {
-        case SCE_AUDIODEC_TYPE_M4AAC:
+        case SCE_AUDIODEC_TYPE_M4AAC: {
             codecId = AV_CODEC_ID_AAC;
+            if (codecConfigSize > 0 &&
+                (!parseAacConfig(codecConfig, config->codecConfigSize, aacConfig) ||
+                 (aacConfig.channels != 0 && aacConfig.channels != channels))) {
+                LOG_ERROR("sceAudioDec", "Error: AAC config does not match %d channels", channels);
+                return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+            }
+            // Pool by the AudioSpecificConfig, not the first frame's ADTS header with its frame length
+            if (codecConfigSize > 0 && aacConfig.adts) {
+                codecConfig = aacConfig.builtConfig;
+                codecConfigSize = aacConfig.builtConfigSize;
+            }
             break;
+        }
         case SCE_AUDIODEC_TYPE_AT9:
-            std::cerr << "[sceAudioDec] Error: AT9 codec not yet supported" << std::endl;
-            return SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED;
-        case SCE_AUDIODEC_TYPE_OPUS:
-            std::cerr << "[sceAudioDec] Error: OPUS codec not yet supported" << std::endl;
-            return SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED;
+            codecId = AV_CODEC_ID_ATRAC9;
+            if (!parseAt9Config(codecConfig, config->codecConfigSize, at9Config) ||
+                at9Config.channels != channels) {
+                LOG_ERROR("sceAudioDec", "Error: AT9 config does not match %d channels", channels);
+                return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+            }
+            sampleRate = at9Config.sampleRate;
+            codecConfig = at9Config.extradata;
+            codecConfigSize = kAt9ExtradataSize;
+            break;
+        case SCE_AUDIODEC_TYPE_OPUS: {
+            codecId = AV_CODEC_ID_OPUS;
+            int headChannels = channels;
+            if (!isOpusSampleRate(sampleRate) ||
+                (codecConfigSize > 0 && !parseOpusHead(codecConfig, config->codecConfigSize, headChannels)) ||
+                headChannels != channels || (codecConfigSize == 0 && channels > 2)) {
+                LOG_ERROR("sceAudioDec", "Error: Invalid Opus configuration (%d Hz, %d ch)",
+                    sampleRate, channels);
+                return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+            }
+            // Opus decodes at 48 kHz natively; no resampling
+            sampleRate = kOpusDecodeSampleRate;
+            break;
+        }
         default:
-            std::cerr << "[sceAudioDec] Error: Unsupported codec type: 0x" 
-                      << std::hex << config->codecType << std::endl;
+            LOG_ERROR("sceAudioDec", "Error: Unsupported codec type: 0x%x", config->codecType);
             return SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED;
     }
 
-    // Create decoder instance
-    auto decoder = std::make_unique<OrbisAudioDecoder>();
-    if (!decoder->initialize(codecId, config->sampleRate, config->channels)) {
-        std::cerr << "[sceAudioDec] Error: Failed to initialize decoder" << std::endl;
+    // Output channel layout
+    ChannelMixPreset mixPreset;
+    ChannelMatrix channelMatrix;
+    if (!toChannelMixPreset(config->channelMix, mixPreset) || !channelMatrix.setPreset(mixPreset) ||
+        (channelMatrix.isActive() && channelMatrix.getInputChannels() != channels)) {
+        LOG_ERROR("sceAudioDec", "Error: Channel mix %u does not apply to %d channels",
+            config->channelMix, channels);
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    // Take an initialized decoder from the pool
+    auto decoder = DecoderPool::getInstance().acquire(codecId, sampleRate, channels,
+                                                      AV_SAMPLE_FMT_S16, codecConfig,
+                                                      codecConfigSize,
+                                                      static_cast<int>(g_outputSampleRate.load()),
+                                                      toResamplePreset(g_resampleQuality.load()),
+                                                      channelMatrix);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Failed to initialize decoder");
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+
+    // Store decoder in the handle table
+    int decoderId = g_decoders.insert(decoder);
+    if (decoderId == 0) {
+        LOG_ERROR("sceAudioDec", "Error: Too many live decoders");
+        DecoderPool::getInstance().release(std::move(decoder));
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
     // Create SCE instance structure
     auto sceInstance = new SceAudioDecInstance();
     sceInstance->config = *config;
+    sceInstance->config.codecConfig = nullptr;   // Caller's buffer is only valid during this call
+    sceInstance->config.codecConfigSize = 0;
     sceInstance->isInitialized = true;
-
-    // Store decoder with unique ID
-    std::lock_guard<std::mutex> lock(g_decoderMutex);
-    int decoderId = g_nextDecoderId++;
     sceInstance->decoderId = decoderId;
-    g_decoders[decoderId] = std::move(decoder);
 
     *instance = sceInstance;
 
-    std::cout << "[sceAudioDec] Successfully created decoder with ID: " << decoderId << std::endl;
+    LOG_INFO("sceAudioDec", "Successfully created decoder with ID: %d", decoderId);
     return SCE_AUDIODEC_OK;
 }
 
@@ -134,32 +181,30 @@ int sceAudioDecCreateDecoder(const SceAudioDecConfig* config, SceAudioDecInstanc
  */
 int sceAudioDecDeleteDecoder(SceAudioDecInstance* instance) {
     if (!instance) {
-        std::cerr << "[sceAudioDec] Error: Invalid instance for DeleteDecoder" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Invalid instance for DeleteDecoder");
         return SCE_AUDIODEC_ERROR_INVALID_PARAM;
     }
 
-    std::cout << "[sceAudioDec] Deleting decoder with ID: " << instance->decoderId << std::endl;
+    LOG_INFO("sceAudioDec", "Deleting decoder with ID: %d", instance->decoderId);
 
-    // Remove decoder from global map
-    {
-        std::lock_guard<std::mutex> lock(g_decoderMutex);
-        auto it = g_decoders.find(instance->decoderId);
-        if (it != g_decoders.end()) {
-            g_decoders.erase(it);
-        }
-    }
+    // Invalidate the handle; the decoder is retired once in-flight calls finish
+    g_decoders.remove(instance->decoderId);
 
     // Clean up instance
     delete instance;
 
-    std::cout << "[sceAudioDec] Successfully deleted decoder" << std::endl;
+    LOG_INFO("sceAudioDec", "Successfully deleted decoder");
     return SCE_AUDIODEC_OK;
 }
 
 /**
  * @brief Decode an audio packet
+ * 
+ * Samples that do not fit into the output buffer are returned first by the
+ * next call. Passing no input (nullptr, 0) returns only buffered samples.
+ * 
  * @param instance Pointer to the decoder instance
- * @param inputData Pointer to compressed audio data
+ * @param inputData Pointer to compressed audio data, or nullptr to read buffered samples
  * @param inputSize Size of input data in bytes
  * @param outputData Pointer to output PCM buffer
  * @param outputSize Pointer to output buffer size (in/out parameter)
@@ -168,45 +213,56 @@ int sceAudioDecDeleteDecoder(SceAudioDecInstance* instance) {
 int sceAudioDecDecode(SceAudioDecInstance* instance, 
                      const void* inputData, uint32_t inputSize,
                      void* outputData, uint32_t* outputSize) {
-    if (!instance || !inputData || inputSize == 0 || !outputData || !outputSize) {
-        std::cerr << "[sceAudioDec] Error: Invalid parameters for Decode" << std::endl;
+    // The span's result is the SCE code returned, so rejected calls show up as failures
+    TraceSpan span("sceAudioDecDecode", 0, nullptr, static_cast<int32_t>(inputSize));
+    const bool drainOnly = !inputData && inputSize == 0;
+    if (!instance || (!drainOnly && (!inputData || inputSize == 0)) || !outputData || !outputSize) {
+        LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Invalid parameters for Decode");
+        span.setResult(SCE_AUDIODEC_ERROR_INVALID_PARAM);
         return SCE_AUDIODEC_ERROR_INVALID_PARAM;
     }
 
     if (!instance->isInitialized) {
-        std::cerr << "[sceAudioDec] Error: Decoder not initialized" << std::endl;
+        LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Decoder not initialized");
+        span.setResult(SCE_AUDIODEC_ERROR_INVALID_STATE);
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
     // Get decoder instance
-    std::unique_ptr<OrbisAudioDecoder>* decoder = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_decoderMutex);
-        auto it = g_decoders.find(instance->decoderId);
-        if (it == g_decoders.end()) {
-            std::cerr << "[sceAudioDec] Error: Decoder not found for ID: " 
-                      << instance->decoderId << std::endl;
-            return SCE_AUDIODEC_ERROR_INVALID_STATE;
-        }
-        decoder = &(it->second);
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Decoder not found for ID: %d",
+            instance->decoderId);
+        span.setResult(SCE_AUDIODEC_ERROR_INVALID_STATE);
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
+    std::lock_guard<std::mutex> decoderLock(decoder.instanceMutex());
+    span.setDecoder(decoder->getTraceId(), decoder->getCodecName());
 
     // Perform decoding
     int actualOutputSize = 0;
-    int result = (*decoder)->decodePacket(
-        static_cast<const uint8_t*>(inputData), inputSize,
-        static_cast<uint8_t*>(outputData), *outputSize, &actualOutputSize
-    );
-
+    int result = drainOnly
+        ? decoder->readBuffered(static_cast<uint8_t*>(outputData), *outputSize, &actualOutputSize)
+        : decoder->decodePacket(
+              static_cast<const uint8_t*>(inputData), inputSize,
+              static_cast<uint8_t*>(outputData), *outputSize, &actualOutputSize
+          );
+
+    if (result == -2) {
+        LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Output buffer smaller than one sample");
+        span.setResult(SCE_AUDIODEC_ERROR_INSUFFICIENT_BUFFER);
+        return SCE_AUDIODEC_ERROR_INSUFFICIENT_BUFFER;
+    }
     if (result < 0) {
-        std::cerr << "[sceAudioDec] Error: Decode failed with code: " << result << std::endl;
+        LOG_ERROR_RATELIMITED("sceAudioDec", "Error: Decode failed with code: %d", result);
+        span.setResult(SCE_AUDIODEC_ERROR_DECODE_FAILED);
         return SCE_AUDIODEC_ERROR_DECODE_FAILED;
     }
 
     *outputSize = actualOutputSize;
 
-    std::cout << "[sceAudioDec] Successfully decoded " << inputSize 
-              << " bytes to " << actualOutputSize << " bytes" << std::endl;
+    LOG_TRACE("sceAudioDec", "Successfully decoded %u bytes to %d bytes",
+        inputSize, actualOutputSize);
 
     return SCE_AUDIODEC_OK;
 }
@@ -218,35 +274,86 @@ int sceAudioDecDecode(SceAudioDecInstance* instance,
  */
 int sceAudioDecReset(SceAudioDecInstance* instance) {
     if (!instance) {
-        std::cerr << "[sceAudioDec] Error: Invalid instance for Reset" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Invalid instance for Reset");
         return SCE_AUDIODEC_ERROR_INVALID_PARAM;
     }
 
     if (!instance->isInitialized) {
-        std::cerr << "[sceAudioDec] Error: Decoder not initialized" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Decoder not initialized");
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
     // Get decoder instance
-    std::unique_ptr<OrbisAudioDecoder>* decoder = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_decoderMutex);
-        auto it = g_decoders.find(instance->decoderId);
-        if (it == g_decoders.end()) {
-            std::cerr << "[sceAudioDec] Error: Decoder not found for ID: " 
-                      << instance->decoderId << std::endl;
-            return SCE_AUDIODEC_ERROR_INVALID_STATE;
-        }
-        decoder = &(it->second);
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not found for ID: %d", instance->decoderId);
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
+    std::lock_guard<std::mutex> decoderLock(decoder.instanceMutex());
 
     // Reset decoder
-    if (!(*decoder)->reset()) {
-        std::cerr << "[sceAudioDec] Error: Failed to reset decoder" << std::endl;
+    if (!decoder->reset()) {
+        LOG_ERROR("sceAudioDec", "Error: Failed to reset decoder");
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
-    std::cout << "[sceAudioDec] Successfully reset decoder" << std::endl;
+    LOG_DEBUG("sceAudioDec", "Successfully reset decoder");
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Restart the decoder at a new stream position
+ *
+ * Lets a looping voice jump back without recreating its decoder: the
+ * decoder is flushed, primed with the packets before the loop point, and
+ * the next decode calls start trimSamples samples into the following packet.
+ *
+ * @param instance Pointer to the decoder instance
+ * @param primingPackets Packets preceding the target, in stream order
+ * @param primingSizes Size of each priming packet in bytes
+ * @param primingCount Number of priming packets (may be 0)
+ * @param trimSamples Samples per channel, at the codec's rate, to drop after the priming packets
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecSeek(SceAudioDecInstance* instance, const void* const* primingPackets,
+                    const uint32_t* primingSizes, uint32_t primingCount, uint32_t trimSamples) {
+    if (!instance || (primingCount > 0 && (!primingPackets || !primingSizes)) ||
+        primingCount > static_cast<uint32_t>(INT32_MAX) || trimSamples > static_cast<uint32_t>(INT32_MAX)) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for Seek");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    if (!instance->isInitialized) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not initialized");
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not found for ID: %d", instance->decoderId);
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+
+    std::vector<PacketDecodeRequest> requests(primingCount);
+    for (uint32_t i = 0; i < primingCount; ++i) {
+        requests[i] = PacketDecodeRequest{static_cast<const uint8_t*>(primingPackets[i]),
+                                          static_cast<int>(primingSizes[i]), nullptr, 0, 0, 0};
+    }
+
+    std::lock_guard<std::mutex> decoderLock(decoder.instanceMutex());
+    const int primed = decoder->seek(requests.data(), static_cast<int>(primingCount),
+                                     static_cast<int>(trimSamples));
+    if (primed < 0) {
+        LOG_ERROR("sceAudioDec", "Error: Failed to seek decoder");
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+    if (static_cast<uint32_t>(primed) != primingCount) {
+        // The codec state is still usable; the first packets after the seek may just sound off
+        LOG_WARNING("sceAudioDec", "Seek: %u of %u priming packets failed to decode",
+            primingCount - static_cast<uint32_t>(primed), primingCount);
+    }
+
+    LOG_DEBUG("sceAudioDec", "Seek primed with %d packets, trimming %u samples", primed, trimSamples);
     return SCE_AUDIODEC_OK;
 }
 
@@ -258,35 +365,332 @@ int sceAudioDecReset(SceAudioDecInstance* instance) {
  */
 int sceAudioDecGetInfo(SceAudioDecInstance* instance, DecoderInfo* info) {
     if (!instance || !info) {
-        std::cerr << "[sceAudioDec] Error: Invalid parameters for GetInfo" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetInfo");
         return SCE_AUDIODEC_ERROR_INVALID_PARAM;
     }
 
     if (!instance->isInitialized) {
-        std::cerr << "[sceAudioDec] Error: Decoder not initialized" << std::endl;
+        LOG_ERROR("sceAudioDec", "Error: Decoder not initialized");
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
     // Get decoder instance
-    std::unique_ptr<OrbisAudioDecoder>* decoder = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_decoderMutex);
-        auto it = g_decoders.find(instance->decoderId);
-        if (it == g_decoders.end()) {
-            std::cerr << "[sceAudioDec] Error: Decoder not found for ID: " 
-                      << instance->decoderId << std::endl;
-            return SCE_AUDIODEC_ERROR_INVALID_STATE;
-        }
-        decoder = &(it->second);
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not found for ID: %d", instance->decoderId);
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
+    std::lock_guard<std::mutex> decoderLock(decoder.instanceMutex());
 
     // Get decoder information
-    if (!(*decoder)->getDecoderInfo(*info)) {
-        std::cerr << "[sceAudioDec] Error: Failed to get decoder info" << std::endl;
+    if (!decoder->getDecoderInfo(*info)) {
+        LOG_ERROR("sceAudioDec", "Error: Failed to get decoder info");
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Get decoder performance counters
+ * @param instance Pointer to the decoder instance
+ * @param stats Pointer to store the counters
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecGetStats(SceAudioDecInstance* instance, DecoderStatsSnapshot* stats) {
+    if (!instance || !stats) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetStats");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    // Counters are atomic; no need to serialize against in-flight decodes
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not found for ID: %d", instance->decoderId);
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+
+    decoder->getStats().snapshot(*stats);
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Zero decoder performance counters
+ * @param instance Pointer to the decoder instance
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecResetStats(SceAudioDecInstance* instance) {
+    if (!instance) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid instance for ResetStats");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    DecoderRef decoder = g_decoders.acquire(instance->decoderId);
+    if (!decoder) {
+        LOG_ERROR("sceAudioDec", "Error: Decoder not found for ID: %d", instance->decoderId);
         return SCE_AUDIODEC_ERROR_INVALID_STATE;
     }
 
+    decoder->getStats().reset();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Resample the output of decoders created afterwards to a fixed rate
+ *
+ * Lets the mixer take PCM at its own rate straight from the decoder.
+ * Decoders that already exist keep their current output rate.
+ *
+ * @param sampleRate Output rate in Hz, or 0 to output each stream at its own rate
+ * @param quality SceAudioDecResampleQuality
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecSetOutputSampleRate(uint32_t sampleRate, uint32_t quality) {
+    if (sampleRate > 384000 || quality > SCE_AUDIODEC_RESAMPLE_HIGH) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid output rate %u or quality %u", sampleRate, quality);
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    g_outputSampleRate.store(sampleRate);
+    g_resampleQuality.store(quality);
+    LOG_INFO("sceAudioDec", "Output sample rate set to %u Hz (quality %u)", sampleRate, quality);
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Enable the decoded PCM cache for retriggered clips
+ *
+ * Packets replayed from a reset with the same configuration are then copied
+ * from the cache instead of decoded. Shrinking the budget evicts at once.
+ *
+ * @param budgetBytes Memory the cache may use, or 0 to disable and free it
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecSetPcmCacheBudget(uint64_t budgetBytes) {
+    if (budgetBytes > SIZE_MAX) {
+        LOG_ERROR("sceAudioDec", "Error: PCM cache budget too large");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    PcmCache::getInstance().setBudget(static_cast<size_t>(budgetBytes));
     return SCE_AUDIODEC_OK;
 }
 
+/**
+ * @brief Get the PCM cache hit, miss and eviction counters and its usage
+ * @param stats Pointer to store the counters
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecGetPcmCacheStats(PcmCacheStats* stats) {
+    if (!stats) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetPcmCacheStats");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    PcmCache::getInstance().getStats(*stats);
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Zero the PCM cache counters
+ * @return SCE_AUDIODEC_OK
+ */
+int sceAudioDecResetPcmCacheStats() {
+    PcmCache::getInstance().resetStats();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Serve decoded PCM from a cache file kept across runs
+ *
+ * Outputs of packets replayed from a reset are looked up in the mapped file
+ * before decoding; new outputs are added to it on flush or close.
+ *
+ * @param path Cache file, typically one per title
+ * @param maxBytes Largest size the file may grow to
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecOpenPcmDiskCache(const char* path, uint64_t maxBytes) {
+    if (!path || maxBytes > SIZE_MAX ||
+        !PcmDiskCache::getInstance().open(path, static_cast<size_t>(maxBytes))) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for OpenPcmDiskCache");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Write the PCM decoded since the last flush to the cache file
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecFlushPcmDiskCache() {
+    PcmDiskCache& diskCache = PcmDiskCache::getInstance();
+    if (!diskCache.isOpen()) {
+        return SCE_AUDIODEC_ERROR_INVALID_STATE;
+    }
+    return diskCache.flush() ? SCE_AUDIODEC_OK : SCE_AUDIODEC_ERROR_INVALID_STATE;
+}
+
+/**
+ * @brief Flush and close the cache file
+ * @return SCE_AUDIODEC_OK
+ */
+int sceAudioDecClosePcmDiskCache() {
+    PcmDiskCache::getInstance().close();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Get the cache file's hit and miss counters and its size
+ * @param stats Pointer to store the counters
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecGetPcmDiskCacheStats(PcmDiskCacheStats* stats) {
+    if (!stats) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetPcmDiskCacheStats");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    PcmDiskCache::getInstance().getStats(*stats);
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Open an audio asset file (MP4/M4A or ADTS) for streaming decode
+ *
+ * The stream produces S16 PCM at the rate and quality set by
+ * sceAudioDecSetOutputSampleRate.
+ *
+ * @param path Asset file path
+ * @param stream Pointer to store the opened stream
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecOpenStream(const char* path, AssetStream** stream) {
+    if (!path || !stream) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for OpenStream");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    auto assetStream = std::make_unique<AssetStream>();
+    if (!assetStream->open(path, AV_SAMPLE_FMT_S16, static_cast<int>(g_outputSampleRate.load()),
+                           toResamplePreset(g_resampleQuality.load()))) {
+        return SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED;
+    }
+    *stream = assetStream.release();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Decode the next chunk of a stream
+ * @param stream Stream from sceAudioDecOpenStream
+ * @param outputData Buffer for interleaved S16 PCM
+ * @param outputSize In: buffer size in bytes; out: bytes written (0 at the end of the stream)
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecReadStream(AssetStream* stream, void* outputData, uint32_t* outputSize) {
+    if (!stream || !outputData || !outputSize || *outputSize == 0 || *outputSize > INT32_MAX) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for ReadStream");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+
+    int written = 0;
+    int ret = stream->read(static_cast<uint8_t*>(outputData), static_cast<int>(*outputSize), &written);
+    *outputSize = static_cast<uint32_t>(written);
+    if (ret == -2) {
+        return SCE_AUDIODEC_ERROR_INSUFFICIENT_BUFFER;
+    }
+    return ret < 0 ? SCE_AUDIODEC_ERROR_INVALID_STATE : SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Restart a stream from its beginning
+ * @param stream Stream from sceAudioDecOpenStream
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecRewindStream(AssetStream* stream) {
+    if (!stream) {
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    return stream->rewind() ? SCE_AUDIODEC_OK : SCE_AUDIODEC_ERROR_INVALID_STATE;
+}
+
+/**
+ * @brief Get the format of the PCM a stream produces
+ * @param stream Stream from sceAudioDecOpenStream
+ * @param info Pointer to store the stream information
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecGetStreamInfo(AssetStream* stream, DecoderInfo* info) {
+    if (!stream || !info) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetStreamInfo");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    return stream->getInfo(*info) ? SCE_AUDIODEC_OK : SCE_AUDIODEC_ERROR_INVALID_STATE;
+}
+
+/**
+ * @brief Get a stream's decoder counters
+ * @param stream Stream from sceAudioDecOpenStream
+ * @param stats Pointer to store the counters
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecGetStreamStats(AssetStream* stream, DecoderStatsSnapshot* stats) {
+    if (!stream || !stats) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for GetStreamStats");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    return stream->getStats(*stats) ? SCE_AUDIODEC_OK : SCE_AUDIODEC_ERROR_INVALID_STATE;
+}
+
+/**
+ * @brief Close a stream and unmap its file
+ * @param stream Stream from sceAudioDecOpenStream
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecCloseStream(AssetStream* stream) {
+    if (!stream) {
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    delete stream;
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Start recording decode spans, discarding any earlier recording
+ *
+ * Each thread records into its own buffer; see DecodeTrace.h.
+ *
+ * @return SCE_AUDIODEC_OK
+ */
+int sceAudioDecStartTrace() {
+    DecodeTrace::getInstance().start();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Stop recording decode spans; the recording is kept for sceAudioDecDumpTrace
+ * @return SCE_AUDIODEC_OK
+ */
+int sceAudioDecStopTrace() {
+    DecodeTrace::getInstance().stop();
+    return SCE_AUDIODEC_OK;
+}
+
+/**
+ * @brief Write the spans recorded since sceAudioDecStartTrace as Chrome trace JSON
+ *
+ * Recording may continue while the file is written. The file opens in
+ * chrome://tracing or ui.perfetto.dev.
+ *
+ * @param path Output file
+ * @return SCE_AUDIODEC_OK on success, error code on failure
+ */
+int sceAudioDecDumpTrace(const char* path) {
+    if (!path) {
+        LOG_ERROR("sceAudioDec", "Error: Invalid parameters for DumpTrace");
+        return SCE_AUDIODEC_ERROR_INVALID_PARAM;
+    }
+    return DecodeTrace::getInstance().dump(path) ? SCE_AUDIODEC_OK : SCE_AUDIODEC_ERROR_INVALID_STATE;
+}
+
 } // extern "C"
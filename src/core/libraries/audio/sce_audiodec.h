@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file sce_audiodec.h
+ * @brief SCE Audio Decoder interface for ShadPS4
+ * 
+ * Types and entry points of the sceAudioDec front end implemented in
+ * sce_audiodec.cpp.
+ */
+
+#include "OrbisAudioDecoder.h"
+#include "AssetStream.h"
+#include "PcmCache.h"
+#include "PcmDiskCache.h"
+
+#include <cstdint>
+
+namespace ShadPS4::Audio {
+
+/**
+ * @brief SCE Audio Decoder error codes
+ */
+enum SceAudioDecError {
+    SCE_AUDIODEC_OK = 0,
+    SCE_AUDIODEC_ERROR_INVALID_PARAM = -1,
+    SCE_AUDIODEC_ERROR_INVALID_STATE = -2,
+    SCE_AUDIODEC_ERROR_INSUFFICIENT_BUFFER = -3,
+    SCE_AUDIODEC_ERROR_CODEC_NOT_SUPPORTED = -4,
+    SCE_AUDIODEC_ERROR_DECODE_FAILED = -5
+};
+
+/**
+ * @brief Audio codec types supported by SCE
+ */
+enum SceAudioCodecType {
+    SCE_AUDIODEC_TYPE_M4AAC = 0x2001,
+    SCE_AUDIODEC_TYPE_AT9 = 0x2002,
+    SCE_AUDIODEC_TYPE_OPUS = 0x2003
+};
+
+/**
+ * @brief Resampling quality for sceAudioDecSetOutputSampleRate
+ */
+enum SceAudioDecResampleQuality {
+    SCE_AUDIODEC_RESAMPLE_BALANCED = 0,
+    SCE_AUDIODEC_RESAMPLE_FAST = 1,
+    SCE_AUDIODEC_RESAMPLE_HIGH = 2
+};
+
+/**
+ * @brief Output channel layout for SceAudioDecConfig::channelMix
+ */
+enum SceAudioDecChannelMix {
+    SCE_AUDIODEC_CHANNEL_MIX_NONE = 0,          // Codec channel order
+    SCE_AUDIODEC_CHANNEL_MIX_PS4_ORDER_71 = 1,  // 7.1 as L R C LFE Ls Rs Lb Rb
+    SCE_AUDIODEC_CHANNEL_MIX_51_TO_20 = 2,      // Downmix 5.1 to stereo
+    SCE_AUDIODEC_CHANNEL_MIX_71_TO_20 = 3,      // Downmix 7.1 to stereo
+    SCE_AUDIODEC_CHANNEL_MIX_71_TO_51 = 4       // Downmix 7.1 to 5.1
+};
+
+/**
+ * @brief Audio decoder configuration structure
+ */
+struct SceAudioDecConfig {
+    uint32_t codecType;        // Codec type (SceAudioCodecType)
+    uint32_t sampleRate;       // Sample rate in Hz
+    uint16_t channels;         // Number of channels
+    uint16_t channelMix;       // SceAudioDecChannelMix (0: codec order; was reserved)
+    const void* codecConfig;   // AT9: config word (required); OPUS: OpusHead (required above 2 channels);
+                               // M4AAC: AudioSpecificConfig or ADTS header (optional)
+    uint32_t codecConfigSize;  // Size of codecConfig in bytes
+};
+
+/**
+ * @brief Audio decoder instance structure
+ */
+struct SceAudioDecInstance {
+    int decoderId;             // Internal decoder handle (DecoderHandleTable)
+    SceAudioDecConfig config;  // Decoder configuration
+    bool isInitialized;        // Initialization state
+};
+
+} // namespace ShadPS4::Audio
+
+extern "C" {
+
+int sceAudioDecCreateDecoder(const ShadPS4::Audio::SceAudioDecConfig* config,
+                             ShadPS4::Audio::SceAudioDecInstance** instance);
+int sceAudioDecDeleteDecoder(ShadPS4::Audio::SceAudioDecInstance* instance);
+int sceAudioDecDecode(ShadPS4::Audio::SceAudioDecInstance* instance,
+                      const void* inputData, uint32_t inputSize,
+                      void* outputData, uint32_t* outputSize);
+int sceAudioDecReset(ShadPS4::Audio::SceAudioDecInstance* instance);
+int sceAudioDecSeek(ShadPS4::Audio::SceAudioDecInstance* instance,
+                    const void* const* primingPackets, const uint32_t* primingSizes,
+                    uint32_t primingCount, uint32_t trimSamples);
+int sceAudioDecGetInfo(ShadPS4::Audio::SceAudioDecInstance* instance,
+                       ShadPS4::Audio::DecoderInfo* info);
+int sceAudioDecGetStats(ShadPS4::Audio::SceAudioDecInstance* instance,
+                        ShadPS4::Audio::DecoderStatsSnapshot* stats);
+int sceAudioDecResetStats(ShadPS4::Audio::SceAudioDecInstance* instance);
+int sceAudioDecSetOutputSampleRate(uint32_t sampleRate, uint32_t quality);
+int sceAudioDecSetPcmCacheBudget(uint64_t budgetBytes);
+int sceAudioDecGetPcmCacheStats(ShadPS4::Audio::PcmCacheStats* stats);
+int sceAudioDecResetPcmCacheStats();
+int sceAudioDecOpenPcmDiskCache(const char* path, uint64_t maxBytes);
+int sceAudioDecFlushPcmDiskCache();
+int sceAudioDecClosePcmDiskCache();
+int sceAudioDecGetPcmDiskCacheStats(ShadPS4::Audio::PcmDiskCacheStats* stats);
+int sceAudioDecOpenStream(const char* path, ShadPS4::Audio::AssetStream** stream);
+int sceAudioDecReadStream(ShadPS4::Audio::AssetStream* stream, void* outputData, uint32_t* outputSize);
+int sceAudioDecRewindStream(ShadPS4::Audio::AssetStream* stream);
+int sceAudioDecGetStreamInfo(ShadPS4::Audio::AssetStream* stream, ShadPS4::Audio::DecoderInfo* info);
+int sceAudioDecGetStreamStats(ShadPS4::Audio::AssetStream* stream,
+                              ShadPS4::Audio::DecoderStatsSnapshot* stats);
+int sceAudioDecCloseStream(ShadPS4::Audio::AssetStream* stream);
+int sceAudioDecStartTrace();
+int sceAudioDecStopTrace();
+int sceAudioDecDumpTrace(const char* path);
+
+} // extern "C"
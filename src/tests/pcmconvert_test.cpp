@@ -0,0 +1,213 @@
+/**
+ * @file pcmconvert_test.cpp
+ * @brief Bit-exactness test of the PcmConvert kernels against swresample
+ *
+ * Converts the same planar float input with every FLTP->S16 kernel (mono,
+ * stereo, 5.1 and 7.1, at each SIMD level the CPU supports, selected through
+ * setMaxSimdLevel()) and with swr_convert, and requires identical output.
+ * The input covers full scale, values just past it, rounding ties,
+ * denormals, NaN and noise; the sample counts leave every SIMD tail length.
+ *
+ * Inputs stay within +-4.0: swresample's x86 code converts through a 32-bit
+ * integer and only saturates values below 2^31 / 32768 correctly, so beyond
+ * that it is no reference.
+ *
+ * Usage: pcmconvert_test (exit code 0 when every case matches)
+ */
+
+extern "C" {
+    #include <libavutil/avutil.h>
+    #include <libavutil/opt.h>
+    #include <libavutil/samplefmt.h>
+    #include <libswresample/swresample.h>
+}
+
+#include "PcmConvert.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace ShadPS4::Audio;
+
+namespace {
+
+// One past every SIMD block size (8 and 16) and around it, plus a typical AAC frame
+constexpr size_t kSampleCounts[] = {1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 47, 1024, 1031};
+
+constexpr int kChannelCounts[] = {1, 2, 6, 8};
+
+const std::vector<float>& getSpecialValues() {
+    static const std::vector<float> values = {
+        0.0f, -0.0f,
+        1.0f, -1.0f,                                        // Clip to 32767 / exact -32768
+        std::nextafter(1.0f, 2.0f), std::nextafter(-1.0f, -2.0f),
+        std::nextafter(1.0f, 0.0f), std::nextafter(-1.0f, 0.0f),
+        1.0001f, -1.0001f, 1.5f, -1.5f, 4.0f, -4.0f,
+        32767.5f / 32768.0f, -32768.5f / 32768.0f,          // Ties at the saturation bounds
+        0.5f / 32768.0f, 1.5f / 32768.0f, 2.5f / 32768.0f,  // Ties round to even
+        -0.5f / 32768.0f, -1.5f / 32768.0f, -2.5f / 32768.0f,
+        FLT_MIN, -FLT_MIN,
+        std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+        1e-40f, -1e-40f,
+        std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+    };
+    return values;
+}
+
+/**
+ * @brief Fill one channel: special values (rotated per channel) followed by noise in [-1.25, 1.25]
+ */
+void fillChannel(std::vector<float>& plane, int channel) {
+    const std::vector<float>& special = getSpecialValues();
+    uint32_t state = 0x9E3779B9u * static_cast<uint32_t>(channel + 1);
+    for (size_t i = 0; i < plane.size(); ++i) {
+        // Spread the specials so they land in SIMD blocks and in the scalar tails
+        if (i % 3 == 0) {
+            plane[i] = special[(i / 3 + static_cast<size_t>(channel) * 5) % special.size()];
+        } else {
+            state = state * 1664525u + 1013904223u;
+            plane[i] = (static_cast<float>(state >> 8) / 16777216.0f) * 2.5f - 1.25f;
+        }
+    }
+}
+
+/**
+ * @brief FLTP->S16 reference conversion through swresample
+ */
+class SwrReference {
+public:
+    explicit SwrReference(int channels)
+        : context(swr_alloc()) {
+        if (!context) {
+            return;
+        }
+        const int64_t layout = av_get_default_channel_layout(channels);
+        av_opt_set_int(context, "in_channel_layout", layout, 0);
+        av_opt_set_int(context, "out_channel_layout", layout, 0);
+        av_opt_set_int(context, "in_sample_rate", 48000, 0);
+        av_opt_set_int(context, "out_sample_rate", 48000, 0);
+        av_opt_set_sample_fmt(context, "in_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+        av_opt_set_sample_fmt(context, "out_sample_fmt", AV_SAMPLE_FMT_S16, 0);
+        if (swr_init(context) < 0) {
+            swr_free(&context);
+        }
+    }
+
+    ~SwrReference() {
+        swr_free(&context);
+    }
+
+    bool isValid() const { return context != nullptr; }
+
+    bool convert(const float* const* planes, int16_t* output, size_t samples) {
+        uint8_t* out[1] = {reinterpret_cast<uint8_t*>(output)};
+        const uint8_t* in[8];
+        for (int c = 0; c < 8; ++c) {
+            in[c] = reinterpret_cast<const uint8_t*>(planes[c]);
+        }
+        const int count = static_cast<int>(samples);
+        return swr_convert(context, out, count, in, count) == count;
+    }
+
+private:
+    SwrContext* context;
+
+    SwrReference(const SwrReference&) = delete;
+    SwrReference& operator=(const SwrReference&) = delete;
+};
+
+/**
+ * @brief Compare one kernel with swresample over every sample count
+ * @return Number of failed sample counts
+ */
+int checkKernel(PcmConvert::FltpToS16Func kernel, SwrReference& reference, int channels,
+                PcmConvert::SimdLevel level) {
+    int failures = 0;
+    for (size_t samples : kSampleCounts) {
+        std::vector<std::vector<float>> planes(8, std::vector<float>(samples));
+        const float* planePointers[8];
+        for (int c = 0; c < 8; ++c) {
+            fillChannel(planes[c], c);
+            planePointers[c] = planes[c].data();
+        }
+
+        // One guard value past the end catches kernels that store beyond their frames
+        const size_t values = samples * channels;
+        std::vector<int16_t> expected(values);
+        std::vector<int16_t> actual(values + 1, 0x5A5A);
+        if (!reference.convert(planePointers, expected.data(), samples)) {
+            std::printf("FAIL %-6s %d ch, %4zu samples: swr_convert failed\n",
+                        PcmConvert::getSimdLevelName(level), channels, samples);
+            ++failures;
+            continue;
+        }
+        kernel(planePointers, actual.data(), samples);
+
+        size_t mismatch = values;
+        for (size_t i = 0; i < values && mismatch == values; ++i) {
+            if (actual[i] != expected[i]) {
+                mismatch = i;
+            }
+        }
+        if (mismatch != values) {
+            const float input = planes[mismatch % channels][mismatch / channels];
+            std::printf("FAIL %-6s %d ch, %4zu samples: sample %zu channel %zu input %.9g -> %d, swresample %d\n",
+                        PcmConvert::getSimdLevelName(level), channels, samples, mismatch / channels,
+                        mismatch % channels, static_cast<double>(input), actual[mismatch], expected[mismatch]);
+            ++failures;
+        } else if (actual[values] != 0x5A5A) {
+            std::printf("FAIL %-6s %d ch, %4zu samples: wrote past the end of the output\n",
+                        PcmConvert::getSimdLevelName(level), channels, samples);
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    const PcmConvert::SimdLevel detected = PcmConvert::detectSimdLevel();
+    std::printf("CPU supports up to %s\n", PcmConvert::getSimdLevelName(detected));
+
+    int failures = 0;
+    int checked = 0;
+    for (int channels : kChannelCounts) {
+        SwrReference reference(channels);
+        if (!reference.isValid()) {
+            std::printf("FAIL could not set up swresample for %d channels\n", channels);
+            ++failures;
+            continue;
+        }
+
+        for (int l = static_cast<int>(PcmConvert::SimdLevel::Scalar);
+             l <= static_cast<int>(PcmConvert::SimdLevel::AVX512); ++l) {
+            const auto level = static_cast<PcmConvert::SimdLevel>(l);
+            if (level > detected) {
+                std::printf("skip %-6s %d ch: not supported by this CPU\n",
+                            PcmConvert::getSimdLevelName(level), channels);
+                continue;
+            }
+
+            // Go through the same selection the decoder uses
+            PcmConvert::setMaxSimdLevel(level);
+            const PcmConvert::FltpToS16Func kernel = PcmConvert::getFltpToS16Kernel(channels);
+            if (!kernel || PcmConvert::getActiveSimdLevel() != level) {
+                std::printf("FAIL %-6s %d ch: no kernel selected for this level\n",
+                            PcmConvert::getSimdLevelName(level), channels);
+                ++failures;
+                continue;
+            }
+            failures += checkKernel(kernel, reference, channels, level);
+            ++checked;
+        }
+    }
+    PcmConvert::setMaxSimdLevel(PcmConvert::SimdLevel::AVX512);
+
+    std::printf("%d kernels checked, %d failures\n", checked, failures);
+    return failures == 0 && checked > 0 ? 0 : 1;
+}
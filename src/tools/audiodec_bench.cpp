@@ -0,0 +1,537 @@
+/**
+ * @file audiodec_bench.cpp
+ * @brief Codec throughput and latency benchmark for ShadPS4 audio decoding
+ *
+ * Generates AAC test streams in memory with FFmpeg's AAC encoder, then decodes
+ * them through both front ends (sceAudioDecDecode and IAudioPlugin::decode),
+ * sweeping sample rate, channel count and AAC profile. Results are written as
+ * JSON so they can be compared between releases. Each result also reports the
+ * allocations counted on the decoding thread during the timed loop (pool
+ * blocks, plus every C++ allocation in SHADPS4_AUDIO_ALLOC_DEBUG builds),
+ * which should be zero once the decoder is warm.
+ *
+ * Usage: audiodec_bench [--frames N] [--iterations N] [--output file.json]
+ */
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libavutil/avutil.h>
+    #include <libavutil/channel_layout.h>
+}
+
+#include "sce_audiodec.h"
+#include "PcmConvert.h"
+#include "AllocCounter.h"
+#include "plugin_interface.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// AJM front end (ajm_plugin_loader.cpp)
+extern "C" {
+    int sceAjmInstanceCreate();
+    int sceAjmInstanceDestroy();
+    ShadPS4::Audio::IAudioPlugin* sceAjmAcquirePlugin(const char* codecType,
+                                                      const ShadPS4::Audio::AudioFormat* format);
+    void sceAjmReleasePlugin(ShadPS4::Audio::IAudioPlugin* plugin);
+}
+
+using namespace ShadPS4::Audio;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kWarmupPackets = 16;
+constexpr uint32_t kOutputBufferSize = 2048 * 8 * sizeof(int32_t);
+
+enum class AacProfile { LC, HE };
+
+enum class FrontEnd { SceAudioDec, Plugin };
+
+struct BenchConfig {
+    int sampleRate;
+    int channels;
+    AacProfile profile;
+};
+
+struct EncodedStream {
+    std::vector<std::vector<uint8_t>> packets; // ADTS framed
+    int samplesPerPacket = 0;                  // Decoded samples per channel in each packet
+    std::string error;                         // Non-empty if the stream could not be generated
+};
+
+struct BenchResult {
+    BenchConfig config;
+    FrontEnd frontEnd;
+    bool skipped = false;
+    std::string reason;
+    size_t packets = 0;
+    double packetsPerSecond = 0.0;
+    double nsPerSample = 0.0;   // Per decoded sample, all channels of it together
+    int64_t p50 = 0;
+    int64_t p99 = 0;
+    int64_t p999 = 0;
+    int decodeErrors = 0;
+    uint64_t steadyStateAllocations = 0;
+};
+
+const char* profileName(AacProfile profile) {
+    return profile == AacProfile::LC ? "LC" : "HE";
+}
+
+const char* frontEndName(FrontEnd frontEnd) {
+    return frontEnd == FrontEnd::SceAudioDec ? "sceAudioDecDecode" : "IAudioPlugin::decode";
+}
+
+int sampleRateIndex(int sampleRate) {
+    static const int rates[] = {96000, 88200, 64000, 48000, 44100, 32000,
+                                24000, 22050, 16000, 12000, 11025, 8000, 7350};
+    for (int i = 0; i < static_cast<int>(sizeof(rates) / sizeof(rates[0])); ++i) {
+        if (rates[i] == sampleRate) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int channelConfiguration(int channels) {
+    switch (channels) {
+    case 1: return 1;
+    case 2: return 2;
+    case 6: return 6;
+    case 8: return 7;
+    default: return -1;
+    }
+}
+
+/**
+ * @brief Prepend a 7-byte ADTS header (MPEG-4, no CRC) to a raw AAC frame
+ *
+ * HE-AAC is signalled implicitly: the header describes the LC core at half
+ * the output rate and the decoder picks up SBR from the payload.
+ */
+std::vector<uint8_t> frameAdts(const uint8_t* payload, int size, int coreSampleRate, int channels) {
+    const int frameLength = size + 7;
+    const int objectType = 2; // AAC LC
+    const int rateIndex = sampleRateIndex(coreSampleRate);
+    const int channelConfig = channelConfiguration(channels);
+
+    std::vector<uint8_t> frame(frameLength);
+    frame[0] = 0xFF;
+    frame[1] = 0xF1;
+    frame[2] = static_cast<uint8_t>(((objectType - 1) << 6) | (rateIndex << 2) | (channelConfig >> 2));
+    frame[3] = static_cast<uint8_t>(((channelConfig & 3) << 6) | (frameLength >> 11));
+    frame[4] = static_cast<uint8_t>((frameLength >> 3) & 0xFF);
+    frame[5] = static_cast<uint8_t>(((frameLength & 7) << 5) | 0x1F);
+    frame[6] = 0xFC;
+    std::memcpy(frame.data() + 7, payload, size);
+    return frame;
+}
+
+/**
+ * @brief Open an AAC encoder for a configuration
+ * @return Encoder context, or nullptr with error set
+ */
+AVCodecContext* openEncoder(const BenchConfig& config, std::string& error) {
+    // The native encoder only does LC; HE-AAC needs libfdk_aac
+    const AVCodec* encoder = config.profile == AacProfile::LC
+                                 ? avcodec_find_encoder(AV_CODEC_ID_AAC)
+                                 : avcodec_find_encoder_by_name("libfdk_aac");
+    if (!encoder) {
+        error = config.profile == AacProfile::LC ? "AAC encoder not available"
+                                                 : "HE-AAC encoder (libfdk_aac) not available";
+        return nullptr;
+    }
+
+    // Layouts that map onto ADTS channel configurations without a PCE
+    std::vector<uint64_t> layouts;
+    switch (config.channels) {
+    case 6: layouts = {AV_CH_LAYOUT_5POINT1_BACK, AV_CH_LAYOUT_5POINT1}; break;
+    case 8: layouts = {AV_CH_LAYOUT_7POINT1_WIDE_BACK, AV_CH_LAYOUT_7POINT1}; break;
+    default: layouts = {static_cast<uint64_t>(av_get_default_channel_layout(config.channels))}; break;
+    }
+
+    for (uint64_t layout : layouts) {
+        AVCodecContext* context = avcodec_alloc_context3(encoder);
+        if (!context) {
+            error = "Could not allocate encoder context";
+            return nullptr;
+        }
+
+        context->sample_fmt = AV_SAMPLE_FMT_FLTP;
+        context->sample_rate = config.sampleRate;
+        context->channel_layout = layout;
+        context->channels = config.channels;
+        context->bit_rate = (config.profile == AacProfile::LC ? 64000 : 32000) * config.channels;
+        context->profile = config.profile == AacProfile::LC ? FF_PROFILE_AAC_LOW : FF_PROFILE_AAC_HE;
+
+        int ret = avcodec_open2(context, encoder, nullptr);
+        if (ret >= 0) {
+            error.clear();
+            return context;
+        }
+
+        char errorStr[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorStr, sizeof(errorStr));
+        error = std::string("Encoder rejected configuration: ") + errorStr;
+        avcodec_free_context(&context);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Encode a deterministic multi-tone signal into ADTS packets
+ */
+EncodedStream generateStream(const BenchConfig& config, int frames) {
+    EncodedStream stream;
+
+    AVCodecContext* encoder = openEncoder(config, stream.error);
+    if (!encoder) {
+        return stream;
+    }
+
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    const int coreRate = config.profile == AacProfile::HE ? config.sampleRate / 2 : config.sampleRate;
+    stream.samplesPerPacket = encoder->frame_size;
+
+    auto drain = [&]() {
+        while (avcodec_receive_packet(encoder, packet) >= 0) {
+            stream.packets.push_back(frameAdts(packet->data, packet->size, coreRate, config.channels));
+            av_packet_unref(packet);
+        }
+    };
+
+    uint32_t noise = 0x12345678;
+    int64_t position = 0;
+    for (int i = 0; i < frames && frame && packet; ++i) {
+        frame->nb_samples = encoder->frame_size;
+        frame->format = AV_SAMPLE_FMT_FLTP;
+        frame->channel_layout = encoder->channel_layout;
+        frame->channels = config.channels;
+        frame->sample_rate = config.sampleRate;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            stream.error = "Could not allocate encoder frame";
+            break;
+        }
+
+        // A different tone per channel plus a little noise keeps every band busy
+        for (int ch = 0; ch < config.channels; ++ch) {
+            float* plane = reinterpret_cast<float*>(frame->extended_data[ch]);
+            const double frequency = 220.0 * (ch + 1);
+            for (int s = 0; s < frame->nb_samples; ++s) {
+                noise = noise * 1664525u + 1013904223u;
+                const double t = static_cast<double>(position + s) / config.sampleRate;
+                plane[s] = static_cast<float>(0.4 * std::sin(2.0 * kPi * frequency * t) +
+                                              0.05 * (static_cast<int32_t>(noise) / 2147483648.0));
+            }
+        }
+        position += frame->nb_samples;
+
+        int ret = avcodec_send_frame(encoder, frame);
+        av_frame_unref(frame);
+        if (ret < 0) {
+            stream.error = "Encoder rejected frame";
+            break;
+        }
+        drain();
+    }
+
+    // Flush the encoder's delayed packets
+    avcodec_send_frame(encoder, nullptr);
+    drain();
+
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&encoder);
+
+    if (stream.error.empty() && stream.packets.empty()) {
+        stream.error = "Encoder produced no packets";
+    }
+    return stream;
+}
+
+/**
+ * @brief Thin wrapper so both front ends can be timed by the same loop
+ */
+class Decoder {
+public:
+    Decoder(FrontEnd frontEnd, const BenchConfig& config) {
+        if (frontEnd == FrontEnd::SceAudioDec) {
+            SceAudioDecConfig sceConfig{};
+            sceConfig.codecType = SCE_AUDIODEC_TYPE_M4AAC;
+            sceConfig.sampleRate = static_cast<uint32_t>(config.sampleRate);
+            sceConfig.channels = static_cast<uint16_t>(config.channels);
+            if (sceAudioDecCreateDecoder(&sceConfig, &sceInstance) != SCE_AUDIODEC_OK) {
+                sceInstance = nullptr;
+            }
+        } else {
+            AudioFormat format{};
+            format.sampleRate = static_cast<uint32_t>(config.sampleRate);
+            format.channels = static_cast<uint16_t>(config.channels);
+            format.bitsPerSample = 16;
+            format.sampleFormat = SampleFormat::S16;
+            plugin = sceAjmAcquirePlugin("M4AAC", &format);
+        }
+    }
+
+    ~Decoder() {
+        if (sceInstance) {
+            sceAudioDecDeleteDecoder(sceInstance);
+        }
+        if (plugin) {
+            sceAjmReleasePlugin(plugin);
+        }
+    }
+
+    bool isValid() const { return sceInstance || plugin; }
+
+    bool decode(const std::vector<uint8_t>& packet, uint8_t* output) {
+        uint32_t outputSize = kOutputBufferSize;
+        if (sceInstance) {
+            return sceAudioDecDecode(sceInstance, packet.data(), static_cast<uint32_t>(packet.size()),
+                                     output, &outputSize) == SCE_AUDIODEC_OK;
+        }
+        return plugin->decode(packet.data(), static_cast<uint32_t>(packet.size()), output,
+                              kOutputBufferSize, &outputSize) == DecodeResult::Success;
+    }
+
+    void reset() {
+        if (sceInstance) {
+            sceAudioDecReset(sceInstance);
+        } else if (plugin) {
+            plugin->reset();
+        }
+    }
+
+private:
+    SceAudioDecInstance* sceInstance = nullptr;
+    IAudioPlugin* plugin = nullptr;
+};
+
+int64_t percentile(const std::vector<int64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(std::ceil(fraction * sorted.size())) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+BenchResult runBench(const BenchConfig& config, FrontEnd frontEnd, const EncodedStream& stream,
+                     int iterations) {
+    BenchResult result;
+    result.config = config;
+    result.frontEnd = frontEnd;
+
+    if (!stream.error.empty()) {
+        result.skipped = true;
+        result.reason = stream.error;
+        return result;
+    }
+
+    Decoder decoder(frontEnd, config);
+    if (!decoder.isValid()) {
+        result.skipped = true;
+        result.reason = "Decoder creation failed";
+        return result;
+    }
+
+    std::vector<uint8_t> output(kOutputBufferSize);
+
+    // Warm caches, lazy tables and the decoder pool before timing
+    for (size_t i = 0; i < stream.packets.size() && i < static_cast<size_t>(kWarmupPackets); ++i) {
+        decoder.decode(stream.packets[i], output.data());
+    }
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(stream.packets.size() * iterations);
+    int64_t totalNs = 0;
+    const uint64_t allocationsBefore = ShadPS4::Audio::AllocCounter::getThreadCount();
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        decoder.reset();
+        for (const std::vector<uint8_t>& packet : stream.packets) {
+            auto start = std::chrono::steady_clock::now();
+            bool ok = decoder.decode(packet, output.data());
+            auto end = std::chrono::steady_clock::now();
+
+            int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            latencies.push_back(ns);
+            totalNs += ns;
+            if (!ok) {
+                ++result.decodeErrors;
+            }
+        }
+    }
+
+    result.steadyStateAllocations = ShadPS4::Audio::AllocCounter::getThreadCount() - allocationsBefore;
+
+    std::sort(latencies.begin(), latencies.end());
+    result.packets = latencies.size();
+    const double samples = static_cast<double>(result.packets) * stream.samplesPerPacket;
+    result.nsPerSample = samples > 0 ? static_cast<double>(totalNs) / samples : 0.0;
+    result.packetsPerSecond = totalNs > 0 ? result.packets * 1e9 / totalNs : 0.0;
+    result.p50 = percentile(latencies, 0.50);
+    result.p99 = percentile(latencies, 0.99);
+    result.p999 = percentile(latencies, 0.999);
+    return result;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\b':
+                escaped += "\\b";
+                break;
+            case '\f':
+                escaped += "\\f";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    // JSON strings take any other control character only as a \u escape
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+void writeJson(FILE* out, const std::vector<BenchResult>& results, int frames, int iterations) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"audiodec_bench\",\n");
+    std::fprintf(out, "  \"ffmpeg\": \"%s\",\n", jsonEscape(av_version_info()).c_str());
+    std::fprintf(out, "  \"pcm_convert\": \"%s\",\n",
+                 PcmConvert::getSimdLevelName(PcmConvert::getActiveSimdLevel()));
+    std::fprintf(out, "  \"frames\": %d,\n", frames);
+    std::fprintf(out, "  \"iterations\": %d,\n", iterations);
+    std::fprintf(out, "  \"counts_heap\": %s,\n",
+                 ShadPS4::Audio::AllocCounter::isCountingHeap() ? "true" : "false");
+    std::fprintf(out, "  \"results\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(out, "    {\"front_end\": \"%s\", \"profile\": \"%s\", \"sample_rate\": %d, \"channels\": %d, ",
+                     frontEndName(r.frontEnd), profileName(r.config.profile), r.config.sampleRate,
+                     r.config.channels);
+        if (r.skipped) {
+            std::fprintf(out, "\"skipped\": true, \"reason\": \"%s\"}", jsonEscape(r.reason).c_str());
+        } else {
+            std::fprintf(out,
+                         "\"skipped\": false, \"packets\": %zu, \"packets_per_sec\": %.1f, "
+                         "\"ns_per_sample\": %.3f, \"p50_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, "
+                         "\"decode_errors\": %d, \"steady_state_allocations\": %llu}",
+                         r.packets, r.packetsPerSecond, r.nsPerSample, static_cast<long long>(r.p50),
+                         static_cast<long long>(r.p99), static_cast<long long>(r.p999), r.decodeErrors,
+                         static_cast<unsigned long long>(r.steadyStateAllocations));
+        }
+        std::fprintf(out, "%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    std::fprintf(out, "  ]\n}\n");
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--frames N] [--iterations N] [--output file.json]\n", program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = 500;
+    int iterations = 5;
+    const char* outputPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (frames <= 0 || iterations <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Keep per-stream setup messages out of the measurements
+    ShadPS4::Log::setLevel(ShadPS4::Log::Level::Warning);
+
+    if (sceAjmInstanceCreate() != 0) {
+        std::fprintf(stderr, "Failed to initialize AJM plugin system\n");
+        return 1;
+    }
+
+    const int sampleRates[] = {32000, 44100, 48000};
+    const int channelCounts[] = {1, 2, 6, 8};
+    const AacProfile profiles[] = {AacProfile::LC, AacProfile::HE};
+    const FrontEnd frontEnds[] = {FrontEnd::SceAudioDec, FrontEnd::Plugin};
+
+    std::vector<BenchResult> results;
+    for (AacProfile profile : profiles) {
+        for (int sampleRate : sampleRates) {
+            for (int channels : channelCounts) {
+                BenchConfig config{sampleRate, channels, profile};
+                EncodedStream stream = generateStream(config, frames);
+                for (FrontEnd frontEnd : frontEnds) {
+                    BenchResult result = runBench(config, frontEnd, stream, iterations);
+                    std::fprintf(stderr, "%-22s %s %5d Hz %d ch: %s\n", frontEndName(frontEnd),
+                                 profileName(profile), sampleRate, channels,
+                                 result.skipped ? result.reason.c_str() : "done");
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    sceAjmInstanceDestroy();
+
+    FILE* out = stdout;
+    if (outputPath) {
+        out = std::fopen(outputPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "Could not open %s for writing\n", outputPath);
+            return 1;
+        }
+    }
+    writeJson(out, results, frames, iterations);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    ShadPS4::Log::flush();
+    return 0;
+}
@@ -0,0 +1,411 @@
+/**
+ * @file audiodec_bulk.cpp
+ * @brief Parallel bulk decoder for ShadPS4 audio asset directories
+ *
+ * Walks a directory for AAC assets (.aac, .adts, .m4a, .mp4) and decodes
+ * every file through sceAudioDecOpenStream, the same decoders, conversion
+ * and resampling the emulator uses, on all cores. Each worker decodes one
+ * file at a time through a fixed-size PCM buffer that is written out or
+ * hashed as it fills, so memory use does not grow with file length, and
+ * the decoder pool keeps one idle decoder per job, so it does not grow with
+ * the number of files either.
+ * Writes WAV or raw PCM files mirroring the input tree, or only a 64-bit
+ * FNV-1a checksum of each file's PCM, and reports throughput, the slowest
+ * files and every failure.
+ *
+ * Usage: audiodec_bulk <directory> [--jobs N] [--wav DIR | --pcm DIR]
+ *        [--rate HZ] [--slowest N] [--output report.json]
+ */
+
+#include "sce_audiodec.h"
+#include "DecoderPool.h"
+#include "common/logging/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace ShadPS4::Audio;
+
+namespace {
+
+// PCM decoded per read call; one buffer per worker bounds the tool's memory
+constexpr uint32_t kChunkBytes = 256 * 1024;
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+enum class OutputMode {
+    Checksum,   // Hash the PCM only
+    Wav,        // 16-bit PCM WAV per asset
+    Pcm         // Raw interleaved S16 per asset
+};
+
+struct FileResult {
+    fs::path path;
+    bool ok = false;
+    std::string error;
+    uint64_t inputBytes = 0;
+    uint64_t pcmBytes = 0;
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t checksum = kFnvOffset;
+    uint64_t packetErrors = 0;
+    int64_t decodeNs = 0;       // Open to close, including output writes
+};
+
+struct Options {
+    fs::path inputDirectory;
+    fs::path outputDirectory;
+    OutputMode mode = OutputMode::Checksum;
+    unsigned jobs = 0;
+    uint32_t sampleRate = 0;
+    size_t slowest = 10;
+    const char* reportPath = nullptr;
+};
+
+bool isAssetFile(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".aac" || extension == ".adts" || extension == ".m4a" || extension == ".mp4";
+}
+
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t value) {
+    writeLe16(out, static_cast<uint16_t>(value));
+    writeLe16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+/**
+ * @brief Write a canonical 44-byte WAV header for S16 PCM
+ */
+bool writeWavHeader(FILE* file, int sampleRate, int channels, uint64_t dataBytes) {
+    // Sizes past 4 GiB cannot be expressed; such files are still readable as raw data
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes, UINT32_MAX - 36));
+    uint8_t header[44];
+    std::memcpy(header, "RIFF", 4);
+    writeLe32(header + 4, 36 + dataSize);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    writeLe32(header + 16, 16);
+    writeLe16(header + 20, 1);                                      // PCM
+    writeLe16(header + 22, static_cast<uint16_t>(channels));
+    writeLe32(header + 24, static_cast<uint32_t>(sampleRate));
+    writeLe32(header + 28, static_cast<uint32_t>(sampleRate * channels * 2));
+    writeLe16(header + 32, static_cast<uint16_t>(channels * 2));
+    writeLe16(header + 34, 16);
+    std::memcpy(header + 36, "data", 4);
+    writeLe32(header + 40, dataSize);
+    return std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+void decodeFile(const Options& options, std::vector<uint8_t>& buffer, FileResult& result) {
+    const auto start = std::chrono::steady_clock::now();
+
+    AssetStream* stream = nullptr;
+    if (sceAudioDecOpenStream(result.path.string().c_str(), &stream) != SCE_AUDIODEC_OK) {
+        result.error = "unsupported or corrupt asset";
+        return;
+    }
+
+    DecoderInfo info;
+    sceAudioDecGetStreamInfo(stream, &info);
+    result.sampleRate = info.sampleRate;
+    result.channels = info.channels;
+
+    FILE* output = nullptr;
+    if (options.mode != OutputMode::Checksum) {
+        std::error_code error;
+        fs::path outputPath = options.outputDirectory / fs::relative(result.path, options.inputDirectory, error);
+        outputPath.replace_extension(options.mode == OutputMode::Wav ? ".wav" : ".pcm");
+        fs::create_directories(outputPath.parent_path(), error);
+        output = std::fopen(outputPath.string().c_str(), "wb");
+        if (!output) {
+            result.error = "cannot write " + outputPath.string();
+            sceAudioDecCloseStream(stream);
+            return;
+        }
+        if (options.mode == OutputMode::Wav) {
+            // Placeholder; rewritten with the final size
+            writeWavHeader(output, result.sampleRate, result.channels, 0);
+        }
+    }
+
+    while (true) {
+        uint32_t size = static_cast<uint32_t>(buffer.size());
+        const int ret = sceAudioDecReadStream(stream, buffer.data(), &size);
+        if (ret != SCE_AUDIODEC_OK) {
+            result.error = "decode failed";
+            break;
+        }
+        if (size == 0) {
+            result.ok = true;
+            break;
+        }
+
+        result.pcmBytes += size;
+        if (output) {
+            if (std::fwrite(buffer.data(), 1, size, output) != size) {
+                result.error = "write failed";
+                break;
+            }
+        } else {
+            for (uint32_t i = 0; i < size; ++i) {
+                result.checksum = (result.checksum ^ buffer[i]) * kFnvPrime;
+            }
+        }
+    }
+
+    DecoderStatsSnapshot stats;
+    if (sceAudioDecGetStreamStats(stream, &stats) == SCE_AUDIODEC_OK) {
+        for (int kind = 1; kind < kDecodeErrorKinds; ++kind) {
+            result.packetErrors += stats.errors[kind];
+        }
+    }
+    sceAudioDecCloseStream(stream);
+
+    if (output) {
+        if (result.ok && options.mode == OutputMode::Wav &&
+            !writeWavHeader(output, result.sampleRate, result.channels, result.pcmBytes)) {
+            result.ok = false;
+            result.error = "write failed";
+        }
+        if (std::fclose(output) != 0 && result.ok) {
+            result.ok = false;
+            result.error = "write failed";
+        }
+    }
+
+    result.decodeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\b':
+                escaped += "\\b";
+                break;
+            case '\f':
+                escaped += "\\f";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    // JSON strings take any other control character only as a \u escape
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+void writeReport(FILE* out, const std::vector<FileResult>& results, unsigned jobs, double wallSeconds) {
+    std::fprintf(out, "{\n  \"tool\": \"audiodec_bulk\",\n  \"jobs\": %u,\n  \"wall_seconds\": %.3f,\n",
+                 jobs, wallSeconds);
+    std::fprintf(out, "  \"files\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const FileResult& r = results[i];
+        std::fprintf(out,
+                     "    {\"path\": \"%s\", \"ok\": %s, \"error\": \"%s\", \"input_bytes\": %llu, "
+                     "\"pcm_bytes\": %llu, \"sample_rate\": %d, \"channels\": %d, \"checksum\": \"%016llx\", "
+                     "\"packet_errors\": %llu, \"decode_ms\": %.3f}%s\n",
+                     jsonEscape(r.path.generic_string()).c_str(), r.ok ? "true" : "false",
+                     jsonEscape(r.error).c_str(), static_cast<unsigned long long>(r.inputBytes),
+                     static_cast<unsigned long long>(r.pcmBytes), r.sampleRate, r.channels,
+                     static_cast<unsigned long long>(r.checksum),
+                     static_cast<unsigned long long>(r.packetErrors), r.decodeNs / 1e6,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+void printSummary(const Options& options, const std::vector<FileResult>& results, unsigned jobs,
+                  double wallSeconds) {
+    uint64_t inputBytes = 0;
+    double audioSeconds = 0.0;
+    size_t failed = 0;
+    for (const FileResult& r : results) {
+        inputBytes += r.inputBytes;
+        if (r.ok && r.sampleRate > 0 && r.channels > 0) {
+            audioSeconds += static_cast<double>(r.pcmBytes) / (2.0 * r.channels * r.sampleRate);
+        }
+        failed += r.ok ? 0 : 1;
+    }
+
+    std::printf("Decoded %zu of %zu files with %u jobs in %.2f s\n", results.size() - failed,
+                results.size(), jobs, wallSeconds);
+    std::printf("Idle pooled decoders: %zu (limit %u)\n", DecoderPool::getInstance().getIdleCount(), jobs);
+    if (wallSeconds > 0.0) {
+        std::printf("Throughput: %.1f MiB/s compressed, %.1f s of audio per second (%.0fx realtime)\n",
+                    inputBytes / (1024.0 * 1024.0) / wallSeconds, audioSeconds / wallSeconds,
+                    audioSeconds / wallSeconds);
+    }
+
+    std::vector<const FileResult*> slowest;
+    for (const FileResult& r : results) {
+        if (r.ok) {
+            slowest.push_back(&r);
+        }
+    }
+    std::sort(slowest.begin(), slowest.end(),
+              [](const FileResult* a, const FileResult* b) { return a->decodeNs > b->decodeNs; });
+    slowest.resize(std::min(slowest.size(), options.slowest));
+    if (!slowest.empty()) {
+        std::printf("Slowest files:\n");
+        for (const FileResult* r : slowest) {
+            std::printf("  %9.1f ms  %s\n", r->decodeNs / 1e6, r->path.generic_string().c_str());
+        }
+    }
+
+    for (const FileResult& r : results) {
+        if (!r.ok) {
+            std::printf("FAILED  %s: %s\n", r.path.generic_string().c_str(), r.error.c_str());
+        } else if (r.packetErrors > 0) {
+            std::printf("WARNING %s: %llu packets failed to decode\n", r.path.generic_string().c_str(),
+                        static_cast<unsigned long long>(r.packetErrors));
+        }
+    }
+    if (options.mode == OutputMode::Checksum && !options.reportPath) {
+        for (const FileResult& r : results) {
+            if (r.ok) {
+                std::printf("%016llx  %s\n", static_cast<unsigned long long>(r.checksum),
+                            r.path.generic_string().c_str());
+            }
+        }
+    }
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr,
+                 "Usage: %s <directory> [--jobs N] [--wav DIR | --pcm DIR] [--rate HZ] [--slowest N] "
+                 "[--output report.json]\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            options.jobs = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc) {
+            options.mode = OutputMode::Wav;
+            options.outputDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--pcm") == 0 && i + 1 < argc) {
+            options.mode = OutputMode::Pcm;
+            options.outputDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.sampleRate = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--slowest") == 0 && i + 1 < argc) {
+            options.slowest = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options.reportPath = argv[++i];
+        } else if (argv[i][0] != '-' && options.inputDirectory.empty()) {
+            options.inputDirectory = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    if (options.inputDirectory.empty() || !fs::is_directory(options.inputDirectory, error)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<FileResult> results;
+    for (fs::recursive_directory_iterator it(options.inputDirectory, fs::directory_options::skip_permission_denied, error), end;
+         it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && isAssetFile(it->path())) {
+            results.emplace_back();
+            results.back().path = it->path();
+        }
+    }
+    // Largest first, so the long files do not end up alone on one worker at the end
+    for (FileResult& r : results) {
+        r.inputBytes = fs::file_size(r.path, error);
+    }
+    std::sort(results.begin(), results.end(),
+              [](const FileResult& a, const FileResult& b) { return a.inputBytes > b.inputBytes; });
+
+    unsigned jobs = options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, std::max<size_t>(results.size(), 1)));
+
+    // Per-file messages would drown the report
+    ShadPS4::Log::setLevel(ShadPS4::Log::Level::Error);
+    sceAudioDecSetOutputSampleRate(options.sampleRate, SCE_AUDIODEC_RESAMPLE_BALANCED);
+    // A dump holds many configurations; one idle decoder per worker covers the files in flight
+    DecoderPool::getInstance().setMaxIdleTotal(jobs);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> nextFile{0};
+    std::vector<std::thread> workers;
+    for (unsigned j = 0; j < jobs; ++j) {
+        workers.emplace_back([&]() {
+            std::vector<uint8_t> buffer(kChunkBytes);
+            for (size_t i = nextFile.fetch_add(1); i < results.size(); i = nextFile.fetch_add(1)) {
+                decodeFile(options, buffer, results[i]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(results.begin(), results.end(),
+              [](const FileResult& a, const FileResult& b) { return a.path < b.path; });
+    printSummary(options, results, jobs, wallSeconds);
+
+    if (options.reportPath) {
+        FILE* out = std::fopen(options.reportPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "Could not open %s for writing\n", options.reportPath);
+            return 1;
+        }
+        writeReport(out, results, jobs, wallSeconds);
+        std::fclose(out);
+    }
+
+    ShadPS4::Log::flush();
+    const bool allOk = std::all_of(results.begin(), results.end(), [](const FileResult& r) { return r.ok; });
+    return allOk ? 0 : 2;
+}